@@ -0,0 +1,184 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "EventTrace.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <boost/thread/mutex.hpp>
+
+namespace eventTrace {
+
+volatile bool enabled = false;
+
+namespace {
+
+struct traceRing {
+    uint32_t tid;
+    bool in_use; // false once owning thread exits, so ring can be reused
+    std::vector<traceEvent> events; // size is a power of two
+    volatile uint64_t head; // total events recorded, written by owning thread only
+};
+
+boost::mutex registry_lock; // protects rings, settings below, and in_use
+std::vector<traceRing*> rings;
+size_t ring_size = 65536;
+bool dump_on_overflow = false;
+volatile bool dump_requested = false;
+
+pthread_key_t ring_key;
+pthread_once_t ring_key_once = PTHREAD_ONCE_INIT;
+__thread traceRing *thread_ring = NULL;
+
+void releaseRing(void *ring){
+    boost::mutex::scoped_lock lock(registry_lock);
+    static_cast<traceRing*>(ring)->in_use = false;
+}
+
+void createRingKey(){
+    pthread_key_create(&ring_key, releaseRing);
+}
+
+traceRing* registerThread(){
+    pthread_once(&ring_key_once, createRingKey);
+    boost::mutex::scoped_lock lock(registry_lock);
+    traceRing *ring = NULL;
+    for (size_t i = 0; i < rings.size() && ring == NULL; i++) {
+        if (!rings[i]->in_use)
+            ring = rings[i]; // keeps events of exited thread until overwritten
+    }
+    if (ring == NULL) {
+        ring = new traceRing;
+        ring->events.resize(ring_size);
+        ring->head = 0;
+        rings.push_back(ring);
+    }
+    ring->tid = syscall(SYS_gettid);
+    ring->in_use = true;
+    pthread_setspecific(ring_key, ring);
+    thread_ring = ring;
+    return ring;
+}
+
+bool earlier(const traceEvent& a, const traceEvent& b){
+    return a.time_ns < b.time_ns;
+}
+
+} // namespace
+
+bool compiled(){
+#ifdef USRP_UHD_TRACE
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ring_events applies to rings created after this call
+void configure(bool enable, size_t ring_events, bool _dump_on_overflow){
+    boost::mutex::scoped_lock lock(registry_lock);
+    ring_size = 1;
+    while (ring_size < std::max(ring_events, size_t(1024)))
+        ring_size <<= 1;
+    dump_on_overflow = _dump_on_overflow;
+    enabled = enable && compiled();
+}
+
+void record(uint16_t type, uint16_t tuner, uint64_t arg0, uint64_t arg1){
+    traceRing *ring = thread_ring;
+    if (ring == NULL)
+        ring = registerThread();
+    traceEvent &event = ring->events[ring->head & (ring->events.size()-1)];
+    event.time_ns = hotPathNow();
+    event.tid = ring->tid;
+    event.type = type;
+    event.tuner = tuner;
+    event.arg0 = arg0;
+    event.arg1 = arg1;
+    ring->head = ring->head + 1;
+}
+
+// one dump per overflow burst: disarmed until configure() is called again
+void overflow(uint16_t tuner){
+    if (!enabled)
+        return;
+    record(TRACE_OVERFLOW, tuner, 0, 0);
+    if (dump_on_overflow && !dump_requested) {
+        boost::mutex::scoped_lock lock(registry_lock);
+        if (dump_on_overflow) {
+            dump_on_overflow = false;
+            dump_requested = true;
+        }
+    }
+}
+
+bool dumpRequested(){
+    return dump_requested;
+}
+
+// recording is paused while the rings are copied, so the dump shows what led up to the request
+bool dump(const std::string& path, std::string& error){
+    std::vector<traceEvent> events;
+    {
+        boost::mutex::scoped_lock lock(registry_lock);
+        dump_requested = false;
+        const bool was_enabled = enabled;
+        enabled = false;
+        usleep(1000); // let in-progress records finish
+        for (size_t i = 0; i < rings.size(); i++) {
+            const traceRing &ring = *rings[i];
+            const uint64_t count = std::min(uint64_t(ring.head), uint64_t(ring.events.size()));
+            for (uint64_t n = ring.head-count; n < ring.head; n++)
+                events.push_back(ring.events[n & (ring.events.size()-1)]);
+        }
+        enabled = was_enabled;
+    }
+    std::sort(events.begin(), events.end(), earlier);
+
+    traceFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "USRPTRC1", sizeof(header.magic));
+    header.version = 1;
+    header.event_size = sizeof(traceEvent);
+    header.num_events = events.size();
+    struct timespec realtime;
+    clock_gettime(CLOCK_REALTIME, &realtime);
+    header.realtime_offset_ns = int64_t(realtime.tv_sec)*1000000000LL + realtime.tv_nsec - int64_t(hotPathNow());
+
+    FILE *file = fopen(path.c_str(), "wb");
+    if (file == NULL) {
+        error = strerror(errno);
+        return false;
+    }
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    if (ok && !events.empty())
+        ok = fwrite(&events[0], sizeof(traceEvent), events.size(), file) == events.size();
+    if (fclose(file) != 0)
+        ok = false;
+    if (!ok)
+        error = "write failed";
+    return ok;
+}
+
+} // namespace eventTrace
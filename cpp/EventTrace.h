@@ -0,0 +1,88 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_EVENTTRACE_H
+#define USRP_UHD_EVENTTRACE_H
+
+#include "HotPathMetrics.h"
+#include <string>
+
+/** Binary event tracing of the data path, a flight recorder for offline analysis.
+ *
+ *  Tracing is compiled in only when USRP_UHD_TRACE is defined (configure --enable-trace); otherwise
+ *  TRACE_EVENT expands to nothing. When compiled in, it is enabled at run time through the trace_settings
+ *  property, and costs a single flag check while disabled.
+ *
+ *  Each thread records fixed size events into its own ring, which it alone writes, so recording takes no
+ *  lock. Rings hold the most recent events, and dump() writes all rings to a file, ordered by time:
+ *      traceFileHeader
+ *      traceEvent[num_events]
+ *  in host byte order. Event times are CLOCK_MONOTONIC; add the header's realtime_offset_ns for UTC.
+ */
+
+enum traceEventType {
+    TRACE_RECV_START = 1,   // arg0 = samps requested
+    TRACE_RECV_END,         // arg0 = samps received, arg1 = rx_metadata_t error code
+    TRACE_OVERFLOW,
+    TRACE_PUSH_START,       // arg0 = samps (I and Q) in buffer
+    TRACE_PUSH_END,
+    TRACE_LOCK_WAIT,        // arg0 = ns spent waiting for a tuner lock
+    TRACE_SDDS_SEND,        // arg0 = packets sent in batch, arg1 = bytes
+    TRACE_SRI_CHANGE,
+    TRACE_TX_SEND           // arg0 = samps requested, arg1 = samps sent
+};
+
+#define TRACE_NO_TUNER 0xffff
+
+struct traceEvent {
+    uint64_t time_ns;
+    uint32_t tid;
+    uint16_t type; // traceEventType
+    uint16_t tuner; // tuner_id, or TRACE_NO_TUNER
+    uint64_t arg0;
+    uint64_t arg1;
+};
+
+struct traceFileHeader {
+    char magic[8]; // "USRPTRC1"
+    uint32_t version;
+    uint32_t event_size;
+    uint64_t num_events;
+    int64_t realtime_offset_ns; // CLOCK_REALTIME - CLOCK_MONOTONIC when dumped
+};
+
+namespace eventTrace {
+    extern volatile bool enabled;
+
+    bool compiled(); // true if built with USRP_UHD_TRACE
+    void configure(bool enable, size_t ring_events, bool dump_on_overflow);
+    void record(uint16_t type, uint16_t tuner, uint64_t arg0, uint64_t arg1);
+    void overflow(uint16_t tuner); // records TRACE_OVERFLOW and requests a dump if configured
+    bool dumpRequested();
+    bool dump(const std::string& path, std::string& error);
+}
+
+#ifdef USRP_UHD_TRACE
+#define TRACE_EVENT(type, tuner, arg0, arg1) \
+    do { if (eventTrace::enabled) eventTrace::record(type, tuner, arg0, arg1); } while (0)
+#else
+#define TRACE_EVENT(type, tuner, arg0, arg1) do {} while (0)
+#endif
+
+#endif
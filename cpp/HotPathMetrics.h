@@ -0,0 +1,214 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_HOTPATHMETRICS_H
+#define USRP_UHD_HOTPATHMETRICS_H
+
+#include <stdint.h>
+#include <time.h>
+#include <vector>
+
+/** Counter or gauge with a single writer. Only the thread that owns the counter (or holds the lock that
+ *  protects the owning object) updates it, so updates are plain increments with no lock or atomic
+ *  read-modify-write. Any other thread may read it at any time without synchronization and will see a
+ *  recent value, and aligned 64-bit loads and stores are not torn on the 64-bit hosts this device runs on.
+ */
+class hotPathCounter {
+public:
+    hotPathCounter() : value(0) {}
+
+    void add(uint64_t n=1) { value = value + n; }
+    void max(uint64_t n) { if (n > value) value = n; }
+    uint64_t get() const { return value; }
+    void reset() { value = 0; }
+
+private:
+    volatile uint64_t value;
+};
+
+// monotonic host time in ns, for stage durations
+inline uint64_t hotPathNow(){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return uint64_t(ts.tv_sec)*1000000000ULL + ts.tv_nsec;
+}
+
+/** Counters for one output stage (e.g. a pushPacket call): number of calls, total and max duration. */
+struct hotPathStage {
+    hotPathCounter calls;
+    hotPathCounter total_ns;
+    hotPathCounter max_ns;
+
+    void record(uint64_t start_ns){
+        const uint64_t ns = hotPathNow()-start_ns;
+        calls.add();
+        total_ns.add(ns);
+        max_ns.max(ns);
+    }
+
+    void reset(){
+        calls.reset();
+        total_ns.reset();
+        max_ns.reset();
+    }
+};
+
+/** Counters for a tuner's receive or transmit path. Written only while holding the tuner's lock. */
+struct tunerHotPathMetrics {
+    hotPathCounter samps; // RX samps received, or TX samps sent
+    hotPathCounter recv_calls;
+    hotPathCounter overflows;
+    hotPathCounter timeouts;
+    hotPathCounter recv_errors; // other rx_metadata_t error codes, and exceptions
+    hotPathStage sdds_push; // dataSDDS_out->pushPacket (hand off to SddsProcessor)
+    hotPathCounter send_calls;
+    hotPathCounter short_sends; // TX sends that did not send all samps
+
+    void reset(){
+        samps.reset();
+        recv_calls.reset();
+        overflows.reset();
+        timeouts.reset();
+        recv_errors.reset();
+        sdds_push.reset();
+        send_calls.reset();
+        short_sends.reset();
+    }
+};
+
+/** Counters for an SddsProcessor. Those written by the processor thread are kept apart from those written
+ *  by the thread calling dataIn so the two writers do not share a cache line.
+ */
+struct sddsHotPathMetrics {
+    // written by processor thread
+    hotPathCounter packets;
+    hotPathCounter bytes;
+    hotPathCounter send_errors;
+    char pad[64];
+    // written by dataIn caller, with input mutex held
+    hotPathCounter dropped_samps; // samps that did not fit in input queue (trywrite)
+};
+
+/** Percentiles of a latencyHistogram, in ns. */
+struct latencySummary {
+    latencySummary() : count(0), p50(0.0), p90(0.0), p99(0.0), p999(0.0), max(0.0) {}
+
+    uint64_t count;
+    double p50;
+    double p90;
+    double p99;
+    double p999;
+    double max;
+};
+
+/** HDR style latency histogram with a single writer, like hotPathCounter. Each power of two is split
+ *  into sub_count linear buckets, so a recorded value is known to within 1/sub_count (about 3%) over the
+ *  whole range, from 1 ns up to 2^max_magnitude ns (about 18 min). Larger values go in the last bucket.
+ *
+ *  Only the writer may clear the buckets, so a reader resets the histogram by calling requestReset(),
+ *  and the writer clears it on its next record(). Readers must be serialized with each other.
+ */
+class latencyHistogram {
+public:
+    static const unsigned sub_bits = 5;
+    static const uint64_t sub_count = 1 << sub_bits;
+    static const unsigned max_magnitude = 40;
+    static const size_t num_buckets = (max_magnitude-sub_bits+2)*sub_count;
+
+    latencyHistogram() : reset_requested(0), reset_done(0) {}
+
+    void record(int64_t ns){
+        if (reset_done != reset_requested)
+            clear();
+        const uint64_t value = (ns > 0) ? uint64_t(ns) : 0;
+        counts[bucket(value)].add();
+        max_ns.max(value);
+    }
+
+    // writer only, e.g. on deallocation
+    void clear(){
+        for (size_t i = 0; i < num_buckets; i++)
+            counts[i].reset();
+        max_ns.reset();
+        reset_done = reset_requested;
+    }
+
+    void requestReset(){
+        reset_requested = reset_requested + 1;
+    }
+
+    // percentiles of values recorded since the last reset
+    latencySummary summarize() const {
+        latencySummary summary;
+        if (reset_done != reset_requested)
+            return summary; // reset pending
+        std::vector<uint64_t> snapshot(num_buckets);
+        for (size_t i = 0; i < num_buckets; i++) {
+            snapshot[i] = counts[i].get();
+            summary.count += snapshot[i];
+        }
+        summary.p50 = percentile(snapshot, summary.count, 50.0);
+        summary.p90 = percentile(snapshot, summary.count, 90.0);
+        summary.p99 = percentile(snapshot, summary.count, 99.0);
+        summary.p999 = percentile(snapshot, summary.count, 99.9);
+        summary.max = max_ns.get();
+        return summary;
+    }
+
+private:
+    static size_t bucket(uint64_t value){
+        if (value < sub_count)
+            return value;
+        unsigned magnitude = 63-__builtin_clzll(value);
+        if (magnitude > max_magnitude)
+            return num_buckets-1;
+        return (magnitude-sub_bits+1)*sub_count + ((value >> (magnitude-sub_bits)) & (sub_count-1));
+    }
+
+    // middle of the range of values that fall in bucket index
+    static double bucketValue(size_t index){
+        if (index < sub_count)
+            return index;
+        const unsigned magnitude = index/sub_count + sub_bits - 1;
+        const uint64_t lower = (sub_count + index%sub_count) << (magnitude-sub_bits);
+        return lower + 0.5*(uint64_t(1) << (magnitude-sub_bits));
+    }
+
+    static double percentile(const std::vector<uint64_t>& snapshot, uint64_t count, double p){
+        if (count == 0)
+            return 0.0;
+        uint64_t target = uint64_t(p/100.0*count + 0.5);
+        if (target == 0)
+            target = 1;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i < snapshot.size(); i++) {
+            cumulative += snapshot[i];
+            if (cumulative >= target)
+                return bucketValue(i);
+        }
+        return bucketValue(snapshot.size()-1);
+    }
+
+    hotPathCounter counts[num_buckets];
+    hotPathCounter max_ns;
+    volatile uint32_t reset_requested; // written by readers
+    volatile uint32_t reset_done; // written by writer
+};
+
+#endif
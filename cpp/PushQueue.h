@@ -0,0 +1,344 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_PUSHQUEUE_H
+#define USRP_UHD_PUSHQUEUE_H
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <bulkio/bulkio.h>
+#include <algorithm>
+#include <deque>
+#include <map>
+#include <string>
+#include <vector>
+#include "HotPathMetrics.h"
+
+/** What asyncPushQueue::pushPacket does with a block when the queue already holds max_blocks of them. */
+enum pushOverflowPolicy {
+    PUSH_BLOCK,       // wait for the push thread to make room
+    PUSH_DROP_OLDEST, // drop the oldest queued block
+    PUSH_DROP_NEWEST  // drop the block being queued
+};
+
+/** Counters of an asyncPushQueue. The queue side is updated with the queue's mutex held and push by the push
+ *  thread only, so each has a single writer (see hotPathCounter).
+ */
+struct pushQueueMetrics {
+    hotPathCounter queued; // blocks queued
+    hotPathCounter high_water; // most blocks held at once
+    hotPathCounter dropped_blocks;
+    hotPathCounter dropped_samps; // shorts, I and Q counted separately
+    hotPathCounter blocked; // pushPacket calls that waited for room
+    hotPathCounter blocked_ns; // total time waited
+    hotPathStage push; // port pushPacket calls made by the push thread
+};
+
+/** Counters for the blocks of one stream, written only by the thread that makes its port pushPacket calls: the
+ *  push thread while the stream's blocks are queued, otherwise the thread calling pushPacket (see direct). They
+ *  are dropped after the stream's EOS.
+ */
+struct pushStreamMetrics {
+    hotPathStage push; // port pushPacket
+    latencyHistogram origin_to_push; // origin_ns given to pushPacket to the port pushPacket returning
+};
+
+/** Decouples a BulkIO output port from the threads that produce its data. pushSRI and pushPacket queue the
+ *  call, and a push thread owned by the caller makes it on the port by calling service(), so a slow consumer
+ *  holds up only that thread. SRI and EOS are always queued and never dropped, and calls are made in the
+ *  order they were queued, so SRI stays in step with the data.
+ *
+ *  While not async (before setAsync(true), and after setAsync(false)) calls are made on the port directly
+ *  by the calling thread, as if there were no queue. A caller that would rather wait on the port than hand off
+ *  to the push thread passes direct, which makes the call at once unless calls for the same stream are still
+ *  queued, in which case it is queued behind them to keep the stream in order.
+ *
+ *  Block buffers are recycled, so a steady stream of blocks of the same size allocates nothing once running.
+ */
+template <class PORT_TYPE, class DATA_TYPE>
+class asyncPushQueue {
+public:
+    asyncPushQueue(PORT_TYPE *_port) :
+        port(_port), async(false), max_blocks(4), policy(PUSH_DROP_OLDEST), num_blocks(0), busy(false) {}
+
+    // policy and max_blocks apply at once, to blocks already queued as well
+    void configure(size_t _max_blocks, pushOverflowPolicy _policy){
+        boost::mutex::scoped_lock lock(mutex);
+        max_blocks = std::max(_max_blocks, size_t(1));
+        policy = _policy;
+        while (num_blocks > max_blocks && dropOldest()) {}
+        not_full.notify_all();
+    }
+
+    // with async cleared, blocks still queued are dropped, so drain() first to have them pushed
+    void setAsync(bool _async){
+        boost::mutex::scoped_lock lock(mutex);
+        async = _async;
+        if (!async) {
+            while (!items.empty()) {
+                if (items.front().kind == item::DATA) {
+                    metrics.dropped_blocks.add();
+                    metrics.dropped_samps.add(items.front().data.size());
+                }
+                recycle(items.front());
+                items.pop_front();
+            }
+            num_blocks = 0;
+            not_full.notify_all();
+        }
+    }
+
+    bool isAsync(){
+        boost::mutex::scoped_lock lock(mutex);
+        return async;
+    }
+
+    // waits up to timeout_ms for the push thread to push everything queued, and returns true if it did
+    bool drain(long timeout_ms){
+        const boost::system_time deadline = boost::get_system_time() + boost::posix_time::milliseconds(timeout_ms);
+        boost::mutex::scoped_lock lock(mutex);
+        while (!items.empty() || busy) {
+            if (!drained.timed_wait(lock, deadline))
+                return items.empty() && !busy;
+        }
+        return true;
+    }
+
+    void pushSRI(const BULKIO::StreamSRI &sri, bool direct=false){
+        boost::mutex::scoped_lock lock(mutex);
+        if (!async || (direct && !pending(std::string(sri.streamID)))) {
+            lock.unlock();
+            port->pushSRI(sri);
+            return;
+        }
+        items.push_back(item());
+        items.back().kind = item::SRI;
+        items.back().sri = sri;
+        items.back().stream_id = sri.streamID;
+        lock.unlock();
+        not_empty.notify_one();
+    }
+
+    // queues a copy of data. Returns false if the block was dropped (PUSH_DROP_NEWEST). origin_ns is the host
+    // time (hotPathNow) the data became available, for the stream's origin_to_push latency, or 0 if unknown.
+    bool pushPacket(std::vector<DATA_TYPE> &data, const BULKIO::PrecisionUTCTime &T, bool EOS, const std::string &stream_id,
+                    uint64_t origin_ns=0, bool direct=false){
+        boost::mutex::scoped_lock lock(mutex);
+        if (!async || (direct && !pending(stream_id))) {
+            pushStreamMetrics &stream = stream_metrics[stream_id];
+            lock.unlock();
+            portPushPacket(stream, data, T, EOS, stream_id, origin_ns);
+            return true;
+        }
+        // an EOS is never dropped, so it does not wait for room either
+        if (!EOS && num_blocks >= max_blocks) {
+            if (policy == PUSH_DROP_NEWEST) {
+                metrics.dropped_blocks.add();
+                metrics.dropped_samps.add(data.size());
+                return false;
+            }
+            if (policy == PUSH_DROP_OLDEST) {
+                while (num_blocks >= max_blocks && dropOldest()) {}
+            } else {
+                const uint64_t wait_start = hotPathNow();
+                metrics.blocked.add();
+                while (async && num_blocks >= max_blocks)
+                    not_full.wait(lock);
+                metrics.blocked_ns.add(hotPathNow()-wait_start);
+                if (!async) {
+                    pushStreamMetrics &stream = stream_metrics[stream_id];
+                    lock.unlock();
+                    portPushPacket(stream, data, T, EOS, stream_id, origin_ns);
+                    return true;
+                }
+            }
+        }
+
+        items.push_back(item());
+        item &it = items.back();
+        it.kind = item::DATA;
+        if (!free_buffers.empty()) {
+            it.data.swap(free_buffers.back());
+            free_buffers.pop_back();
+        }
+        it.data.assign(data.begin(), data.end());
+        it.T = T;
+        it.EOS = EOS;
+        it.stream_id = stream_id;
+        it.origin_ns = origin_ns;
+        num_blocks++;
+        metrics.queued.add();
+        metrics.high_water.max(num_blocks);
+        lock.unlock();
+        not_empty.notify_one();
+        return true;
+    }
+
+    // makes the oldest queued call on the port, waiting up to timeout_ms for one. Returns false if there was none.
+    bool service(long timeout_ms){
+        item it;
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            if (items.empty())
+                not_empty.timed_wait(lock, boost::posix_time::milliseconds(timeout_ms));
+            if (items.empty())
+                return false;
+            swapItem(it, items.front());
+            items.pop_front();
+            busy_stream = it.stream_id;
+            if (it.kind == item::DATA) {
+                num_blocks--;
+                // looked up here rather than when queued, since an EOS queued ahead of it drops the entry
+                it.stream = &stream_metrics[it.stream_id];
+            }
+            busy = true;
+        }
+        not_full.notify_one();
+
+        if (it.kind == item::SRI) {
+            port->pushSRI(it.sri);
+        } else {
+            const uint64_t push_start = hotPathNow();
+            portPushPacket(*it.stream, it.data, it.T, it.EOS, it.stream_id, it.origin_ns);
+            metrics.push.record(push_start);
+        }
+
+        boost::mutex::scoped_lock lock(mutex);
+        recycle(it);
+        busy = false;
+        if (items.empty())
+            drained.notify_all();
+        return true;
+    }
+
+    size_t size(){
+        boost::mutex::scoped_lock lock(mutex);
+        return num_blocks;
+    }
+
+    // safe to read from any thread
+    const pushQueueMetrics& getMetrics() const { return metrics; }
+
+    // the stream's port pushPacket calls, and origin_to_push latency. Returns false if the stream has none.
+    bool getStreamMetrics(const std::string &stream_id, hotPathStage &push, latencySummary &origin_to_push){
+        boost::mutex::scoped_lock lock(mutex);
+        typename std::map<std::string, pushStreamMetrics>::iterator stream = stream_metrics.find(stream_id);
+        if (stream == stream_metrics.end())
+            return false;
+        push.calls.add(stream->second.push.calls.get());
+        push.total_ns.add(stream->second.push.total_ns.get());
+        push.max_ns.max(stream->second.push.max_ns.get());
+        origin_to_push = stream->second.origin_to_push.summarize();
+        return true;
+    }
+
+    void resetLatency(){
+        boost::mutex::scoped_lock lock(mutex);
+        for (typename std::map<std::string, pushStreamMetrics>::iterator stream = stream_metrics.begin(); stream != stream_metrics.end(); ++stream)
+            stream->second.origin_to_push.requestReset();
+    }
+
+private:
+    struct item {
+        enum { SRI, DATA } kind;
+        BULKIO::StreamSRI sri;
+        std::vector<DATA_TYPE> data;
+        BULKIO::PrecisionUTCTime T;
+        bool EOS;
+        std::string stream_id;
+        uint64_t origin_ns;
+        pushStreamMetrics *stream; // in stream_metrics, set once dequeued
+    };
+
+    // makes a pushPacket call on the port, recording it in stream, which is dropped after an EOS
+    void portPushPacket(pushStreamMetrics &stream, std::vector<DATA_TYPE> &data, const BULKIO::PrecisionUTCTime &T, bool EOS,
+                        const std::string &stream_id, uint64_t origin_ns){
+        const uint64_t push_start = hotPathNow();
+        port->pushPacket(data, T, EOS, stream_id);
+        stream.push.record(push_start);
+        if (origin_ns != 0)
+            stream.origin_to_push.record(hotPathNow()-origin_ns);
+        if (EOS) {
+            boost::mutex::scoped_lock lock(mutex);
+            stream_metrics.erase(stream_id);
+        }
+    }
+
+    static void swapItem(item &a, item &b){
+        std::swap(a.kind, b.kind);
+        std::swap(a.sri, b.sri);
+        a.data.swap(b.data);
+        std::swap(a.T, b.T);
+        std::swap(a.EOS, b.EOS);
+        a.stream_id.swap(b.stream_id);
+        std::swap(a.origin_ns, b.origin_ns);
+    }
+
+    // hold on to a block buffer for reuse, a few more than max_blocks at most
+    void recycle(item &it){
+        if (it.kind == item::DATA && it.data.capacity() > 0 && free_buffers.size() < max_blocks+2) {
+            free_buffers.push_back(std::vector<DATA_TYPE>());
+            free_buffers.back().swap(it.data);
+        }
+    }
+
+    // true if a call for stream_id is queued or being made by the push thread. Hold mutex.
+    bool pending(const std::string &stream_id) const {
+        if (busy && busy_stream == stream_id)
+            return true;
+        for (typename std::deque<item>::const_iterator it = items.begin(); it != items.end(); ++it) {
+            if (it->stream_id == stream_id)
+                return true;
+        }
+        return false;
+    }
+
+    // drops the oldest block that is not an EOS, and returns false if there is none
+    bool dropOldest(){
+        for (typename std::deque<item>::iterator it = items.begin(); it != items.end(); ++it) {
+            if (it->kind != item::DATA || it->EOS)
+                continue;
+            metrics.dropped_blocks.add();
+            metrics.dropped_samps.add(it->data.size());
+            recycle(*it);
+            items.erase(it);
+            num_blocks--;
+            return true;
+        }
+        return false;
+    }
+
+    PORT_TYPE *port;
+    boost::mutex mutex;
+    boost::condition_variable not_empty;
+    boost::condition_variable not_full;
+    boost::condition_variable drained;
+    bool async;
+    size_t max_blocks;
+    pushOverflowPolicy policy;
+    std::deque<item> items;
+    size_t num_blocks; // DATA items in items
+    bool busy; // the push thread is making a call
+    std::string busy_stream; // stream of the call being made
+    std::vector<std::vector<DATA_TYPE> > free_buffers;
+    pushQueueMetrics metrics;
+    std::map<std::string, pushStreamMetrics> stream_metrics; // entries are only added and erased with mutex held
+};
+
+#endif
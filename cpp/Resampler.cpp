@@ -0,0 +1,155 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "Resampler.h"
+#include <algorithm>
+#include <cmath>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace {
+    const int tap_shift = 14; // taps are Q14, so each phase can sum to just under 2 without overflowing 32-bit sums
+
+    inline short saturate(int v){
+        return (short) std::max(-32768, std::min(32767, v));
+    }
+
+    // sum of a[j]*b[j] for len values, len a multiple of 8
+    inline int dot(const short *a, const short *b, size_t len){
+#ifdef __SSE2__
+        __m128i vsum = _mm_setzero_si128();
+        for (size_t j = 0; j < len; j += 8)
+            vsum = _mm_add_epi32(vsum, _mm_madd_epi16(_mm_loadu_si128((const __m128i*) (a+j)), _mm_loadu_si128((const __m128i*) (b+j))));
+        int sum_lanes[4];
+        _mm_storeu_si128((__m128i*) sum_lanes, vsum);
+        return sum_lanes[0] + sum_lanes[1] + sum_lanes[2] + sum_lanes[3];
+#else
+        int sum = 0;
+        for (size_t j = 0; j < len; j++)
+            sum += int(a[j])*b[j];
+        return sum;
+#endif
+    }
+}
+
+void polyphaseResampler::ratio(double in_rate, double out_rate, size_t max_phases, size_t &up, size_t &down){
+    up = 1;
+    down = 1;
+    if (in_rate <= 0.0 || out_rate <= 0.0 || out_rate >= in_rate)
+        return;
+    const double r = out_rate/in_rate;
+    double best = 1.0-r;
+    for (size_t u = 1; u <= std::max(max_phases, size_t(1)); u++) {
+        // largest down that keeps u/d at or above r
+        const size_t d = size_t(floor(u/r*(1.0+1e-12)));
+        if (d < u)
+            continue;
+        const double err = double(u)/d - r;
+        if (err < best) {
+            best = err;
+            up = u;
+            down = d;
+        }
+        if (best <= r*1e-12)
+            break;
+    }
+}
+
+void polyphaseResampler::configure(size_t up_, size_t down_, double cutoff, size_t taps_per_phase){
+    up = std::max(up_, size_t(1));
+    down = std::max(down_, size_t(1));
+    taps = std::max(size_t(8), (taps_per_phase+7)/8*8);
+
+    // prototype at the upsampled rate, with gain up so each phase has unity gain at DC
+    const size_t len = up*taps;
+    const double fc = std::min(std::max(cutoff, 0.0), 0.5)/up;
+    const double mid = (len-1)/2.0;
+    std::vector<double> proto(len);
+    double sum = 0.0;
+    for (size_t n = 0; n < len; n++) {
+        const double t = n-mid;
+        const double sinc = (t == 0.0) ? 2.0*fc : sin(2.0*M_PI*fc*t)/(M_PI*t);
+        const double w = 0.42 - 0.5*cos(2.0*M_PI*(n+0.5)/len) + 0.08*cos(4.0*M_PI*(n+0.5)/len);
+        proto[n] = sinc*w;
+        sum += proto[n];
+    }
+
+    // branch p holds proto[p+k*up] for k = 0..taps-1, reversed to line up with the input history
+    bank.assign(up*taps, 0);
+    for (size_t p = 0; p < up; p++) {
+        for (size_t k = 0; k < taps; k++) {
+            const double h = (sum != 0.0) ? proto[p+k*up]*up/sum : 0.0;
+            bank[p*taps + taps-1-k] = saturate(int(floor(h*(1 << tap_shift) + 0.5)));
+        }
+    }
+    reset();
+}
+
+void polyphaseResampler::reset(){
+    phase = 0;
+    next_in = 0;
+    hist_i.assign(taps > 0 ? taps-1 : 0, 0);
+    hist_q.assign(taps > 0 ? taps-1 : 0, 0);
+}
+
+size_t polyphaseResampler::outputSize(size_t num_samps) const {
+    if (next_in >= num_samps)
+        return 0;
+    // outputs at input samps next_in + (phase + i*down)/up for i = 0.. while < num_samps
+    return ((num_samps-next_in)*up - phase + down-1)/down;
+}
+
+double polyphaseResampler::nextOutputOffset() const {
+    return next_in + double(phase)/up - (up*taps-1)/(2.0*up);
+}
+
+size_t polyphaseResampler::process(const short *in, size_t num_samps, short *out){
+    if (taps == 0)
+        return 0;
+
+    // history is followed by the deinterleaved block, so the output at input samp n uses hist[n..n+taps)
+    const size_t keep = taps-1;
+    hist_i.resize(keep+num_samps);
+    hist_q.resize(keep+num_samps);
+    for (size_t i = 0; i < num_samps; i++) {
+        hist_i[keep+i] = in[2*i];
+        hist_q[keep+i] = in[2*i+1];
+    }
+
+    size_t num_out = 0;
+    const int round = 1 << (tap_shift-1);
+    while (next_in < num_samps) {
+        const short *h = &bank[phase*taps];
+        out[2*num_out] = saturate((dot(h, &hist_i[next_in], taps) + round) >> tap_shift);
+        out[2*num_out+1] = saturate((dot(h, &hist_q[next_in], taps) + round) >> tap_shift);
+        num_out++;
+        phase += down;
+        next_in += phase/up;
+        phase %= up;
+    }
+    next_in -= num_samps;
+
+    // keep the last taps-1 samps for the next block
+    std::copy(hist_i.end()-keep, hist_i.end(), hist_i.begin());
+    std::copy(hist_q.end()-keep, hist_q.end(), hist_q.begin());
+    hist_i.resize(keep);
+    hist_q.resize(keep);
+    return num_out;
+}
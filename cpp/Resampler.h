@@ -0,0 +1,69 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_RESAMPLER_H
+#define USRP_UHD_RESAMPLER_H
+
+#include <cstddef>
+#include <vector>
+
+/** Rational polyphase resampler for interleaved 16-bit I/Q samples (sc16), producing up/down output samps per
+ *  input samp. The prototype lowpass is a Blackman windowed sinc of up*taps_per_phase taps at the upsampled
+ *  rate, quantized to Q14 and split into one branch per phase, so each output samp is a single dot product of
+ *  taps_per_phase input samps. Input history is kept between calls, so consecutive blocks are filtered as one
+ *  stream. With up == down == 1 it is a plain FIR lowpass.
+ *
+ *  process() uses SSE2 when the compiler targets it (all x86_64 builds) and a scalar loop otherwise.
+ */
+class polyphaseResampler {
+public:
+    polyphaseResampler() : up(1), down(1), taps(0), phase(0), next_in(0) {}
+
+    // best ratio up/down >= out_rate/in_rate with up <= max_phases, so the output rate is never below out_rate
+    static void ratio(double in_rate, double out_rate, size_t max_phases, size_t &up, size_t &down);
+
+    // cutoff is the -6 dB freq as a fraction of the input rate, at most 0.5
+    void configure(size_t up, size_t down, double cutoff, size_t taps_per_phase);
+    bool configured() const { return taps > 0; }
+
+    // forget the input history, for a discontinuity in the input
+    void reset();
+
+    // num output samps that the next num_samps input samps will produce
+    size_t outputSize(size_t num_samps) const;
+
+    // time of the next output samp, in input samps relative to the next input samp (after the filter delay)
+    double nextOutputOffset() const;
+
+    // filters num_samps complex input samps to out, which must hold outputSize(num_samps) complex samps,
+    // and returns num output samps. in and out may be the same buffer.
+    size_t process(const short *in, size_t num_samps, short *out);
+
+private:
+    size_t up;
+    size_t down;
+    size_t taps; // per phase, multiple of 8
+    size_t phase; // of the next output samp
+    size_t next_in; // input samp of the next output samp, relative to the next input samp
+    std::vector<short> bank; // taps per phase, reversed, phase after phase
+    std::vector<short> hist_i; // last taps-1 input samps, then the current block
+    std::vector<short> hist_q;
+};
+
+#endif
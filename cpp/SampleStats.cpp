@@ -0,0 +1,73 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "SampleStats.h"
+#include <algorithm>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+void sampleStats::accumulate(const short *data, size_t len, unsigned short clip_level){
+    size_t i = 0;
+    unsigned short max_abs = 0;
+    unsigned long long sum = 0;
+    size_t num_clipped = 0;
+
+#ifdef __SSE2__
+    // 8 values per iteration
+    // abs uses a saturating negate, so -32768 is reported as 32767, which still counts as clipped at full scale
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i clip = _mm_set1_epi16((short) std::min(int(clip_level)-1, 0x7fff));
+    __m128i vmax = zero;
+    __m128i vsum = zero; // 2 x 64-bit lanes
+    for (; i + 8 <= len; i += 8) {
+        const __m128i x = _mm_loadu_si128((const __m128i*) (data+i));
+        const __m128i xabs = _mm_max_epi16(x, _mm_subs_epi16(zero, x));
+        vmax = _mm_max_epi16(vmax, xabs);
+        // I*I+Q*Q per complex samp, at most 2^31, so treat as unsigned 32-bit and widen to 64-bit before summing
+        const __m128i sq = _mm_madd_epi16(x, x);
+        vsum = _mm_add_epi64(vsum, _mm_unpacklo_epi32(sq, zero));
+        vsum = _mm_add_epi64(vsum, _mm_unpackhi_epi32(sq, zero));
+        if (clip_level > 0)
+            num_clipped += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi16(xabs, clip))) / 2;
+    }
+    short max_lanes[8];
+    unsigned long long sum_lanes[2];
+    _mm_storeu_si128((__m128i*) max_lanes, vmax);
+    _mm_storeu_si128((__m128i*) sum_lanes, vsum);
+    for (size_t lane = 0; lane < 8; lane++)
+        max_abs = std::max(max_abs, (unsigned short) max_lanes[lane]);
+    sum = sum_lanes[0] + sum_lanes[1];
+#endif
+
+    // remaining values (or all values without SSE2)
+    for (; i < len; i++) {
+        const int v = data[i];
+        const unsigned short v_abs = (unsigned short) std::min(v < 0 ? -v : v, 0x7fff);
+        max_abs = std::max(max_abs, v_abs);
+        sum += (unsigned long long) (v*v);
+        if (clip_level > 0 && v_abs >= clip_level)
+            num_clipped++;
+    }
+
+    peak = std::max(peak, max_abs);
+    sum_sq += (double) sum;
+    num_values += len;
+    clipped += num_clipped;
+}
@@ -0,0 +1,61 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_SAMPLESTATS_H
+#define USRP_UHD_SAMPLESTATS_H
+
+#include <cstddef>
+
+/** Running measurements over interleaved 16-bit I/Q samples, as received from the USRP (sc16).
+ *  I and Q values are treated alike, so the peak is the largest absolute value of either, and clipped
+ *  counts every I or Q value whose magnitude reaches the clip level. Power is kept as the sum of I^2+Q^2.
+ *
+ *  accumulate() uses SSE2 when the compiler targets it (all x86_64 builds) and a scalar loop otherwise.
+ */
+struct sampleStats {
+    sampleStats(){
+        reset();
+    }
+
+    unsigned short peak; // max |I| or |Q|
+    double sum_sq; // sum of I^2 + Q^2
+    size_t num_values; // num I and Q values (i.e. 2 x num complex samps)
+    size_t clipped; // num I and Q values with magnitude >= clip_level
+
+    void reset(){
+        peak = 0;
+        sum_sq = 0.0;
+        num_values = 0;
+        clipped = 0;
+    }
+
+    // fold len values (I and Q interleaved) into the running measurements
+    void accumulate(const short *data, size_t len, unsigned short clip_level);
+
+    // fold measurements of other values into the running measurements
+    void merge(const sampleStats &other){
+        if (other.peak > peak)
+            peak = other.peak;
+        sum_sq += other.sum_sq;
+        num_values += other.num_values;
+        clipped += other.clipped;
+    }
+};
+
+#endif
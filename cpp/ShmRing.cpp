@@ -0,0 +1,327 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "ShmRing.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <limits.h>
+#include <linux/futex.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+    const size_t line_bytes = 64; // slots start on cache lines, so readers of one slot do not share a line with the writer of the next
+
+    size_t roundUp(size_t n){
+        return (n+line_bytes-1)/line_bytes*line_bytes;
+    }
+
+    std::string errorString(const std::string &what, const std::string &name){
+        return what+" "+name+": "+strerror(errno);
+    }
+
+    // the futexes are in memory shared between processes, so the private futex ops cannot be used
+    void futexWake(volatile uint32_t *addr){
+        syscall(SYS_futex, addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+    }
+
+    void futexWait(volatile const uint32_t *addr, uint32_t value, const struct timespec *timeout){
+        syscall(SYS_futex, addr, FUTEX_WAIT, value, timeout, NULL, 0);
+    }
+
+    // a single "/name" component, as portable shm_open names are
+    bool validName(const std::string &name){
+        return name.size() > 1 && name.size() <= NAME_MAX && name[0] == '/' && name.find('/', 1) == std::string::npos;
+    }
+
+    /* removes a ring of the same name left by a writer that did not exit cleanly. Only a ring owned by this user,
+     * with a valid header, whose writer is this process or no longer running, is removed, so a name in use by
+     * another device or by something other than a ring is left alone. returns false and sets error if the name
+     * is taken.
+     */
+    bool removeStale(const std::string &name, std::string &error){
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            if (errno == ENOENT)
+                return true;
+            error = errorString("shm_open", name);
+            return false;
+        }
+        struct stat st;
+        bool stale = false;
+        if (fstat(fd, &st) == 0 && st.st_uid == geteuid() && size_t(st.st_size) >= sizeof(shmRingHeader)) {
+            void *addr = mmap(NULL, sizeof(shmRingHeader), PROT_READ, MAP_SHARED, fd, 0);
+            if (addr != MAP_FAILED) {
+                const shmRingHeader *hdr = static_cast<const shmRingHeader*>(addr);
+                stale = hdr->magic == SHM_RING_MAGIC &&
+                        (hdr->writer_pid == getpid() || (kill(hdr->writer_pid, 0) != 0 && errno == ESRCH));
+                munmap(addr, sizeof(shmRingHeader));
+            }
+        }
+        ::close(fd);
+        if (!stale) {
+            error = "shared memory object "+name+" exists and is not a ring left by this device";
+            return false;
+        }
+        shm_unlink(name.c_str());
+        return true;
+    }
+
+    uint64_t monotonicMs(){
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return uint64_t(ts.tv_sec)*1000 + ts.tv_nsec/1000000;
+    }
+}
+
+shmRingWriter::shmRingWriter() :
+    header(NULL),
+    map_bytes(0)
+{
+}
+
+shmRingWriter::~shmRingWriter(){
+    destroy();
+}
+
+bool shmRingWriter::create(const std::string &name, size_t num_slots, size_t max_samples){
+    destroy();
+    last_error.clear();
+    if (num_slots < 2 || max_samples == 0) {
+        last_error = "ring "+name+" needs at least 2 slots and 1 sample per slot";
+        return false;
+    }
+    if (!validName(name)) {
+        last_error = "ring name "+name+" is not a single /name component";
+        return false;
+    }
+
+    const size_t header_bytes = roundUp(sizeof(shmRingHeader));
+    const size_t slot_bytes = roundUp(sizeof(shmRingBlock)+max_samples*sizeof(short));
+    const size_t bytes = header_bytes+num_slots*slot_bytes;
+
+    // a ring left by a writer that did not exit cleanly is replaced rather than reused
+    if (!removeStale(name, last_error))
+        return false;
+    // samples are readable by the device's user and group only
+    int fd = shm_open(name.c_str(), O_RDWR|O_CREAT|O_EXCL, S_IRUSR|S_IWUSR|S_IRGRP);
+    if (fd < 0) {
+        last_error = errorString("shm_open", name);
+        return false;
+    }
+    if (ftruncate(fd, bytes) != 0) {
+        last_error = errorString("ftruncate", name);
+        ::close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    void *addr = mmap(NULL, bytes, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        last_error = errorString("mmap", name);
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    // ftruncate zero fills, so every slot starts out incomplete (seq 0)
+    header = static_cast<shmRingHeader*>(addr);
+    map_bytes = bytes;
+    ring_name = name;
+    header->header_bytes = header_bytes;
+    header->slot_bytes = slot_bytes;
+    header->num_slots = num_slots;
+    header->max_samples = max_samples;
+    header->writer_pid = getpid();
+    header->write_seq = 0;
+    header->notify = 0;
+    header->state = SHM_RING_OPEN;
+    header->version = SHM_RING_VERSION;
+    // readers check the magic last, so they never see a partly initialized header
+    __sync_synchronize();
+    header->magic = SHM_RING_MAGIC;
+    return true;
+}
+
+void shmRingWriter::destroy(){
+    if (!header)
+        return;
+    // wake readers waiting in next() so they see the ring is closed; their mappings stay valid until they close
+    header->state = SHM_RING_CLOSED;
+    __sync_synchronize();
+    header->notify = header->notify+1;
+    futexWake(&header->notify);
+    munmap(header, map_bytes);
+    shm_unlink(ring_name.c_str());
+    header = NULL;
+    map_bytes = 0;
+    ring_name.clear();
+}
+
+shmRingBlock* shmRingWriter::begin(){
+    if (!header)
+        return NULL;
+    shmRingBlock *block = reinterpret_cast<shmRingBlock*>(reinterpret_cast<char*>(header)+header->header_bytes+
+            (header->write_seq%header->num_slots)*header->slot_bytes);
+    // invalidate the slot before overwriting it, so a reader still using the block it held sees the change
+    block->seq = 0;
+    __sync_synchronize();
+    return block;
+}
+
+void shmRingWriter::commit(){
+    if (!header)
+        return;
+    const uint64_t seq = header->write_seq;
+    shmRingBlock *block = reinterpret_cast<shmRingBlock*>(reinterpret_cast<char*>(header)+header->header_bytes+
+            (seq%header->num_slots)*header->slot_bytes);
+    __sync_synchronize();
+    block->seq = seq+1;
+    __sync_synchronize();
+    header->write_seq = seq+1;
+    header->notify = header->notify+1;
+    futexWake(&header->notify);
+}
+
+shmRingReader::shmRingReader() :
+    header(NULL),
+    map_bytes(0),
+    next_seq(0),
+    current(NULL),
+    current_seq(0),
+    lost_blocks(0)
+{
+}
+
+shmRingReader::~shmRingReader(){
+    close();
+}
+
+bool shmRingReader::open(const std::string &name){
+    close();
+    last_error.clear();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        last_error = errorString("shm_open", name);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(shmRingHeader)) {
+        last_error = "ring "+name+" is not initialized";
+        ::close(fd);
+        return false;
+    }
+    const size_t bytes = st.st_size;
+    void *addr = mmap(NULL, bytes, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        last_error = errorString("mmap", name);
+        return false;
+    }
+
+    const shmRingHeader *hdr = static_cast<const shmRingHeader*>(addr);
+    const bool valid = hdr->magic == SHM_RING_MAGIC;
+    __sync_synchronize();
+    if (!valid || hdr->version != SHM_RING_VERSION || hdr->num_slots == 0 ||
+            hdr->header_bytes+size_t(hdr->num_slots)*hdr->slot_bytes > bytes) {
+        last_error = "ring "+name+" is not initialized or has an unsupported layout";
+        munmap(addr, bytes);
+        return false;
+    }
+    header = hdr;
+    map_bytes = bytes;
+    next_seq = header->write_seq;
+    current = NULL;
+    lost_blocks = 0;
+    return true;
+}
+
+void shmRingReader::close(){
+    if (!header)
+        return;
+    munmap(const_cast<shmRingHeader*>(header), map_bytes);
+    header = NULL;
+    map_bytes = 0;
+    current = NULL;
+}
+
+bool shmRingReader::closed() const {
+    return header && header->state != SHM_RING_OPEN;
+}
+
+const shmRingBlock* shmRingReader::slot(uint64_t seq) const {
+    return reinterpret_cast<const shmRingBlock*>(reinterpret_cast<const char*>(header)+header->header_bytes+
+            (seq%header->num_slots)*header->slot_bytes);
+}
+
+const shmRingBlock* shmRingReader::next(long timeout_ms){
+    current = NULL;
+    if (!header)
+        return NULL;
+    const uint64_t deadline = monotonicMs()+(timeout_ms > 0 ? timeout_ms : 0);
+    while (header->state == SHM_RING_OPEN) {
+        // read notify before write_seq, so a commit between the two changes notify and the wait returns at once
+        const uint32_t notify = header->notify;
+        __sync_synchronize();
+        const uint64_t write_seq = header->write_seq;
+        if (next_seq < write_seq) {
+            // the writer may be filling the slot of the oldest block still listed, so start one later
+            if (write_seq-next_seq >= header->num_slots) {
+                lost_blocks += write_seq-header->num_slots+1-next_seq;
+                next_seq = write_seq-header->num_slots+1;
+            }
+            const shmRingBlock *block = slot(next_seq);
+            __sync_synchronize();
+            if (block->seq == next_seq+1) {
+                current = block;
+                current_seq = next_seq++;
+                return block;
+            }
+            // overwritten since write_seq was read
+            lost_blocks++;
+            next_seq++;
+            continue;
+        }
+        if (timeout_ms == 0)
+            return NULL;
+        if (timeout_ms < 0) {
+            futexWait(&header->notify, notify, NULL);
+        } else {
+            const uint64_t now = monotonicMs();
+            if (now >= deadline)
+                return NULL;
+            struct timespec ts;
+            ts.tv_sec = (deadline-now)/1000;
+            ts.tv_nsec = ((deadline-now)%1000)*1000000;
+            futexWait(&header->notify, notify, &ts);
+        }
+    }
+    return NULL;
+}
+
+bool shmRingReader::intact() const {
+    if (!current)
+        return false;
+    __sync_synchronize();
+    return current->seq == current_seq+1;
+}
@@ -0,0 +1,176 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_SHMRING_H
+#define USRP_UHD_SHMRING_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+
+/** Ring of sample blocks in a POSIX shared memory object, published by the device for readers on the same host.
+ *
+ *  The object holds a shmRingHeader followed by num_slots slots, each a shmRingBlock and room for max_samples
+ *  shorts. Block n (counting from 0) goes in slot n%num_slots. The writer never waits for readers: a reader that
+ *  falls more than num_slots blocks behind loses the oldest ones. Readers map the object read only, so any number
+ *  of them can read the same block without copying it and without affecting the writer or each other.
+ *
+ *  Each block's seq is 0 while its slot is being written and n+1 once block n is complete. Readers check it before
+ *  and after using a block (see shmRingReader::intact) to detect a slot reused while they read it. write_seq is the
+ *  number of blocks published, and notify changes with it so that readers can sleep on it with a futex.
+ *
+ *  Only the device and the reader below depend on this layout; bump SHM_RING_VERSION when it changes.
+ */
+#define SHM_RING_MAGIC   0x55534852 // "USHR"
+#define SHM_RING_VERSION 1
+
+// shmRingHeader::state
+#define SHM_RING_OPEN   1
+#define SHM_RING_CLOSED 2 // the writer has removed the ring, readers should close and open it again
+
+// shmRingBlock::flags
+#define SHM_RING_EOS         0x1 // last block of the stream
+#define SHM_RING_SRI_CHANGED 0x2 // sample rate, frequency, bandwidth or stream id differ from the previous block
+
+struct shmRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_bytes; // offset of the first slot
+    uint32_t slot_bytes; // size of a slot, block and samples
+    uint32_t num_slots;
+    uint32_t max_samples; // shorts per slot, I and Q interleaved
+    int32_t writer_pid;
+    volatile uint32_t state;
+    volatile uint64_t write_seq;
+    volatile uint32_t notify;
+};
+
+struct shmRingBlock {
+    volatile uint64_t seq;
+    uint32_t num_samples; // shorts, I and Q interleaved
+    uint32_t flags;
+    uint32_t tuner_id;
+    int16_t mode; // 1 for complex samples, as in BULKIO::StreamSRI
+    // time of the first sample, as in BULKIO::PrecisionUTCTime
+    int16_t tcmode;
+    int16_t tcstatus;
+    double toff;
+    double twsec;
+    double tfsec;
+    // SRI
+    double xdelta;
+    double center_frequency;
+    double bandwidth;
+    char stream_id[128];
+
+    const short* samples() const { return reinterpret_cast<const short*>(this+1); }
+    short* samples() { return reinterpret_cast<short*>(this+1); }
+};
+
+/** Creates the ring and publishes blocks to it. There is one writer per ring, and the object is removed when
+ *  the writer is destroyed. Not thread safe: the owner serializes calls, as the tuner lock does in the device.
+ */
+class shmRingWriter {
+public:
+    shmRingWriter();
+    ~shmRingWriter();
+
+    // creates the named object, readable by this user and group. name is a single "/name" component. A ring of the
+    // same name left by a writer of this user that is no longer running is replaced; any other object of that
+    // name is left alone and create() fails. Returns false and sets error() on failure.
+    bool create(const std::string &name, size_t num_slots, size_t max_samples);
+    // marks the ring closed for readers and removes it
+    void destroy();
+
+    bool isOpen() const { return header != NULL; }
+    const std::string& name() const { return ring_name; }
+    size_t numSlots() const { return header ? header->num_slots : 0; }
+    size_t maxSamples() const { return header ? header->max_samples : 0; }
+    const std::string& error() const { return last_error; }
+
+    // the slot for the next block, marked incomplete. Fill in its fields and up to maxSamples() samples, then
+    // commit() it. Calling begin() again without commit() reuses the same slot.
+    shmRingBlock* begin();
+    // publishes the block from begin() and wakes waiting readers
+    void commit();
+
+private:
+    shmRingWriter(const shmRingWriter&);
+    shmRingWriter& operator=(const shmRingWriter&);
+
+    shmRingHeader *header;
+    size_t map_bytes;
+    std::string ring_name;
+    std::string last_error;
+};
+
+/** Reads blocks from a ring created by shmRingWriter. Blocks are returned in order and in place, as pointers
+ *  into the shared object, so a block must be used before the writer wraps around to its slot again:
+ *
+ *      const shmRingBlock *block = reader.next(100);
+ *      if (block) {
+ *          process(block->samples(), block->num_samples);
+ *          if (!reader.intact())
+ *              // the writer reused the slot while it was processed, so discard the result
+ *      }
+ *
+ *  Copy the block out first if it is needed for longer than num_slots blocks take to arrive.
+ *  Readers do not share state, so each thread or process uses its own shmRingReader.
+ */
+class shmRingReader {
+public:
+    shmRingReader();
+    ~shmRingReader();
+
+    // maps the named object, starting with the next block published. Returns false and sets error() on failure.
+    bool open(const std::string &name);
+    void close();
+
+    bool isOpen() const { return header != NULL; }
+    // true once the writer has removed the ring; next() then returns NULL and the reader should be opened again
+    bool closed() const;
+    size_t numSlots() const { return header ? header->num_slots : 0; }
+    size_t maxSamples() const { return header ? header->max_samples : 0; }
+    const std::string& error() const { return last_error; }
+
+    // the next block, waiting up to timeout_ms for it to be published (0 does not wait, negative waits
+    // indefinitely). NULL on timeout, or once the ring is closed.
+    const shmRingBlock* next(long timeout_ms);
+    // true if the block last returned by next() has not been overwritten since
+    bool intact() const;
+
+    // num blocks overwritten before they were read
+    uint64_t lost() const { return lost_blocks; }
+
+private:
+    shmRingReader(const shmRingReader&);
+    shmRingReader& operator=(const shmRingReader&);
+
+    const shmRingBlock* slot(uint64_t seq) const;
+
+    const shmRingHeader *header;
+    size_t map_bytes;
+    uint64_t next_seq;
+    const shmRingBlock *current;
+    uint64_t current_seq;
+    uint64_t lost_blocks;
+    std::string last_error;
+};
+
+#endif
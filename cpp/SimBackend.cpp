@@ -0,0 +1,590 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "SimBackend.h"
+#include "HotPathMetrics.h"
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <sstream>
+#include <uhd/exception.hpp>
+
+namespace {
+
+const size_t SIM_PACKET_SAMPS = 2000; // max samps per recv with one_packet
+const double SIM_BUFFER_SECS = 0.5; // device time buffered for RX before overflow, and for TX before send blocks
+const size_t SINE_BITS = 10;
+
+// approximately Gaussian with unit variance, the sum of 4 uniform values
+inline float simNoise(uint32_t& state){
+    uint32_t a = state;
+    a ^= a << 13; a ^= a >> 17; a ^= a << 5;
+    uint32_t b = a;
+    b ^= b << 13; b ^= b >> 17; b ^= b << 5;
+    state = b;
+    const int32_t sum = (a & 0xffff) + (a >> 16) + (b & 0xffff) + (b >> 16);
+    return (sum - 131070) * (1.7320508f/65536.0f);
+}
+
+inline short simClip(float value, float limit){
+    value = std::min(std::max(value, -limit), limit);
+    return short(value >= 0.0f ? value+0.5f : value-0.5f);
+}
+
+class simRxStreamer : public uhd::rx_streamer {
+public:
+    simRxStreamer(simBackend::sptr sim, size_t chan, double full_scale) :
+        sim(sim), chan(chan), full_scale(full_scale) {}
+
+    size_t get_num_channels() const { return 1; }
+    size_t get_max_num_samps() const { return SIM_PACKET_SAMPS; }
+
+    size_t recv(const buffs_type& buffs, const size_t nsamps_per_buff, uhd::rx_metadata_t& metadata,
+            const double timeout = 0.1, const bool one_packet = false){
+        return sim->recv(chan, static_cast<short*>(buffs[0]), nsamps_per_buff, metadata, timeout, one_packet, full_scale);
+    }
+
+    void issue_stream_cmd(const uhd::stream_cmd_t& stream_cmd){
+        sim->issue_stream_cmd(stream_cmd, chan);
+    }
+
+private:
+    simBackend::sptr sim;
+    size_t chan;
+    double full_scale;
+};
+
+class simTxStreamer : public uhd::tx_streamer {
+public:
+    simTxStreamer(simBackend::sptr sim, size_t chan) : sim(sim), chan(chan) {}
+
+    size_t get_num_channels() const { return 1; }
+    size_t get_max_num_samps() const { return SIM_PACKET_SAMPS; }
+
+    size_t send(const buffs_type& buffs, const size_t nsamps_per_buff, const uhd::tx_metadata_t& metadata,
+            const double timeout = 0.1){
+        return sim->send(chan, nsamps_per_buff, timeout);
+    }
+
+    bool recv_async_msg(uhd::async_metadata_t& async_metadata, double timeout = 0.1){
+        struct timespec ts;
+        ts.tv_sec = time_t(timeout);
+        ts.tv_nsec = long((timeout-ts.tv_sec)*1e9);
+        nanosleep(&ts, NULL);
+        return false;
+    }
+
+private:
+    simBackend::sptr sim;
+    size_t chan;
+};
+
+} // namespace
+
+simBackend::simBackend(const sim_device_struct& settings) :
+    settings(settings),
+    master_clock_rate(settings.master_clock_rate),
+    max_decimation(std::max(settings.max_decimation, (unsigned short) 1)),
+    freq_range(settings.freq_min, settings.freq_max),
+    bandwidth_range(settings.bandwidth_min, settings.bandwidth_max),
+    gain_range(0.0, settings.gain_max, 0.5),
+    time_base(0.0),
+    time_base_ns(hotPathNow())
+{
+    // master clock rate divided by each decimation, in increasing order
+    for (unsigned short decim = max_decimation; decim >= 1; decim--)
+        rates.push_back(uhd::range_t(master_clock_rate/decim));
+
+    sine.resize(1 << SINE_BITS);
+    for (size_t i = 0; i < sine.size(); i++)
+        sine[i] = sin(2*M_PI*i/sine.size());
+
+    rx.resize(settings.num_rx_channels);
+    tx.resize(settings.num_tx_channels);
+    for (size_t chan = 0; chan < rx.size(); chan++) {
+        rx[chan].freq = freq_range.start();
+        rx[chan].rate = rates.start();
+        rx[chan].bandwidth = bandwidth_range.clip(rx[chan].rate);
+        rx[chan].antenna = "RX2";
+        rx[chan].noise_state = 2463534242UL + chan;
+    }
+    for (size_t chan = 0; chan < tx.size(); chan++) {
+        tx[chan].freq = freq_range.start();
+        tx[chan].rate = rates.start();
+        tx[chan].bandwidth = bandwidth_range.clip(tx[chan].rate);
+        tx[chan].antenna = "TX/RX";
+    }
+}
+
+void simBackend::configure(const sim_device_struct& new_settings){
+    boost::mutex::scoped_lock guard(lock);
+    // keep the device clock continuous across a change of time_scale
+    const uint64_t now = hotPathNow();
+    time_base = deviceTime(now);
+    time_base_ns = now;
+    const bool rescaled = new_settings.time_scale != settings.time_scale;
+    settings = new_settings;
+    if (rescaled) {
+        for (size_t chan = 0; chan < rx.size(); chan++) {
+            if (rx[chan].streaming)
+                restartStream(rx[chan]);
+        }
+    }
+}
+
+void simBackend::injectOverflow(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    for (size_t i = 0; i < rx.size(); i++) {
+        if (chan == ALL_CHANS || chan == i)
+            rx[i].pending_overflows++;
+    }
+}
+
+void simBackend::injectTimeout(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    for (size_t i = 0; i < rx.size(); i++) {
+        if (chan == ALL_CHANS || chan == i)
+            rx[i].pending_timeouts++;
+    }
+}
+
+void simBackend::set_time_now(const uhd::time_spec_t& time_spec, size_t mboard){
+    boost::mutex::scoped_lock guard(lock);
+    time_base = time_spec;
+    time_base_ns = hotPathNow();
+}
+
+uhd::time_spec_t simBackend::get_time_now(size_t mboard){
+    boost::mutex::scoped_lock guard(lock);
+    return deviceTime(hotPathNow());
+}
+
+// the simulated PPS is at each whole second of device time
+void simBackend::set_time_next_pps(const uhd::time_spec_t& time_spec, size_t mboard){
+    boost::mutex::scoped_lock guard(lock);
+    const uint64_t now_ns = hotPathNow();
+    const uhd::time_spec_t now = deviceTime(now_ns);
+    time_base = time_spec - uhd::time_spec_t(1.0 - now.get_frac_secs());
+    time_base_ns = now_ns;
+}
+
+uhd::time_spec_t simBackend::get_time_last_pps(size_t mboard){
+    boost::mutex::scoped_lock guard(lock);
+    return uhd::time_spec_t(deviceTime(hotPathNow()).get_full_secs());
+}
+
+/* acquire lock prior to calling this function */
+uhd::time_spec_t simBackend::deviceTime(uint64_t host_ns) const {
+    const double scale = (settings.time_scale > 0.0) ? settings.time_scale : 1.0;
+    return time_base + uhd::time_spec_t(double(int64_t(host_ns-time_base_ns))*1e-9*scale);
+}
+
+/* acquire lock prior to calling this function */
+uint64_t simBackend::hostTime(const uhd::time_spec_t& device_time) const {
+    const double scale = (settings.time_scale > 0.0) ? settings.time_scale : 1.0;
+    return time_base_ns + int64_t((device_time-time_base).get_real_secs()/scale*1e9);
+}
+
+/* acquire lock prior to calling this function */
+void simBackend::restartStream(simChannel& ch){
+    ch.start_ns = hotPathNow();
+    ch.start_time = deviceTime(ch.start_ns);
+    ch.next_samp = 0;
+}
+
+double simBackend::coerceRate(double rate) const {
+    double decim = floor(master_clock_rate/std::max(rate, 1.0) + 0.5);
+    decim = std::min(std::max(decim, 1.0), double(max_decimation));
+    return master_clock_rate/decim;
+}
+
+void simBackend::sleepUntil(uint64_t host_ns){
+    struct timespec ts;
+    ts.tv_sec = host_ns/1000000000ULL;
+    ts.tv_nsec = host_ns%1000000000ULL;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR)
+        ;
+}
+
+/*************************************************************
+RX
+*************************************************************/
+std::string simBackend::get_rx_subdev_name(size_t chan){
+    std::ostringstream name;
+    name << "SIM RX" << chan;
+    return name.str();
+}
+
+uhd::rx_streamer::sptr simBackend::get_rx_stream(const uhd::stream_args_t& args){
+    const size_t chan = args.channels.empty() ? 0 : args.channels[0];
+    if (chan >= rx.size())
+        throw uhd::index_error("simBackend: no RX channel for stream");
+    if (args.cpu_format != "sc16")
+        throw uhd::value_error("simBackend: RX only supports cpu_format sc16");
+    const double full_scale = (args.otw_format == "sc8") ? 127.0 : 32767.0;
+    return uhd::rx_streamer::sptr(new simRxStreamer(shared_from_this(), chan, full_scale));
+}
+
+void simBackend::issue_stream_cmd(const uhd::stream_cmd_t& stream_cmd, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    const uint64_t now = hotPathNow();
+    for (size_t i = 0; i < rx.size(); i++) {
+        if (chan != ALL_CHANS && chan != i)
+            continue;
+        simChannel& ch = rx[i];
+        if (stream_cmd.stream_mode == uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS) {
+            ch.streaming = false;
+            continue;
+        }
+        ch.streaming = true;
+        ch.samps_left = 0;
+        if (stream_cmd.stream_mode != uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS)
+            ch.samps_left = stream_cmd.num_samps;
+        ch.late_command = false;
+        if (stream_cmd.stream_now) {
+            restartStream(ch);
+        } else {
+            ch.start_time = stream_cmd.time_spec;
+            ch.start_ns = hostTime(stream_cmd.time_spec);
+            ch.next_samp = 0;
+            ch.late_command = (ch.start_ns < now);
+        }
+    }
+}
+
+void simBackend::set_rx_rate(double rate, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    for (size_t i = 0; i < rx.size(); i++) {
+        if (chan != ALL_CHANS && chan != i)
+            continue;
+        rx[i].rate = coerceRate(rate);
+        if (rx[i].streaming)
+            restartStream(rx[i]);
+    }
+}
+
+double simBackend::get_rx_rate(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return rx.at(chan).rate;
+}
+
+uhd::tune_result_t simBackend::set_rx_freq(const uhd::tune_request_t& tune_request, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    simChannel& ch = rx.at(chan);
+    ch.freq = freq_range.clip(tune_request.target_freq);
+    ch.tuned_ns = hotPathNow();
+    uhd::tune_result_t result;
+    result.clipped_rf_freq = ch.freq;
+    result.target_rf_freq = ch.freq;
+    result.actual_rf_freq = ch.freq;
+    result.target_dsp_freq = 0.0;
+    result.actual_dsp_freq = 0.0;
+    return result;
+}
+
+/* get_rx_freq reports the new freq immediately, as it does for a USRP, and the stream marks the change
+ * with a phase discontinuity at the first sample at or after cmd_time
+ */
+uhd::tune_result_t simBackend::set_rx_freq_timed(const uhd::tune_request_t& tune_request, const uhd::time_spec_t& cmd_time, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    simChannel& ch = rx.at(chan);
+    ch.freq = freq_range.clip(tune_request.target_freq);
+    ch.tuned_ns = std::max(hostTime(cmd_time), hotPathNow());
+    ch.retunes.insert(std::upper_bound(ch.retunes.begin(), ch.retunes.end(), cmd_time), cmd_time);
+    uhd::tune_result_t result;
+    result.clipped_rf_freq = ch.freq;
+    result.target_rf_freq = ch.freq;
+    result.actual_rf_freq = ch.freq;
+    result.target_dsp_freq = 0.0;
+    result.actual_dsp_freq = 0.0;
+    return result;
+}
+
+double simBackend::get_rx_freq(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return rx.at(chan).freq;
+}
+
+void simBackend::set_rx_gain(double gain, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    rx.at(chan).gain = gain_range.clip(gain, true);
+}
+
+double simBackend::get_rx_gain(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return rx.at(chan).gain;
+}
+
+void simBackend::set_rx_antenna(const std::string& ant, size_t chan){
+    const std::vector<std::string> antennas = get_rx_antennas(chan);
+    if (std::find(antennas.begin(), antennas.end(), ant) == antennas.end())
+        throw uhd::value_error("simBackend: invalid RX antenna "+ant);
+    boost::mutex::scoped_lock guard(lock);
+    rx.at(chan).antenna = ant;
+}
+
+std::string simBackend::get_rx_antenna(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return rx.at(chan).antenna;
+}
+
+std::vector<std::string> simBackend::get_rx_antennas(size_t chan){
+    std::vector<std::string> antennas;
+    antennas.push_back("TX/RX");
+    antennas.push_back("RX2");
+    return antennas;
+}
+
+void simBackend::set_rx_bandwidth(double bandwidth, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    rx.at(chan).bandwidth = bandwidth_range.clip(bandwidth);
+}
+
+double simBackend::get_rx_bandwidth(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return rx.at(chan).bandwidth;
+}
+
+uhd::sensor_value_t simBackend::get_rx_sensor(const std::string& name, size_t chan){
+    if (name != "lo_locked")
+        throw uhd::key_error("simBackend: no RX sensor "+name);
+    boost::mutex::scoped_lock guard(lock);
+    const uint64_t now = hotPathNow();
+    const uint64_t tuned_ns = rx.at(chan).tuned_ns;
+    const bool locked = now >= tuned_ns && (now-tuned_ns) >= uint64_t(std::max(settings.lo_lock_time_ms, 0.0)*1e6);
+    return uhd::sensor_value_t("LO", locked, "locked", "unlocked");
+}
+
+/* Produces up to nsamps of the channel's signal, waiting until the device clock reaches the last of them or
+ * until the timeout. Returns 0 with an error code for a timeout (or if not streaming), a late stream
+ * command, or an overflow.
+ */
+size_t simBackend::recv(size_t chan, short* buff, size_t nsamps, uhd::rx_metadata_t& metadata, double timeout,
+        bool one_packet, double full_scale){
+    metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+    metadata.has_time_spec = false;
+    metadata.more_fragments = false;
+    metadata.fragment_offset = 0;
+    metadata.start_of_burst = false;
+    metadata.end_of_burst = false;
+    metadata.out_of_sequence = false;
+
+    const uint64_t deadline_ns = hotPathNow() + uint64_t(std::max(timeout, 0.0)*1e9);
+    boost::mutex::scoped_lock guard(lock);
+    simChannel& ch = rx.at(chan);
+    if (ch.late_command) {
+        ch.late_command = false;
+        ch.streaming = false;
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND;
+        return 0;
+    }
+    if (!ch.streaming || ch.pending_timeouts > 0) {
+        if (ch.streaming)
+            ch.pending_timeouts--;
+        guard.unlock();
+        sleepUntil(deadline_ns);
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+        return 0;
+    }
+    if (ch.pending_overflows > 0) {
+        // samps are lost, as they are when the device buffer fills
+        ch.pending_overflows--;
+        ch.next_samp += SIM_PACKET_SAMPS;
+        metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+        return 0;
+    }
+    if (one_packet)
+        nsamps = std::min(nsamps, SIM_PACKET_SAMPS);
+    if (ch.samps_left > 0)
+        nsamps = std::min(nsamps, size_t(ch.samps_left));
+
+    const double samps_per_ns = ch.rate*settings.time_scale*1e-9;
+    if (samps_per_ns > 0.0) {
+        const uint64_t now = hotPathNow();
+        const uint64_t produced = (now > ch.start_ns) ? uint64_t((now-ch.start_ns)*samps_per_ns) : 0;
+        if (produced > ch.next_samp + uint64_t(ch.rate*SIM_BUFFER_SECS)) {
+            // fell behind by more than the device buffers, so drop the backlog
+            ch.next_samp = produced;
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_OVERFLOW;
+            return 0;
+        }
+        uint64_t ready_ns = ch.start_ns + uint64_t((ch.next_samp+nsamps)/samps_per_ns);
+        if (ready_ns > deadline_ns) {
+            const uint64_t by_deadline = (deadline_ns > ch.start_ns) ? uint64_t((deadline_ns-ch.start_ns)*samps_per_ns) : 0;
+            nsamps = (by_deadline > ch.next_samp) ? std::min(size_t(by_deadline-ch.next_samp), nsamps) : 0;
+            ready_ns = deadline_ns;
+        }
+        guard.unlock();
+        sleepUntil(ready_ns);
+        if (nsamps == 0) {
+            metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_TIMEOUT;
+            return 0;
+        }
+        guard.lock();
+    }
+
+    const float limit = full_scale;
+    const float tone_amp = (settings.signal != "noise") ? full_scale*pow(10.0, (settings.tone_dbfs+ch.gain)/20.0) : 0.0;
+    const float noise_amp = full_scale*pow(10.0, (settings.noise_dbfs+ch.gain)/20.0)/M_SQRT2; // per component
+    const uint32_t phase_inc = uint32_t(int64_t(fmod(settings.tone_offset/ch.rate, 1.0)*4294967296.0));
+    const uint32_t quarter = 1U << (SINE_BITS-2);
+    const uint32_t mask = (1U << SINE_BITS)-1;
+    uint32_t phase = ch.phase;
+    uint32_t noise_state = ch.noise_state;
+
+    // offsets of the timed retunes within these samps, where the tone restarts
+    std::vector<size_t> retunes;
+    while (!ch.retunes.empty()) {
+        const double at = (ch.retunes.front()-ch.start_time).get_real_secs()*ch.rate;
+        const uint64_t samp = (at > 0.0) ? uint64_t(ceil(at-1e-6)) : 0;
+        if (samp >= ch.next_samp+nsamps)
+            break;
+        retunes.push_back((samp > ch.next_samp) ? size_t(samp-ch.next_samp) : 0);
+        ch.retunes.pop_front();
+    }
+    size_t next_retune = 0;
+
+    for (size_t i = 0; i < nsamps; i++) {
+        for (; next_retune < retunes.size() && retunes[next_retune] == i; next_retune++)
+            phase = 0;
+        const uint32_t index = phase >> (32-SINE_BITS);
+        buff[2*i] = simClip(tone_amp*sine[(index+quarter) & mask] + noise_amp*simNoise(noise_state), limit);
+        buff[2*i+1] = simClip(tone_amp*sine[index] + noise_amp*simNoise(noise_state), limit);
+        phase += phase_inc;
+    }
+    ch.phase = phase;
+    ch.noise_state = noise_state;
+
+    metadata.has_time_spec = true;
+    metadata.time_spec = ch.start_time + uhd::time_spec_t::from_ticks(ch.next_samp, ch.rate);
+    metadata.start_of_burst = (ch.next_samp == 0);
+    ch.next_samp += nsamps;
+    if (ch.samps_left > 0) {
+        ch.samps_left -= nsamps;
+        if (ch.samps_left == 0) {
+            ch.streaming = false;
+            metadata.end_of_burst = true;
+        }
+    }
+    return nsamps;
+}
+
+/*************************************************************
+TX
+*************************************************************/
+std::string simBackend::get_tx_subdev_name(size_t chan){
+    std::ostringstream name;
+    name << "SIM TX" << chan;
+    return name.str();
+}
+
+uhd::tx_streamer::sptr simBackend::get_tx_stream(const uhd::stream_args_t& args){
+    const size_t chan = args.channels.empty() ? 0 : args.channels[0];
+    if (chan >= tx.size())
+        throw uhd::index_error("simBackend: no TX channel for stream");
+    return uhd::tx_streamer::sptr(new simTxStreamer(shared_from_this(), chan));
+}
+
+void simBackend::set_tx_rate(double rate, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    for (size_t i = 0; i < tx.size(); i++) {
+        if (chan == ALL_CHANS || chan == i)
+            tx[i].rate = coerceRate(rate);
+    }
+}
+
+double simBackend::get_tx_rate(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return tx.at(chan).rate;
+}
+
+uhd::tune_result_t simBackend::set_tx_freq(const uhd::tune_request_t& tune_request, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    simChannel& ch = tx.at(chan);
+    ch.freq = freq_range.clip(tune_request.target_freq);
+    ch.tuned_ns = hotPathNow();
+    uhd::tune_result_t result;
+    result.clipped_rf_freq = ch.freq;
+    result.target_rf_freq = ch.freq;
+    result.actual_rf_freq = ch.freq;
+    result.target_dsp_freq = 0.0;
+    result.actual_dsp_freq = 0.0;
+    return result;
+}
+
+double simBackend::get_tx_freq(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return tx.at(chan).freq;
+}
+
+void simBackend::set_tx_gain(double gain, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    tx.at(chan).gain = gain_range.clip(gain, true);
+}
+
+double simBackend::get_tx_gain(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return tx.at(chan).gain;
+}
+
+void simBackend::set_tx_antenna(const std::string& ant, size_t chan){
+    const std::vector<std::string> antennas = get_tx_antennas(chan);
+    if (std::find(antennas.begin(), antennas.end(), ant) == antennas.end())
+        throw uhd::value_error("simBackend: invalid TX antenna "+ant);
+    boost::mutex::scoped_lock guard(lock);
+    tx.at(chan).antenna = ant;
+}
+
+std::string simBackend::get_tx_antenna(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return tx.at(chan).antenna;
+}
+
+std::vector<std::string> simBackend::get_tx_antennas(size_t chan){
+    return std::vector<std::string>(1, "TX/RX");
+}
+
+void simBackend::set_tx_bandwidth(double bandwidth, size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    tx.at(chan).bandwidth = bandwidth_range.clip(bandwidth);
+}
+
+double simBackend::get_tx_bandwidth(size_t chan){
+    boost::mutex::scoped_lock guard(lock);
+    return tx.at(chan).bandwidth;
+}
+
+/* Accepts nsamps, blocking while more than the device buffer is queued ahead of the device clock. */
+size_t simBackend::send(size_t chan, size_t nsamps, double timeout){
+    boost::mutex::scoped_lock guard(lock);
+    simChannel& ch = tx.at(chan);
+    const double samps_per_ns = ch.rate*settings.time_scale*1e-9;
+    if (samps_per_ns <= 0.0)
+        return nsamps;
+    const uint64_t now = hotPathNow();
+    ch.tx_next_ns = std::max(ch.tx_next_ns, now) + uint64_t(nsamps/samps_per_ns);
+    const uint64_t buffer_ns = uint64_t(SIM_BUFFER_SECS*1e9/settings.time_scale);
+    if (ch.tx_next_ns > now + buffer_ns) {
+        const uint64_t wait_ns = std::min(ch.tx_next_ns-buffer_ns, now + uint64_t(std::max(timeout, 0.0)*1e9));
+        guard.unlock();
+        sleepUntil(wait_ns);
+    }
+    return nsamps;
+}
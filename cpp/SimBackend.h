@@ -0,0 +1,159 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_SIMBACKEND_H
+#define USRP_UHD_SIMBACKEND_H
+
+#include <stdint.h>
+#include <deque>
+#include <boost/enable_shared_from_this.hpp>
+#include <boost/thread/mutex.hpp>
+#include "UsrpBackend.h"
+#include "struct_props.h"
+
+/** Simulated USRP, selected with target_device.type "sim". Channel counts and ranges come from the
+ *  sim_device property when the device is created. Each RX channel produces a tone plus Gaussian noise (or
+ *  noise only), scaled by the channel gain, with time stamps from a simulated device clock that runs at
+ *  time_scale times real time (or is not paced at all when time_scale is 0). A receiver that falls more
+ *  than half a second behind gets an overflow, as it would from a real device, and overflows and
+ *  timeouts can also be injected. TX channels pace and discard the samples sent.
+ */
+class simBackend : public usrpBackend, public boost::enable_shared_from_this<simBackend> {
+public:
+    typedef boost::shared_ptr<simBackend> sptr;
+
+    simBackend(const sim_device_struct& settings);
+
+    // signal, timing and LO lock settings; the rest of sim_device only applies to a new simBackend
+    void configure(const sim_device_struct& settings);
+    void injectOverflow(size_t chan = ALL_CHANS);
+    void injectTimeout(size_t chan = ALL_CHANS);
+
+    size_t get_num_mboards() { return 1; }
+    std::string get_mboard_name(size_t mboard) { return "SIM"; }
+    void set_time_now(const uhd::time_spec_t& time_spec, size_t mboard);
+    void set_clock_source(const std::string& source, size_t mboard) {}
+    void set_time_source(const std::string& source, size_t mboard) {}
+    uhd::time_spec_t get_time_now(size_t mboard);
+    void set_time_next_pps(const uhd::time_spec_t& time_spec, size_t mboard);
+    uhd::time_spec_t get_time_last_pps(size_t mboard);
+    std::string get_mboard_addr(size_t mboard) { return ""; }
+    size_t get_rx_mboard(size_t chan) { return 0; }
+    size_t get_tx_mboard(size_t chan) { return 0; }
+
+    size_t get_rx_num_channels() { return rx.size(); }
+    std::string get_rx_subdev_name(size_t chan);
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t& args);
+    void issue_stream_cmd(const uhd::stream_cmd_t& stream_cmd, size_t chan);
+    void set_rx_rate(double rate, size_t chan);
+    double get_rx_rate(size_t chan);
+    uhd::meta_range_t get_rx_rates(size_t chan) { return rates; }
+    uhd::tune_result_t set_rx_freq(const uhd::tune_request_t& tune_request, size_t chan);
+    uhd::tune_result_t set_rx_freq_timed(const uhd::tune_request_t& tune_request, const uhd::time_spec_t& cmd_time, size_t chan);
+    double get_rx_freq(size_t chan);
+    uhd::freq_range_t get_rx_freq_range(size_t chan) { return freq_range; }
+    void set_rx_gain(double gain, size_t chan);
+    double get_rx_gain(size_t chan);
+    uhd::gain_range_t get_rx_gain_range(size_t chan) { return gain_range; }
+    void set_rx_antenna(const std::string& ant, size_t chan);
+    std::string get_rx_antenna(size_t chan);
+    std::vector<std::string> get_rx_antennas(size_t chan);
+    void set_rx_bandwidth(double bandwidth, size_t chan);
+    double get_rx_bandwidth(size_t chan);
+    uhd::meta_range_t get_rx_bandwidth_range(size_t chan) { return bandwidth_range; }
+    uhd::sensor_value_t get_rx_sensor(const std::string& name, size_t chan);
+    std::vector<double> get_rx_clock_rates(size_t chan) { return std::vector<double>(1, master_clock_rate); }
+
+    size_t get_tx_num_channels() { return tx.size(); }
+    std::string get_tx_subdev_name(size_t chan);
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t& args);
+    void set_tx_rate(double rate, size_t chan);
+    double get_tx_rate(size_t chan);
+    uhd::meta_range_t get_tx_rates(size_t chan) { return rates; }
+    uhd::tune_result_t set_tx_freq(const uhd::tune_request_t& tune_request, size_t chan);
+    double get_tx_freq(size_t chan);
+    uhd::freq_range_t get_tx_freq_range(size_t chan) { return freq_range; }
+    void set_tx_gain(double gain, size_t chan);
+    double get_tx_gain(size_t chan);
+    uhd::gain_range_t get_tx_gain_range(size_t chan) { return gain_range; }
+    void set_tx_antenna(const std::string& ant, size_t chan);
+    std::string get_tx_antenna(size_t chan);
+    std::vector<std::string> get_tx_antennas(size_t chan);
+    void set_tx_bandwidth(double bandwidth, size_t chan);
+    double get_tx_bandwidth(size_t chan);
+    uhd::meta_range_t get_tx_bandwidth_range(size_t chan) { return bandwidth_range; }
+    std::vector<double> get_tx_clock_rates(size_t chan) { return std::vector<double>(1, master_clock_rate); }
+
+    // called by the streamers
+    size_t recv(size_t chan, short* buff, size_t nsamps, uhd::rx_metadata_t& metadata, double timeout,
+            bool one_packet, double full_scale);
+    size_t send(size_t chan, size_t nsamps, double timeout);
+
+private:
+    struct simChannel {
+        simChannel() : freq(0.0), rate(0.0), gain(0.0), bandwidth(0.0), tuned_ns(0), streaming(false),
+                start_ns(0), next_samp(0), samps_left(0), late_command(false), phase(0),
+                noise_state(0), pending_overflows(0), pending_timeouts(0), tx_next_ns(0) {}
+
+        double freq;
+        double rate;
+        double gain;
+        double bandwidth;
+        std::string antenna;
+        uint64_t tuned_ns; // host time of last freq change, for lo_locked
+        std::deque<uhd::time_spec_t> retunes; // device times of timed freq changes the stream has not reached, in order
+
+        // RX stream: sample n is available at host time start_ns + n/(rate*time_scale)
+        bool streaming;
+        uint64_t start_ns;
+        uhd::time_spec_t start_time; // device time of sample 0
+        uint64_t next_samp;
+        uint64_t samps_left; // for STREAM_MODE_NUM_SAMPS_*, 0 if continuous
+        bool late_command; // timed stream command was issued for a time already past
+        uint32_t phase;
+        uint32_t noise_state;
+        size_t pending_overflows;
+        size_t pending_timeouts;
+
+        // TX: host time at which the samples sent so far are consumed
+        uint64_t tx_next_ns;
+    };
+
+    uhd::time_spec_t deviceTime(uint64_t host_ns) const;
+    uint64_t hostTime(const uhd::time_spec_t& device_time) const;
+    void restartStream(simChannel& ch);
+    double coerceRate(double rate) const;
+    static void sleepUntil(uint64_t host_ns);
+
+    boost::mutex lock; // protects all but the constant ranges
+    sim_device_struct settings;
+    std::vector<simChannel> rx;
+    std::vector<simChannel> tx;
+    double master_clock_rate;
+    unsigned short max_decimation;
+    uhd::meta_range_t rates;
+    uhd::freq_range_t freq_range;
+    uhd::meta_range_t bandwidth_range;
+    uhd::gain_range_t gain_range;
+    uhd::time_spec_t time_base; // device time at host time time_base_ns
+    uint64_t time_base_ns;
+    std::vector<float> sine; // one cycle
+};
+
+#endif
@@ -0,0 +1,108 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#include "SpectrumScan.h"
+#include <math.h>
+#include <algorithm>
+
+bool psdAccumulator::configure(size_t size){
+    if (size < 2 || (size & (size-1)) != 0)
+        return false;
+    if (size == fft_size) {
+        reset();
+        return true;
+    }
+    fft_size = size;
+
+    size_t bits = 0;
+    while ((size_t(1) << bits) < fft_size)
+        bits++;
+
+    window.resize(fft_size);
+    window_gain = 0.0;
+    for (size_t i = 0; i < fft_size; i++) {
+        window[i] = 0.5f - 0.5f*cos(2*M_PI*i/fft_size);
+        window_gain += window[i];
+    }
+    twiddle.resize(fft_size/2);
+    for (size_t i = 0; i < fft_size/2; i++)
+        twiddle[i] = std::polar(1.0f, float(-2*M_PI*i/fft_size));
+    bit_reverse.resize(fft_size);
+    for (size_t i = 0; i < fft_size; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++)
+            r |= ((i >> b) & 1) << (bits-1-b);
+        bit_reverse[i] = r;
+    }
+    frame.resize(fft_size);
+    power.resize(fft_size);
+    reset();
+    return true;
+}
+
+void psdAccumulator::reset(){
+    filled = 0;
+    num_frames = 0;
+    std::fill(power.begin(), power.end(), 0.0);
+}
+
+size_t psdAccumulator::add(const short *data, size_t num_samps, size_t max_frames){
+    size_t used = 0;
+    while (used < num_samps && num_frames < max_frames) {
+        // windowed samps go straight to their bit reversed position
+        const size_t n = std::min(num_samps-used, fft_size-filled);
+        for (size_t i = 0; i < n; i++, filled++) {
+            const short *samp = data + 2*(used+i);
+            frame[bit_reverse[filled]] = std::complex<float>(samp[0]*window[filled], samp[1]*window[filled]);
+        }
+        used += n;
+        if (filled == fft_size) {
+            transform();
+            for (size_t i = 0; i < fft_size; i++)
+                power[i] += std::norm(frame[i]);
+            filled = 0;
+            num_frames++;
+        }
+    }
+    return used;
+}
+
+/* in place radix 2 decimation in time FFT of frame, which is in bit reversed order */
+void psdAccumulator::transform(){
+    for (size_t len = 2; len <= fft_size; len <<= 1) {
+        const size_t half = len/2;
+        const size_t stride = fft_size/len;
+        for (size_t start = 0; start < fft_size; start += len) {
+            for (size_t k = 0; k < half; k++) {
+                const std::complex<float> t = twiddle[k*stride]*frame[start+k+half];
+                frame[start+k+half] = frame[start+k]-t;
+                frame[start+k] += t;
+            }
+        }
+    }
+}
+
+void psdAccumulator::result(double full_scale, size_t first, size_t count, std::vector<float> &dbfs) const {
+    const double scale = (num_frames > 0) ? 1.0/(num_frames*window_gain*window_gain*full_scale*full_scale) : 0.0;
+    for (size_t i = first; i < first+count && i < fft_size; i++) {
+        // FFT order has DC at bin 0, so shift by half
+        const double p = power[(i+fft_size/2) % fft_size]*scale;
+        dbfs.push_back(float(10.0*log10(std::max(p, 1e-20))));
+    }
+}
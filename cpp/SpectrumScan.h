@@ -0,0 +1,63 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_SPECTRUMSCAN_H
+#define USRP_UHD_SPECTRUMSCAN_H
+
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+/** Averaged power spectrum of interleaved 16-bit I/Q samples (sc16), in frames of fft_size samps with a Hann
+ *  window. Frames do not overlap, and a partial frame is kept until the next add(). Bin powers are scaled so
+ *  that a full scale tone centered in a bin reads 0 dBFS, and are reported in increasing freq order, with DC
+ *  at bin fft_size/2.
+ */
+class psdAccumulator {
+public:
+    psdAccumulator() : fft_size(0), filled(0), num_frames(0) {}
+
+    // fft_size must be a power of 2, returns false otherwise
+    bool configure(size_t fft_size);
+    size_t size() const { return fft_size; }
+
+    void reset();
+
+    // consumes samps until max_frames frames have been accumulated, returns num samps consumed
+    size_t add(const short *data, size_t num_samps, size_t max_frames);
+    size_t frames() const { return num_frames; }
+
+    // mean power of count bins starting at first, relative to full_scale, appended to dbfs
+    void result(double full_scale, size_t first, size_t count, std::vector<float> &dbfs) const;
+
+private:
+    void transform();
+
+    size_t fft_size;
+    size_t filled; // samps in frame
+    size_t num_frames;
+    double window_gain; // sum of window values
+    std::vector<float> window;
+    std::vector<std::complex<float> > twiddle;
+    std::vector<size_t> bit_reverse;
+    std::vector<std::complex<float> > frame;
+    std::vector<double> power; // sum over frames, in FFT order
+};
+
+#endif
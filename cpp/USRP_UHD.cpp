@@ -27,6 +27,9 @@
 **************************************************************************/
 
 #include "USRP_UHD.h"
+#include <fstream>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 PREPARE_LOGGING(USRP_UHD_i)
 
@@ -70,6 +73,10 @@ USRP_UHD_i::~USRP_UHD_i()
     //delete dataSDDS_out;
     dataSDDS_out = 0;
 
+    // push threads are normally released by stop()
+    delete short_push_thread;
+    delete short_push_queue;
+
 }
 
 
@@ -223,77 +230,313 @@ int USRP_UHD_i::serviceFunctionReceive(){
             continue;
 
         //Check to see if channel is allocated before acquiring lock
-        if (getControlAllocationId(tuner_id).empty()) {
+        //Low latency tuners are serviced by their own thread
+        if (getControlAllocationId(tuner_id).empty() || usrp_tuners[tuner_id].low_latency.enabled) {
             continue;
         }
 
         scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
 
         //Check to make sure channel is allocated still
-        if (getControlAllocationId(tuner_id).empty()) {
+        if (getControlAllocationId(tuner_id).empty() || usrp_tuners[tuner_id].low_latency.enabled) {
             continue;
         }
 
-        //Check to see if channel output is enabled
-        if (!frontend_tuner_status[tuner_id].enabled) {
+        //Check to see if channel output is enabled, and its stream has been started
+        if (!frontend_tuner_status[tuner_id].enabled || usrp_tuners[tuner_id].start.state == usrpStartStruct::WAIT_LOCK) {
             continue;
         }
 
         long num_samps = usrpReceive(tuner_id, 1.0); // 1 second timeout
 
-        /* if auto-gain enabled, push data to gain method */
-        if (trigger_rx_autogain) {
-            float newGain = auto_gain(); // auto_gain will set trigger to false if appropriate
-            if(newGain != device_rx_gain_global)
-                updateDeviceRxGain(newGain, false);
+        // check if oldest samps in buffer have waited longer than the latency bound allows
+        bool latency_expired = false;
+        if (usrp_tuners[tuner_id].max_latency > 0.0 && usrp_tuners[tuner_id].buffer_size > 0) {
+            boost::posix_time::time_duration age = boost::get_system_time() - usrp_tuners[tuner_id].buffer_start;
+            latency_expired = age.total_microseconds() >= long(usrp_tuners[tuner_id].max_latency*1e6);
         }
 
-        // if the buffer is full OR (overflow occurred and buffer isn't empty), push buffer out as is and move to next buffer
-        if(usrp_tuners[tuner_id].buffer_size >= usrp_tuners[tuner_id].buffer_capacity ||
-                        (num_samps < 0 && usrp_tuners[tuner_id].buffer_size > 0) ){
+        // if the buffer holds push_size samps (full buffer unless latency bound is set) OR latency bound expired
+        // OR (overflow occurred and buffer isn't empty) OR a hop takes effect at the next samp,
+        // push buffer out as is and move to next buffer
+        if(usrp_tuners[tuner_id].buffer_size >= usrp_tuners[tuner_id].push_size(rxSampleRate(tuner_id)) ||
+                        (latency_expired) ||
+                        (num_samps < 0 && usrp_tuners[tuner_id].buffer_size > 0) ||
+                        usrp_tuners[tuner_id].hops.push ){
             rx_data = true;
 
-            LOG_DEBUG(USRP_UHD_i,"serviceFunctionReceive|pushing buffer of " << usrp_tuners[tuner_id].buffer_size/2 << " samples");
+            pushRxBuffer(tuner_id);
 
-            // get stream id (creates one if not already created for this tuner)
-            std::string stream_id = getStreamId(tuner_id);
+        } else if(num_samps != 0){ // either received data or overflow occurred, either way data is available
+            rx_data = true;
+        }
+    }
+
+    if(rx_data)
+        return NORMAL;
+    return NOOP;
+}
+
+/** LOW LATENCY RECEIVE THREAD(S) **/
+int USRP_UHD_i::serviceFunctionLowLatency(size_t tuner_id){
+    if (usrp_device_ptr.get() == NULL || tuner_id >= usrp_tuners.size())
+        return NOOP;
+
+    //Check to see if channel is in low latency mode before acquiring lock
+    if (!usrp_tuners[tuner_id].low_latency.enabled) {
+        return NOOP;
+    }
+
+    scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+
+    //Check to make sure channel is allocated, enabled and started, and in low latency mode still
+    if (!usrp_tuners[tuner_id].low_latency.enabled || getControlAllocationId(tuner_id).empty() ||
+            !frontend_tuner_status[tuner_id].enabled || usrp_tuners[tuner_id].start.state == usrpStartStruct::WAIT_LOCK) {
+        return NOOP;
+    }
+
+    long num_samps = usrpReceive(tuner_id, usrp_tuners[tuner_id].low_latency.recv_timeout, true);
+    if (num_samps > 0)
+        usrp_tuners[tuner_id].low_latency.packets++;
+
+    // push once enough packets are buffered, the buffer is at its push size, an overflow occurred, or a hop takes effect
+    if (usrp_tuners[tuner_id].buffer_size > 0 &&
+            (usrp_tuners[tuner_id].low_latency.packets >= usrp_tuners[tuner_id].low_latency.packets_per_push ||
+             usrp_tuners[tuner_id].buffer_size >= usrp_tuners[tuner_id].push_size(rxSampleRate(tuner_id)) ||
+             num_samps < 0 || usrp_tuners[tuner_id].hops.push) ){
+
+        // device time of last samp in buffer
+        const double last_samp_time = usrp_tuners[tuner_id].output_buffer_time.twsec + usrp_tuners[tuner_id].output_buffer_time.tfsec +
+                ((usrp_tuners[tuner_id].buffer_size/2)-1) / rxSampleRate(tuner_id);
+
+        pushRxBuffer(tuner_id);
+
+        BULKIO::PrecisionUTCTime now = bulkio::time::utils::now();
+        const double latency = (now.twsec + now.tfsec) - last_samp_time;
+        usrpLowLatencyStruct &ll = usrp_tuners[tuner_id].low_latency;
+        ll.packets = 0;
+        ll.latency_last = latency;
+        ll.latency_min = (ll.pushes == 0) ? latency : std::min(ll.latency_min, latency);
+        ll.latency_max = (ll.pushes == 0) ? latency : std::max(ll.latency_max, latency);
+        ll.latency_sum += latency;
+        ll.pushes++;
+        updateLowLatencyMetrics(tuner_id);
+    }
+
+    // always spin while in low latency mode
+    return NORMAL;
+}
+
+/** AGC THREAD **/
+int USRP_UHD_i::serviceFunctionAgc(){
+    if (usrp_device_ptr.get() == NULL)
+        return NOOP;
+
+    bool adjusted = false;
+
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+
+        //Check to see if a measurement window is ready before acquiring locks
+        if (!usrp_tuners[tuner_id].agc.ready) {
+            continue;
+        }
+
+        rx_agc_struct settings;
+        double gain_min, gain_max, full_scale, target_dbfs;
+        { // scope for prop_lock
+            exclusive_lock lock(prop_lock);
+            if (tuner_id >= device_channels.size())
+                continue;
+            settings = rx_agc;
+            gain_min = device_channels[tuner_id].gain_min;
+            gain_max = device_channels[tuner_id].gain_max;
+            full_scale = (device_rx_mode == "8bit") ? 128.0 : 32768.0;
+            target_dbfs = -6.02 * rx_autogain_guard_bits;
+        } // end scope for prop_lock
+
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrpAgcStruct &agc = usrp_tuners[tuner_id].agc;
+
+        //Check to make sure window is still ready (tuner may have been deallocated)
+        if (!agc.ready) {
+            continue;
+        }
+
+        const double adjust = agcGainAdjustment(agc.stats, agc.one_shot, settings, full_scale, target_dbfs);
+        if (adjust != 0.0) {
+            const double gain = frontend_tuner_status[tuner_id].gain;
+            const double new_gain = std::min(std::max(gain+adjust, gain_min), gain_max);
+            if (frontend::floatingPointCompare(new_gain, gain) != 0) {
+                usrp_device_ptr->set_rx_gain(new_gain, frontend_tuner_status[tuner_id].tuner_number);
+                frontend_tuner_status[tuner_id].gain = usrp_device_ptr->get_rx_gain(frontend_tuner_status[tuner_id].tuner_number);
+                LOG_DEBUG(USRP_UHD_i,"serviceFunctionAgc|tuner_id=" << tuner_id << " adjusted gain from " << gain
+                                    << " to " << frontend_tuner_status[tuner_id].gain << " (requested " << new_gain << ")");
+                adjusted = true;
+            }
+        }
+
+        // start a new window, which excludes samps received before the gain change
+        agc.one_shot = false;
+        agc.stats.reset();
+        agc.ready = false;
+    }
+
+    if (adjusted)
+        return NORMAL;
+    return NOOP;
+}
+
+/** ENABLE THREAD **/
+int USRP_UHD_i::serviceFunctionEnable(){
+    if (usrp_device_ptr.get() == NULL)
+        return NOOP;
+
+    rx_enable_struct settings;
+    size_t open_group = 0; // group of a batch still being allocated
+    bool read_settings = false;
+    bool waiting = false;
+    std::map<size_t, bool> group_ready;
+    std::map<size_t, uhd::time_spec_t> group_command_time;
+    uhd::time_spec_t now; // device time, read once for the tuners of a group
+    bool read_now = false;
+
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+
+        //Check to see if the tuner is waiting for LO lock before acquiring locks
+        if (usrp_tuners[tuner_id].start.state != usrpStartStruct::WAIT_LOCK) {
+            continue;
+        }
+
+        if (!read_settings) {
+            exclusive_lock lock(prop_lock);
+            settings = rx_enable;
+            if (tune_batch.active)
+                open_group = tune_batch.group;
+            read_settings = true;
+        }
+
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrpStartStruct &start = usrp_tuners[tuner_id].start;
+
+        //Check to make sure tuner is still waiting (may have been disabled)
+        if (start.state != usrpStartStruct::WAIT_LOCK) {
+            continue;
+        }
 
-            // Send updated SRI
-            if (usrp_tuners[tuner_id].update_sri){
-                LOG_DEBUG(USRP_UHD_i,"USRP_UHD_i::serviceFunctionReceive|creating SRI for tuner: "<<tuner_id<<" with stream id: "<< stream_id);
-                BULKIO::StreamSRI sri = create(stream_id, frontend_tuner_status[tuner_id]);
-                sri.mode = 1; // complex
-                //printSRI(&sri,"USRP_UHD_i::serviceFunctionReceive SRI"); // DEBUG
-                dataShort_out->pushSRI(sri);
-                dataSDDS_out->pushSRI(sri);
-                usrp_tuners[tuner_id].update_sri = false;
+        if (start.group != 0)
+            group_command_time[start.group] = start.command_time;
+
+        // the LO of a batched tuner is not retuned until command_time, so its lock state is not read before then
+        if (!start.ready && start.group != 0) {
+            if (!read_now) {
+                now = usrp_device_ptr->get_time_now();
+                read_now = true;
+            }
+            if (now < start.command_time) {
+                start.requested = boost::get_system_time(); // lo_lock_timeout_ms is counted from the retune
+                waiting = true;
+                group_ready[start.group] = false;
+                continue;
             }
+        }
 
-            // Pushing Data
-            // handle partial packet (b/c overflow occured)
-            if(usrp_tuners[tuner_id].buffer_size < usrp_tuners[tuner_id].buffer_capacity){
-                usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_size);
+        if (!start.ready) {
+            bool locked = false;
+            if (!start.no_sensor) {
+                try {
+                    locked = usrp_device_ptr->get_rx_sensor("lo_locked", frontend_tuner_status[tuner_id].tuner_number).to_bool();
+                } catch (...) {
+                    LOG_DEBUG(USRP_UHD_i,"serviceFunctionEnable|tuner_id=" << tuner_id << " could not read lo_locked sensor, waiting "
+                                        << settings.lo_lock_timeout_ms << " ms before starting");
+                    start.no_sensor = true;
+                }
+                start.polls++;
             }
-            // Only push on active ports
-            if(dataShort_out->isActive()){
-                dataShort_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
+
+            const long waited_us = (boost::get_system_time() - start.requested).total_microseconds();
+            if (!locked && waited_us < long(settings.lo_lock_timeout_ms*1e3)) {
+                waiting = true;
+                if (start.group != 0)
+                    group_ready[start.group] = false;
+                continue;
             }
-            // Don't check isActive because could be relying on attach override rather than a connection
-            // It doesn't actually do anything if the tuner/stream isn't configured for sdds already anyway
-            dataSDDS_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
-            // restore buffer size if necessary
-            if(usrp_tuners[tuner_id].buffer_size < usrp_tuners[tuner_id].buffer_capacity){
-                usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_capacity);
+            if (!locked && !start.no_sensor) {
+                LOG_WARN(USRP_UHD_i,"serviceFunctionEnable|tuner_id=" << tuner_id << " LO did not lock within "
+                                   << settings.lo_lock_timeout_ms << " ms, starting stream anyway");
             }
-            usrp_tuners[tuner_id].buffer_size = 0;
-            
-        } else if(num_samps != 0){ // either received data or overflow occurred, either way data is available
-            rx_data = true;
+            LOG_DEBUG(USRP_UHD_i,"serviceFunctionEnable|tuner_id=" << tuner_id << " ready to start stream after " << waited_us
+                                << " us and " << start.polls << " lo_locked reads");
+            start.ready = true;
+        }
+
+        if (start.group == 0) {
+            const double start_delay = std::min(std::max(settings.start_delay_ms*1e-3, 0.0), max_start_delay_us*1e-6);
+            if (start_delay > 0.0)
+                usrpStartStream(tuner_id, false, usrp_device_ptr->get_time_now() + uhd::time_spec_t(start_delay));
+            else
+                usrpStartStream(tuner_id, true, uhd::time_spec_t());
+        } else if (group_ready.find(start.group) == group_ready.end()) {
+            group_ready[start.group] = true;
         }
     }
 
-    if(rx_data)
+    // start each group whose tuners are all ready at a common device time
+    for (std::map<size_t, bool>::iterator group = group_ready.begin(); group != group_ready.end(); group++) {
+        if (!group->second || group->first == open_group) {
+            waiting = true;
+            continue;
+        }
+        // not before the group's retunes have settled, so no samps from the old freqs carry the new SRI
+        const double start_delay = std::min(std::max(settings.start_delay_ms*1e-3, hop_lead_us*1e-6), max_start_delay_us*1e-6);
+        uhd::time_spec_t start_time = usrp_device_ptr->get_time_now() + uhd::time_spec_t(start_delay);
+        const uhd::time_spec_t settled = group_command_time[group->first] + uhd::time_spec_t(batch_settle_us/1e6);
+        if (start_time < settled)
+            start_time = settled;
+        for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+            scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+            const usrpStartStruct &start = usrp_tuners[tuner_id].start;
+            if (start.state == usrpStartStruct::WAIT_LOCK && start.ready && start.group == group->first)
+                usrpStartStream(tuner_id, false, start_time);
+        }
+        LOG_DEBUG(USRP_UHD_i,"serviceFunctionEnable|started group " << group->first << " at device time " << start_time.get_real_secs());
+    }
+
+    if (waiting) {
+        if (settings.lo_lock_poll_us > 0)
+            usleep(settings.lo_lock_poll_us);
         return NORMAL;
+    }
+    return NOOP;
+}
+
+/** METRICS THREAD **/
+int USRP_UHD_i::serviceFunctionMetrics(){
+    // dump requested by an overflow in the data path
+    if (eventTrace::dumpRequested())
+        dumpEventTrace();
+
+    std::string dump_path;
+    std::vector<hot_path_metric_struct> metrics;
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        if (hot_path_metrics_settings.update_period_ms <= 0.0)
+            return NOOP;
+        boost::system_time now = boost::get_system_time();
+        if ((now - last_metrics_update).total_microseconds() < long(hot_path_metrics_settings.update_period_ms*1e3))
+            return NOOP;
+        last_metrics_update = now;
+
+        updateHotPathMetrics();
+        updatePushQueueMetrics();
+        updateLatencyHistograms();
+        dump_path = hot_path_metrics_settings.dump_path;
+        if (!dump_path.empty())
+            metrics = hot_path_metrics;
+    } // end scope for prop_lock
+
+    if (!dump_path.empty())
+        dumpHotPathMetrics(dump_path, metrics);
+
     return NOOP;
 }
 
@@ -307,6 +550,14 @@ int USRP_UHD_i::serviceFunctionTransmit(){
 
 }
 
+/** PUSH THREAD **/
+// waits up to 10 ms for the next call queued on dataShort_out, so it is started with no NOOP delay
+int USRP_UHD_i::serviceFunctionShortPush(){
+    if (short_push_queue->service(10))
+        return NORMAL;
+    return NOOP;
+}
+
 void USRP_UHD_i::start() throw (CORBA::SystemException, CF::Resource::StartError) {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
     USRP_UHD_base::start();
@@ -316,6 +567,21 @@ void USRP_UHD_i::start() throw (CORBA::SystemException, CF::Resource::StartError
     // Create threads
     try {
 
+        // push thread first, so the receive threads never push directly once started
+        rx_push_queue_struct push_settings;
+        {
+            exclusive_lock lock(prop_lock);
+            push_settings = rx_push_queue;
+        }
+        configurePushQueues(push_settings);
+        {
+            exclusive_lock lock(push_service_thread_lock);
+            if (push_settings.enable && short_push_thread == NULL) {
+                short_push_queue->setAsync(true);
+                short_push_thread = new MultiProcessThread<USRP_UHD_i> (this, &USRP_UHD_i::serviceFunctionShortPush, 0.0);
+                short_push_thread->start();
+            }
+        }
         {
             exclusive_lock lock(receive_service_thread_lock);
             if (receive_service_thread == NULL) {
@@ -325,6 +591,10 @@ void USRP_UHD_i::start() throw (CORBA::SystemException, CF::Resource::StartError
                 receive_service_thread->start();
             }
         }
+        for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+            if (usrp_tuners[tuner_id].low_latency.enabled)
+                startLowLatencyThread(tuner_id, usrp_tuners[tuner_id].low_latency.cpu_core);
+        }
         {
             exclusive_lock lock(transmit_service_thread_lock);
             if (transmit_service_thread == NULL) {
@@ -334,6 +604,28 @@ void USRP_UHD_i::start() throw (CORBA::SystemException, CF::Resource::StartError
                 transmit_service_thread->start();
             }
         }
+        {
+            exclusive_lock lock(agc_service_thread_lock);
+            if (agc_service_thread == NULL) {
+                agc_service_thread = new MultiProcessThread<USRP_UHD_i> (this, &USRP_UHD_i::serviceFunctionAgc, 0.01);
+                agc_service_thread->start();
+            }
+        }
+        {
+            exclusive_lock lock(enable_service_thread_lock);
+            if (enable_service_thread == NULL) {
+                enable_service_thread = new MultiProcessThread<USRP_UHD_i> (this, &USRP_UHD_i::serviceFunctionEnable, 0.001);
+                enable_service_thread->start();
+            }
+        }
+        {
+            exclusive_lock lock(metrics_service_thread_lock);
+            if (metrics_service_thread == NULL) {
+                last_metrics_update = boost::get_system_time();
+                metrics_service_thread = new MultiProcessThread<USRP_UHD_i> (this, &USRP_UHD_i::serviceFunctionMetrics, 0.05);
+                metrics_service_thread->start();
+            }
+        }
 
     } catch (...) {
         stop();
@@ -363,6 +655,15 @@ void USRP_UHD_i::stop() throw (CORBA::SystemException, CF::Resource::StopError)
             delete receive_service_thread;
             receive_service_thread = 0;
         }
+        for (size_t tuner_id = 0; tuner_id < low_latency_service_threads.size(); tuner_id++) {
+            if (low_latency_service_threads[tuner_id] == 0)
+                continue;
+            if (!low_latency_service_threads[tuner_id]->release(2)) {
+                throw CF::Resource::StopError(CF::CF_NOTSET,"Low latency receive processing thread did not die");
+            }
+            delete low_latency_service_threads[tuner_id];
+            low_latency_service_threads[tuner_id] = 0;
+        }
     }
 
     {
@@ -379,11 +680,62 @@ void USRP_UHD_i::stop() throw (CORBA::SystemException, CF::Resource::StopError)
         }
     }
 
+    {
+        exclusive_lock lock(agc_service_thread_lock);
+        // release the child thread (if it exists)
+        if (agc_service_thread != 0) {
+            if (!agc_service_thread->release(2)) {
+                throw CF::Resource::StopError(CF::CF_NOTSET,"AGC processing thread did not die");
+            }
+            delete agc_service_thread;
+            agc_service_thread = 0;
+        }
+    }
+
+    {
+        exclusive_lock lock(enable_service_thread_lock);
+        // release the child thread (if it exists)
+        if (enable_service_thread != 0) {
+            if (!enable_service_thread->release(2)) {
+                throw CF::Resource::StopError(CF::CF_NOTSET,"Enable processing thread did not die");
+            }
+            delete enable_service_thread;
+            enable_service_thread = 0;
+        }
+    }
+
+    {
+        exclusive_lock lock(metrics_service_thread_lock);
+        // release the child thread (if it exists)
+        if (metrics_service_thread != 0) {
+            if (!metrics_service_thread->release(2)) {
+                throw CF::Resource::StopError(CF::CF_NOTSET,"Metrics processing thread did not die");
+            }
+            delete metrics_service_thread;
+            metrics_service_thread = 0;
+        }
+    }
+
     // iterate through tuners to disable any enabled tuners
     for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
         deviceDisable(tuner_id);
     }
 
+    {
+        exclusive_lock lock(push_service_thread_lock);
+        // push what is still queued, including the samps pushed by deviceDisable, then push directly until the next start
+        if (short_push_thread != 0) {
+            if (!short_push_queue->drain(1000))
+                LOG_WARN(USRP_UHD_i,"stop|dataShort_out push queue did not empty within 1 s, dropping the remaining blocks");
+            if (!short_push_thread->release(2)) {
+                throw CF::Resource::StopError(CF::CF_NOTSET,"Push thread did not die");
+            }
+            delete short_push_thread;
+            short_push_thread = 0;
+        }
+        short_push_queue->setAsync(false);
+    }
+
     /*if (started()) {
         USRP_UHD_base::stop();
     }*/
@@ -398,6 +750,10 @@ void USRP_UHD_i::construct() {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
     receive_service_thread = NULL;
     transmit_service_thread = NULL;
+    agc_service_thread = NULL;
+    enable_service_thread = NULL;
+    metrics_service_thread = NULL;
+    short_push_thread = NULL;
 
     // Set up custom SDDS port
     dataSDDS_out = new OutSDDSPort_customized<short>("dataSDDS_out");
@@ -405,6 +761,9 @@ void USRP_UHD_i::construct() {
     delete USRP_UHD_base::dataSDDS_out;
     USRP_UHD_base::dataSDDS_out = USRP_UHD_i::dataSDDS_out;
 
+    // dataSDDS_out needs no queue, since its SddsProcessors already queue the data for their own threads
+    short_push_queue = new asyncPushQueue<bulkio::OutShortPort, short>(dataShort_out);
+
     // set some default values that should get overwritten by correct values
     device_rx_gain_global = 0.0;
     device_tx_gain_global = 0.0;
@@ -454,6 +813,7 @@ void USRP_UHD_i::construct() {
     rf_port_info.antenna = "CAL"; // We set CAL here since it's known
     rf_port_info.rfinfo_pkt.rf_flow_id = "USRP_RFB:CAL_TX";
     rf_port_info_map.insert(str2rfinfo_pair_t("CAL_TX2",rf_port_info));
+    indexRFInfoPorts();
 }
 
 void USRP_UHD_i::constructor() {
@@ -465,19 +825,34 @@ void USRP_UHD_i::constructor() {
     addPropertyListener(update_available_devices, this, &USRP_UHD_i::updateAvailableDevicesChanged);
     addPropertyListener(device_reference_source_global, this, &USRP_UHD_i::deviceReferenceSourceChanged);
     addPropertyListener(configure_tuner_antenna, this, &USRP_UHD_i::antennaChanged);
+    addPropertyListener(rx_agc, this, &USRP_UHD_i::rxAgcChanged);
+    addPropertyListener(rx_push_queue, this, &USRP_UHD_i::rxPushQueueChanged);
+    addPropertyListener(trigger_rx_autogain, this, &USRP_UHD_i::triggerRxAutogainChanged);
+    addPropertyListener(signal_stats_period_ms, this, &USRP_UHD_i::signalStatsPeriodChanged);
+    addPropertyListener(reset_latency_histograms, this, &USRP_UHD_i::resetLatencyHistogramsChanged);
+    addPropertyListener(max_latency_ms, this, &USRP_UHD_i::maxLatencyChanged);
+    addPropertyListener(tuner_max_latency, this, &USRP_UHD_i::tunerMaxLatencyChanged);
+    addPropertyListener(low_latency_allocations, this, &USRP_UHD_i::lowLatencyAllocationsChanged);
+    addPropertyListener(trace_settings, this, &USRP_UHD_i::traceSettingsChanged);
+    addPropertyListener(trigger_trace_dump, this, &USRP_UHD_i::triggerTraceDumpChanged);
+    addPropertyListener(sim_device, this, &USRP_UHD_i::simDeviceChanged);
+    addPropertyListener(hop_schedule, this, &USRP_UHD_i::hopScheduleChanged);
+    addPropertyListener(spectrum_scan, this, &USRP_UHD_i::spectrumScanChanged);
+    addPropertyListener(connectionTable, this, &USRP_UHD_i::connectionTableChanged);
+
+    traceSettingsChanged(trace_settings, trace_settings);
 
     try{
-        initUsrp();
+        boost::mutex::scoped_lock sync_guard(time_sync_lock);
+        { // scope for prop_lock
+            exclusive_lock lock(prop_lock);
+            initUsrpWithRetry();
+        } // end scope for prop_lock
+        syncCurrentDeviceTime();
     }catch(...){
-        LOG_WARN(USRP_UHD_i,"CAUGHT EXCEPTION WHEN INITIALIZING USRP. WAITING 1 SECOND AND TRYING AGAIN");
-        sleep(1);
-        try {
-            initUsrp();
-        } catch(...) {
-            update_available_devices = false;
-            updateAvailableDevices();
-            LOG_INFO(USRP_UHD_i,"Could not init USRP with current target_device configuration. Try configuring with one of the available_devices entries.");
-        }
+        update_available_devices = false;
+        updateAvailableDevices();
+        LOG_INFO(USRP_UHD_i,"Could not init USRP with current target_device configuration. Try configuring with one of the available_devices entries.");
     }
 
     if(update_available_devices){
@@ -487,7 +862,7 @@ void USRP_UHD_i::constructor() {
     updateDeviceRxGain(device_rx_gain_global);
     updateDeviceTxGain(device_tx_gain_global);
     updateGroupId(device_group_id_global);
-    updateDeviceReferenceSource(device_reference_source_global);
+    // initUsrp has already applied device_reference_source_global, and syncCurrentDeviceTime the PPS sync
 
     /** As of the REDHAWK 1.8.3 release, device are not started automatically by the node. Therefore
      *  the device must start itself. */
@@ -498,6 +873,156 @@ void USRP_UHD_i::constructor() {
 /*************************************************************
 Functions supporting tuning allocation
 *************************************************************/
+CORBA::Boolean USRP_UHD_i::allocateCapacity(const CF::Properties& capacities)
+        throw (CF::Device::InvalidState, CF::Device::InvalidCapacity, CF::Device::InsufficientCapacity, CORBA::SystemException) {
+    LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
+
+    // not while device time is being set (deviceReferenceSourceChanged)
+    boost::mutex::scoped_lock sync_guard(time_sync_lock);
+
+    // a batch is two or more RX tuner allocations with device control in one call, all others are allocated as usual
+    std::vector<frontend::frontend_tuner_allocation_struct> requests;
+    std::vector<frontend::frontend_tuner_allocation_struct> listeners;
+    for (unsigned long i = 0; i < capacities.length(); i++) {
+        frontend::frontend_tuner_allocation_struct request;
+        if (std::string(capacities[i].id) == "FRONTEND::tuner_allocation" && (capacities[i].value >>= request) &&
+                request.tuner_type == "RX_DIGITIZER") {
+            if (request.device_control)
+                requests.push_back(request);
+            else
+                listeners.push_back(request);
+        }
+    }
+    if (requests.size() < 2 || usrp_device_ptr.get() == NULL)
+        return USRP_UHD_base::allocateCapacity(capacities);
+
+    boost::mutex::scoped_lock batch_guard(tune_batch_lock);
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        if (!validateTuneBatch(requests, listeners))
+            return false;
+        // each tuner is configured in turn before its retune is sent, so allow time for all of them
+        const long lead_us = batch_lead_us + batch_tuner_lead_us*long(requests.size());
+        tune_batch.active = true;
+        tune_batch.coherent = true;
+        tune_batch.thread = boost::this_thread::get_id();
+        tune_batch.command_time = usrp_device_ptr->get_time_now() + uhd::time_spec_t(lead_us/1e6);
+        tune_batch.group++;
+        tune_batch.tuners.clear();
+        LOG_DEBUG(USRP_UHD_i,"allocateCapacity|batch of " << requests.size() << " RX tuner allocations, start group " << tune_batch.group
+                            << ", retunes at device time " << tune_batch.command_time.get_real_secs());
+    } // end scope for prop_lock
+
+    CORBA::Boolean allocated = false;
+    try {
+        allocated = USRP_UHD_base::allocateCapacity(capacities);
+    } catch (...) {
+        endTuneBatch();
+        throw;
+    }
+    // a late retune is no reason to fail allocations that are otherwise fine, so the batch is kept
+    if (!endTuneBatch() && allocated) {
+        LOG_WARN(USRP_UHD_i,"allocateCapacity|batch of " << requests.size() << " RX tuner allocations was allocated, but not all of "
+                           << "its tuners were retuned at the same device time");
+    }
+    return allocated;
+}
+
+/* ends the batch of the calling thread, refreshing the channel info of its tuners
+ * returns false if a retune of the batch was sent too late to take effect at command_time
+ */
+bool USRP_UHD_i::endTuneBatch(){
+    exclusive_lock lock(prop_lock);
+    tune_batch.active = false;
+    tune_batch.assignment.clear();
+    for (size_t i = 0; i < tune_batch.tuners.size(); i++)
+        refreshChannelInfo(tune_batch.tuners[i]);
+    return tune_batch.coherent;
+}
+
+/* assigns requests from request on to distinct channels, where fits[i][c] is true if request i fits channel c
+ * and channel c is taken if used[c]. returns false if there is no assignment
+ */
+static bool assignRequests(const std::vector<std::vector<bool> >& fits, size_t request, std::vector<bool>& used, std::vector<size_t>& assigned) {
+    if (request == fits.size())
+        return true;
+    for (size_t c = 0; c < used.size(); c++) {
+        if (!fits[request][c] || used[c])
+            continue;
+        used[c] = true;
+        assigned[request] = c;
+        if (assignRequests(fits, request+1, used, assigned))
+            return true;
+        used[c] = false;
+    }
+    return false;
+}
+
+/* acquire prop_lock prior to calling this function
+ * checks every request of a batch against the RX channels before any tuner is configured, so a batch that
+ * cannot be allocated fails without touching the hardware. each request is assigned its own unallocated RX
+ * tuner, recorded in tune_batch.assignment for deviceSetTuning. returns false if there is no such assignment,
+ * or a listener fits neither an allocated RX tuner nor a request of the batch
+ */
+bool USRP_UHD_i::validateTuneBatch(const std::vector<frontend::frontend_tuner_allocation_struct>& requests,
+                                   const std::vector<frontend::frontend_tuner_allocation_struct>& listeners){
+    std::vector<size_t> available;
+    for (size_t tuner_id = 0; tuner_id < frontend_tuner_status.size() && tuner_id < device_channels.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type == "RX_DIGITIZER" && getControlAllocationId(tuner_id).empty())
+            available.push_back(tuner_id);
+    }
+    if (available.size() < requests.size()) {
+        LOG_INFO(USRP_UHD_i,"validateTuneBatch|batch of " << requests.size() << " RX allocations, but only " << available.size() << " RX tuners available");
+        return false;
+    }
+
+    // listeners attach to a tuner that is already allocated, or to one allocated by the batch
+    for (size_t i = 0; i < listeners.size(); i++) {
+        frontend::frontend_tuner_allocation_struct listener = listeners[i];
+        bool fits = false;
+        for (size_t tuner_id = 0; tuner_id < frontend_tuner_status.size() && !fits; tuner_id++) {
+            fits = frontend_tuner_status[tuner_id].tuner_type == "RX_DIGITIZER" && !getControlAllocationId(tuner_id).empty() &&
+                    listenerRequestValidation(listener, tuner_id);
+        }
+        for (size_t j = 0; j < requests.size() && !fits; j++) {
+            fits = listener.center_frequency-listener.bandwidth/2 >= requests[j].center_frequency-requests[j].bandwidth/2 &&
+                    listener.center_frequency+listener.bandwidth/2 <= requests[j].center_frequency+requests[j].bandwidth/2;
+        }
+        if (!fits) {
+            LOG_INFO(USRP_UHD_i,"validateTuneBatch|listener allocation_id=" << listener.allocation_id << " (center_frequency="
+                    << listener.center_frequency << " bandwidth=" << listener.bandwidth << ") matches no allocated RX tuner");
+            return false;
+        }
+    }
+
+    std::vector<std::vector<bool> > fits(requests.size(), std::vector<bool>(available.size(), false));
+    for (size_t i = 0; i < requests.size(); i++) {
+        bool any_fit = false;
+        for (size_t c = 0; c < available.size(); c++) {
+            const usrp_channel_struct &channel = device_channels[available[c]];
+            fits[i][c] = requests[i].center_frequency >= channel.freq_min && requests[i].center_frequency <= channel.freq_max &&
+                    requests[i].sample_rate <= channel.rate_max && requests[i].bandwidth <= channel.bandwidth_max;
+            any_fit = any_fit || fits[i][c];
+        }
+        if (!any_fit) {
+            LOG_INFO(USRP_UHD_i,"validateTuneBatch|allocation_id=" << requests[i].allocation_id << " (center_frequency="
+                    << requests[i].center_frequency << " sample_rate=" << requests[i].sample_rate << " bandwidth="
+                    << requests[i].bandwidth << ") fits no unallocated RX tuner");
+            return false;
+        }
+    }
+    std::vector<bool> used(available.size(), false);
+    std::vector<size_t> assigned(requests.size(), 0);
+    if (!assignRequests(fits, 0, used, assigned)) {
+        LOG_INFO(USRP_UHD_i,"validateTuneBatch|the " << requests.size() << " RX allocations of the batch cannot each be given their own unallocated RX tuner");
+        return false;
+    }
+    tune_batch.assignment.clear();
+    for (size_t i = 0; i < requests.size(); i++)
+        tune_batch.assignment[requests[i].allocation_id] = available[assigned[i]];
+    return true;
+}
+
 void USRP_UHD_i::deviceEnable(frontend_tuner_status_struct_struct &fts, size_t tuner_id){
     /************************************************************
     modify fts, which corresponds to this->frontend_tuner_status[tuner_id]
@@ -505,11 +1030,26 @@ void USRP_UHD_i::deviceEnable(frontend_tuner_status_struct_struct &fts, size_t t
     ************************************************************/
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " tuner_id=" << tuner_id);
 
+    // tuners of a batch start together, after their retunes
+    size_t group = 0;
+    uhd::time_spec_t command_time;
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        if (tune_batch.active && tune_batch.thread == boost::this_thread::get_id()) {
+            group = tune_batch.group;
+            command_time = tune_batch.command_time;
+        }
+    } // end scope for prop_lock
+
     // Start Streaming Now
     scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
     if (rx_autogain_on_tune)
-        trigger_rx_autogain = true;
+        usrp_tuners[tuner_id].agc.one_shot = true;
     usrpEnable(tuner_id); // modifies fts.enabled appropriately
+    if (usrp_tuners[tuner_id].start.state == usrpStartStruct::WAIT_LOCK) {
+        usrp_tuners[tuner_id].start.group = group;
+        usrp_tuners[tuner_id].start.command_time = command_time;
+    }
 }
 void USRP_UHD_i::deviceDisable(frontend_tuner_status_struct_struct &fts, size_t tuner_id){
     /************************************************************
@@ -547,12 +1087,29 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
     double opt_sr = 0.0;
     double opt_bw = 0.0;
 
-    str2rfinfo_map_t::iterator it=rf_port_info_map.begin();
-    for (; it!=rf_port_info_map.end(); it++) {
-        if (it->second.tuner_idx == tuner_id && it->second.antenna == fts.antenna) {
-            break;
-        }
-    }
+    // low latency params
+    bool low_latency = false;
+    low_latency_allocation_struct low_latency_settings;
+
+    // frequency hop and scan params
+    std::vector<hop_struct> hops;
+    bool scan = false;
+    spectrum_scan_struct scan_settings;
+
+    // AGC params
+    rx_agc_struct agc_settings;
+    rx_resampler_struct resampler_settings;
+    shm_output_struct shm_settings;
+
+    // batch params
+    bool batched = false;
+    uhd::time_spec_t command_time;
+
+    // signal statistics params
+    double signal_stats_period = 0.0;
+    unsigned short clip_level = 32767;
+
+    str2rfinfo_map_t::iterator it=findRFInfoPort(tuner_id, fts.antenna);
     if (it==rf_port_info_map.end()) {
         LOG_ERROR(USRP_UHD_i,"deviceSetTuning|tuner_id="<<tuner_id<<" antenna="<<fts.antenna<<". No matching RFInfo port found!! Failed allocation.");
         throw CF::Device::InvalidState("No matching RFInfo port found! Device must be in an invalid state.");
@@ -563,6 +1120,16 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
         { // scope for prop_lock
             exclusive_lock lock(prop_lock);
 
+            // a batched request only takes the tuner validateTuneBatch assigned it, so the whole batch fits
+            batched = tune_batch.active && tune_batch.thread == boost::this_thread::get_id();
+            if (batched) {
+                std::map<std::string, size_t>::const_iterator assigned = tune_batch.assignment.find(request.allocation_id);
+                if (assigned != tune_batch.assignment.end() && assigned->second != tuner_id) {
+                    LOG_DEBUG(USRP_UHD_i,"deviceSetTuning|tuner_id=" << tuner_id << " is not the tuner of batched allocation_id=" << request.allocation_id);
+                    return false;
+                }
+            }
+
             // check request against USRP specs and analog input
             const bool complex = true; // USRP operates using complex data
             try {
@@ -604,6 +1171,21 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
                 LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "sdds_network_settings does NOT have ip address for tuner_id=" << tuner_id);
             }
 
+            // cache low latency settings for this allocation, if any
+            low_latency = getLowLatencySettings(request.allocation_id, low_latency_settings);
+            getHopSchedule(request.allocation_id, tuner_id, hops);
+            scan = getScanSettings(request.allocation_id, tuner_id, scan_settings);
+            agc_settings = rx_agc;
+            resampler_settings = rx_resampler;
+            shm_settings = shm_output;
+            signal_stats_period = std::max(signal_stats_period_ms, 0.0)/1000.0;
+            if (batched) {
+                command_time = tune_batch.command_time;
+                tune_batch.tuners.push_back(tuner_id);
+            }
+            if (device_rx_mode == "8bit")
+                clip_level = 127;
+
         } // end scope for prop_lock
 
         scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
@@ -612,20 +1194,84 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
         // since request is always in RF, and USRP may be operating in IF
         // adjust requested center frequency according to rx rfinfo packet
 
-        // configure hw
-        usrp_device_ptr->set_rx_freq(request.center_frequency-if_offset, fts.tuner_number);
-        usrp_device_ptr->set_rx_bandwidth(opt_bw, fts.tuner_number);
-        usrp_device_ptr->set_rx_rate(opt_sr, fts.tuner_number);
-
+        // skip the hw calls if the channel is still configured from a previous allocation
+        // the rate, freq and bandwidth are read back regardless, since another channel's rate can change the master
+        // clock rate, channels that share an LO (e.g. B210) are retuned together, and some frontends set their analog
+        // filter from the master clock rate or from the other channel
+        usrpTuneCacheStruct &cache = usrp_tuners[tuner_id].tune_cache;
+        const double freq = request.center_frequency-if_offset;
+        if (cache.matches(freq, opt_bw, opt_sr, fts.antenna) && usrp_device_ptr->get_rx_rate(fts.tuner_number) == cache.actual_rate &&
+                usrp_device_ptr->get_rx_freq(fts.tuner_number) == cache.actual_freq &&
+                usrp_device_ptr->get_rx_bandwidth(fts.tuner_number) == cache.actual_bandwidth) {
+            LOG_DEBUG(USRP_UHD_i,"deviceSetTuning|tuner_id=" << tuner_id << " already tuned, lo_freq=" << cache.lo_freq << " dsp_freq=" << cache.dsp_freq);
+        } else {
+            // configure hw, retuning the tuners of a batch at the same time
+            uhd::tune_result_t tune_result;
+            if (batched) {
+                // a timed command that arrives after command_time takes effect at once
+                const uhd::time_spec_t now = usrp_device_ptr->get_time_now();
+                if (now + uhd::time_spec_t(hop_lead_us/1e6) > command_time) {
+                    LOG_WARN(USRP_UHD_i,"deviceSetTuning|tuner_id=" << tuner_id << " batch retune sent at device time " << now.get_real_secs()
+                                       << ", too late for " << command_time.get_real_secs() << ", so it is retuned at once");
+                    tune_batch.coherent = false; // only the batch's thread reads or writes it, see usrpTuneBatchStruct
+                    tune_result = usrp_device_ptr->set_rx_freq(freq, fts.tuner_number);
+                } else
+                    tune_result = usrp_device_ptr->set_rx_freq_timed(freq, command_time, fts.tuner_number);
+            } else
+                tune_result = usrp_device_ptr->set_rx_freq(freq, fts.tuner_number);
+            usrp_device_ptr->set_rx_bandwidth(opt_bw, fts.tuner_number);
+            usrp_device_ptr->set_rx_rate(opt_sr, fts.tuner_number);
+
+            cache.valid = true;
+            cache.freq = freq;
+            cache.bandwidth = opt_bw;
+            cache.rate = opt_sr;
+            cache.antenna = fts.antenna;
+            cache.actual_freq = usrp_device_ptr->get_rx_freq(fts.tuner_number);
+            cache.actual_bandwidth = usrp_device_ptr->get_rx_bandwidth(fts.tuner_number);
+            cache.actual_rate = usrp_device_ptr->get_rx_rate(fts.tuner_number);
+            cache.lo_freq = tune_result.actual_rf_freq;
+            cache.dsp_freq = tune_result.actual_dsp_freq;
+        }
 
         // update frontend_tuner_status with actual hw values
-        fts.center_frequency = usrp_device_ptr->get_rx_freq(fts.tuner_number)+if_offset;
-        fts.bandwidth = usrp_device_ptr->get_rx_bandwidth(fts.tuner_number);
-        fts.sample_rate = usrp_device_ptr->get_rx_rate(fts.tuner_number);
+        fts.center_frequency = cache.actual_freq+if_offset;
+        fts.bandwidth = cache.actual_bandwidth;
+        fts.sample_rate = cache.actual_rate;
 
         // bandwidth will be reported as the minimum of analog filter bandwidth and the sample rate.
         fts.bandwidth =std::min(fts.sample_rate,fts.bandwidth);
 
+        // resample on the host to the requested rate and bandwidth, if the hw could only do more
+        usrpResampleStruct &rs = usrp_tuners[tuner_id].resample;
+        rs = usrpResampleStruct();
+        if (resampler_settings.enable && fts.sample_rate > 0.0) {
+            const double in_rate = fts.sample_rate;
+            size_t up = 1;
+            size_t down = 1;
+            double cutoff = 0.5; // fraction of in_rate
+            if (frontend::floatingPointCompare(request.sample_rate,0) > 0 && frontend::floatingPointCompare(in_rate,request.sample_rate) > 0) {
+                polyphaseResampler::ratio(in_rate, request.sample_rate, resampler_settings.max_phases, up, down);
+                // pass 80% of the output rate, or the requested bandwidth if more
+                const double out_rate = in_rate*up/down;
+                cutoff = std::min(std::max(0.4*out_rate, 0.5*request.bandwidth), 0.5*out_rate)/in_rate;
+            }
+            const bool filter_bw = resampler_settings.filter_bandwidth && frontend::floatingPointCompare(request.bandwidth,0) > 0 &&
+                    frontend::floatingPointCompare(fts.bandwidth,request.bandwidth) > 0;
+            if (filter_bw)
+                cutoff = std::min(cutoff, 0.5*request.bandwidth/in_rate);
+            if (up != down || filter_bw) {
+                rs.active = true;
+                rs.in_rate = in_rate;
+                rs.out_rate = in_rate*up/down;
+                rs.filter.configure(up, down, cutoff, resampler_settings.taps_per_phase);
+                fts.sample_rate = rs.out_rate;
+                fts.bandwidth = std::min(fts.bandwidth, 2.0*cutoff*in_rate);
+                LOG_DEBUG(USRP_UHD_i,"deviceSetTuning|tuner_id=" << tuner_id << " resampling by " << up << "/" << down
+                                     << " from " << in_rate << " to " << rs.out_rate << ", cutoff " << cutoff*in_rate);
+            }
+        }
+
         // update tolerance
         fts.bandwidth_tolerance = request.bandwidth_tolerance;
         fts.sample_rate_tolerance = request.sample_rate_tolerance;
@@ -672,6 +1318,15 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
         }
 
         usrp_tuners[tuner_id].update_sri = true;
+        setShmOutput(tuner_id, shm_settings);
+        setLowLatencyMode(tuner_id, low_latency, low_latency_settings);
+        setHopSchedule(tuner_id, hops);
+        setScanMode(tuner_id, scan, scan_settings);
+        usrp_tuners[tuner_id].agc.continuous = agc_settings.continuous;
+        usrp_tuners[tuner_id].agc.update_period = agc_settings.update_period_ms/1000.0;
+        usrp_tuners[tuner_id].signal_stats.period = signal_stats_period;
+        usrp_tuners[tuner_id].signal_stats.clip_level = clip_level;
+        usrp_tuners[tuner_id].signal_stats.reset();
 
     } else if (fts.tuner_type == "TX") {
 
@@ -724,8 +1379,15 @@ bool USRP_UHD_i::deviceSetTuning(const frontend::frontend_tuner_allocation_struc
         throw FRONTEND::BadParameterException("deviceSetTuning|Invalid tuner type. Must be RX_DIGITIZER or TX");
     }
 
+    if (low_latency)
+        startLowLatencyThread(tuner_id, low_latency_settings.cpu_core);
+
+    // the channel info of a batch is refreshed once it is complete (allocateCapacity)
+    if (batched)
+        return true;
+
     exclusive_lock lock(prop_lock);
-    updateDeviceInfo();
+    refreshChannelInfo(tuner_id);
 
     return true;
 }
@@ -738,6 +1400,22 @@ bool USRP_UHD_i::deviceDeleteTuning(frontend_tuner_status_struct_struct &fts, si
     //if (tuner_id >= usrp_tuners.size())
     //    throw FRONTEND::BadParameterException("deviceDeleteTuning: INVALID TUNER ID");
 
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        for (size_t i = 0; i < low_latency_metrics.size(); i++) {
+            if (low_latency_metrics[i].tuner_index == tuner_id) {
+                low_latency_metrics.erase(low_latency_metrics.begin()+i);
+                break;
+            }
+        }
+        for (size_t i = 0; i < tuner_signal_stats.size(); i++) {
+            if (tuner_signal_stats[i].tuner_index == tuner_id) {
+                tuner_signal_stats.erase(tuner_signal_stats.begin()+i);
+                break;
+            }
+        }
+    } // end scope for prop_lock
+
     scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
 
     // get stream id (creates one if not already created for this tuner)
@@ -747,27 +1425,28 @@ bool USRP_UHD_i::deviceDeleteTuning(frontend_tuner_status_struct_struct &fts, si
     sri.mode = 1; // complex
     //printSRI(&sri,"USRP_UHD_i::deviceDeleteTuning SRI"); // DEBUG
     updateSriTimes(&sri, usrp_tuners[tuner_id].time_up.twsec, usrp_tuners[tuner_id].time_down.twsec, frontend::J1970);
-    dataShort_out->pushSRI(sri);
+    short_push_queue->pushSRI(sri);
     dataSDDS_out->pushSRI(sri);
     usrp_tuners[tuner_id].update_sri = false;
+    usrp_tuners[tuner_id].shm.sri_changed = true;
 
-    usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_size);
+    resampleRxBuffer(tuner_id);
+    std::vector<short> &push_buffer = rxPushBuffer(tuner_id);
     LOG_DEBUG(USRP_UHD_i,"deviceDeleteTuning|pushing EOS with remaining samples."
                                          << "  buffer_size=" << usrp_tuners[tuner_id].buffer_size
-                                         << "  buffer_capacity=" << usrp_tuners[tuner_id].buffer_capacity
-                                         << "  output_buffer.size()=" << usrp_tuners[tuner_id].output_buffer.size() );
+                                         << "  buffer_capacity=" << usrp_tuners[tuner_id].buffer_capacity);
     // Only push on active ports
     if(dataShort_out->isActive()){
-        dataShort_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, true, stream_id);
+        short_push_queue->pushPacket(push_buffer, usrp_tuners[tuner_id].output_buffer_time, true, stream_id);
     }
 
     // Don't check isActive because could be relying on attach override rather than a connection
     // It doesn't actually do anything if the tuner/stream isn't configured for sdds already anyway
-    dataSDDS_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, true, stream_id);
+    dataSDDS_out->pushPacket(push_buffer, usrp_tuners[tuner_id].output_buffer_time, true, stream_id);
     //dataSDDS_out->removeStream(stream_id); // Don't do this b/c it'll prevent that data/sri just pushed from being sent.
+    publishRxBuffer(tuner_id, true, stream_id);
 
     usrp_tuners[tuner_id].buffer_size = 0;
-    usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_capacity);
 
     usrp_tuners[tuner_id].reset();
     fts.center_frequency = 0.0;
@@ -922,17 +1601,15 @@ void USRP_UHD_i::targetDeviceChanged(const target_device_struct& old_value, cons
         LOG_DEBUG(USRP_UHD_i,"targetDeviceChanged|device has not been started, continue with initialization");
     }
 
-    { // scope for prop_lock
-        exclusive_lock lock(prop_lock);
+    { // scope for time_sync_lock, which holds off allocations until device time is set
+        boost::mutex::scoped_lock sync_guard(time_sync_lock);
+        { // scope for prop_lock
+            exclusive_lock lock(prop_lock);
 
-        try{
-            initUsrp();
-        }catch(...){
-            LOG_WARN(USRP_UHD_i,"CAUGHT EXCEPTION WHEN INITIALIZING USRP. WAITING 1 SECOND AND TRYING AGAIN");
-            sleep(1);
-            initUsrp();
-        }
-    } // end scope for prop_lock
+            initUsrpWithRetry();
+        } // end scope for prop_lock
+        syncCurrentDeviceTime();
+    } // end scope for time_sync_lock
 
     if(!started()){
         LOG_DEBUG(USRP_UHD_i,"targetDeviceChanged|device is not started, must start device after initialization");
@@ -959,8 +1636,17 @@ void USRP_UHD_i::deviceReferenceSourceChanged(std::string old_value, std::string
     LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
     LOG_DEBUG(USRP_UHD_i,"deviceReferenceSourceChanged|device_reference_source_global=" << device_reference_source_global);
 
-    updateDeviceReferenceSource(new_value);
-}
+    // the PPS wait is done without prop_lock, while time_sync_lock holds off allocations and enables that would
+    // send timed commands against the old device time
+    boost::mutex::scoped_lock sync_guard(time_sync_lock);
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        if (!updateDeviceReferenceSource(new_value))
+            return;
+    } // end scope for prop_lock
+
+    syncCurrentDeviceTime();
+}
 
 void USRP_UHD_i::deviceGroupIdChanged(std::string old_value, std::string new_value){
     LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
@@ -969,6 +1655,211 @@ void USRP_UHD_i::deviceGroupIdChanged(std::string old_value, std::string new_val
     updateGroupId(new_value);
 }
 
+void USRP_UHD_i::maxLatencyChanged(double old_value, double new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
+
+    exclusive_lock lock(prop_lock);
+    updateTunerMaxLatency();
+}
+
+void USRP_UHD_i::tunerMaxLatencyChanged(const std::vector<tuner_latency_struct>* old_value, const std::vector<tuner_latency_struct>* new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "num entries=" << new_value->size());
+
+    exclusive_lock lock(prop_lock);
+    updateTunerMaxLatency();
+}
+
+void USRP_UHD_i::rxAgcChanged(const rx_agc_struct& old_value, const rx_agc_struct& new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "continuous=" << new_value.continuous << "  update_period_ms=" << new_value.update_period_ms);
+
+    exclusive_lock lock(prop_lock);
+
+    // apply to existing allocations
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER" || getControlAllocationId(tuner_id).empty())
+            continue;
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrp_tuners[tuner_id].agc.update_period = new_value.update_period_ms/1000.0;
+        if (new_value.continuous != old_value.continuous)
+            usrp_tuners[tuner_id].agc.continuous = new_value.continuous;
+    }
+}
+
+void USRP_UHD_i::rxPushQueueChanged(const rx_push_queue_struct& old_value, const rx_push_queue_struct& new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "enable=" << new_value.enable << "  max_blocks=" << new_value.max_blocks
+                                             << "  overflow_policy=" << new_value.overflow_policy);
+    // enable applies at the next start
+    configurePushQueues(new_value);
+}
+
+void USRP_UHD_i::triggerRxAutogainChanged(bool old_value, bool new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
+
+    if (!new_value)
+        return;
+
+    // request a single adjustment from each RX tuner, which is made once each has received enough samps
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+            continue;
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrp_tuners[tuner_id].agc.one_shot = true;
+    }
+    trigger_rx_autogain = false;
+}
+
+void USRP_UHD_i::signalStatsPeriodChanged(double old_value, double new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
+
+    exclusive_lock lock(prop_lock);
+    if (new_value <= 0.0)
+        tuner_signal_stats.clear();
+
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrp_tuners[tuner_id].signal_stats.period = std::max(new_value, 0.0)/1000.0;
+        usrp_tuners[tuner_id].signal_stats.reset();
+    }
+}
+
+void USRP_UHD_i::resetLatencyHistogramsChanged(bool old_value, bool new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
+
+    if (!new_value)
+        return;
+
+    exclusive_lock lock(prop_lock);
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        usrp_tuners[tuner_id].device_to_recv.requestReset();
+    }
+    short_push_queue->resetLatency();
+    dataSDDS_out->resetLatency();
+    latency_histograms.clear();
+    reset_latency_histograms = false;
+}
+
+void USRP_UHD_i::traceSettingsChanged(const trace_settings_struct& old_value, const trace_settings_struct& new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "enabled=" << new_value.enabled << "  ring_events=" << new_value.ring_events);
+
+    if (new_value.enabled && !eventTrace::compiled()) {
+        LOG_WARN(USRP_UHD_i,"traceSettingsChanged|event tracing is not available, rebuild with configure --enable-trace");
+    }
+    eventTrace::configure(new_value.enabled, new_value.ring_events, new_value.dump_on_overflow);
+}
+
+void USRP_UHD_i::triggerTraceDumpChanged(bool old_value, bool new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "old_value=" << old_value << "  new_value=" << new_value);
+
+    if (!new_value)
+        return;
+    dumpEventTrace();
+    trigger_trace_dump = false;
+}
+
+void USRP_UHD_i::simDeviceChanged(const sim_device_struct& old_value, const sim_device_struct& new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "signal=" << new_value.signal << "  time_scale=" << new_value.time_scale
+                         << "  inject_overflow=" << new_value.inject_overflow << "  inject_timeout=" << new_value.inject_timeout);
+
+    exclusive_lock lock(prop_lock);
+    // channel counts and ranges apply the next time target_device selects the simulated device
+    if (usrp_sim.get() != NULL) {
+        usrp_sim->configure(new_value);
+        if (new_value.inject_overflow)
+            usrp_sim->injectOverflow();
+        if (new_value.inject_timeout)
+            usrp_sim->injectTimeout();
+    }
+    sim_device.inject_overflow = false;
+    sim_device.inject_timeout = false;
+}
+
+/* writes the event trace to trace_settings.dump_path */
+void USRP_UHD_i::dumpEventTrace(){
+    std::string path;
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        path = trace_settings.dump_path;
+    } // end scope for prop_lock
+
+    std::string error;
+    if (eventTrace::dump(path, error)) {
+        LOG_INFO(USRP_UHD_i,"dumpEventTrace|wrote event trace to " << path);
+    } else {
+        LOG_WARN(USRP_UHD_i,"dumpEventTrace|could not write event trace to " << path << ": " << error);
+    }
+}
+
+void USRP_UHD_i::lowLatencyAllocationsChanged(const std::vector<low_latency_allocation_struct>* old_value, const std::vector<low_latency_allocation_struct>* new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "num entries=" << new_value->size());
+
+    std::vector<size_t> start_tuners;
+    std::vector<short> start_cores;
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+
+        // apply to existing allocations
+        for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+            if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+                continue;
+            const std::string allocation_id = getControlAllocationId(tuner_id);
+            if (allocation_id.empty())
+                continue;
+            low_latency_allocation_struct settings;
+            const bool enable = getLowLatencySettings(allocation_id, settings);
+            {
+                scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+                setLowLatencyMode(tuner_id, enable, settings);
+            }
+            if (enable) {
+                start_tuners.push_back(tuner_id);
+                start_cores.push_back(settings.cpu_core);
+            }
+        }
+    } // end scope for prop_lock
+
+    for (size_t i = 0; i < start_tuners.size(); i++) {
+        startLowLatencyThread(start_tuners[i], start_cores[i]);
+    }
+}
+
+void USRP_UHD_i::hopScheduleChanged(const std::vector<hop_struct>* old_value, const std::vector<hop_struct>* new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << "num entries=" << new_value->size());
+
+    exclusive_lock lock(prop_lock);
+
+    // apply to existing allocations
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+            continue;
+        const std::string allocation_id = getControlAllocationId(tuner_id);
+        if (allocation_id.empty())
+            continue;
+        std::vector<hop_struct> hops;
+        getHopSchedule(allocation_id, tuner_id, hops);
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        setHopSchedule(tuner_id, hops);
+    }
+}
+
+void USRP_UHD_i::spectrumScanChanged(const spectrum_scan_struct& old_value, const spectrum_scan_struct& new_value){
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << " allocation_id=" << new_value.allocation_id);
+
+    exclusive_lock lock(prop_lock);
+
+    // apply to existing allocations, which stops the scan of any other
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+            continue;
+        const std::string allocation_id = getControlAllocationId(tuner_id);
+        if (allocation_id.empty())
+            continue;
+        spectrum_scan_struct settings;
+        const bool enable = getScanSettings(allocation_id, tuner_id, settings);
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        setScanMode(tuner_id, enable, settings);
+    }
+}
+
 void USRP_UHD_i::antennaChanged(const configure_tuner_antenna_struct& old_value, const configure_tuner_antenna_struct& new_value) {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
 
@@ -999,6 +1890,7 @@ void USRP_UHD_i::antennaChanged(const configure_tuner_antenna_struct& old_value,
 
     // Make the change and update antenna value
     if (frontend_tuner_status[idx].tuner_type == "RX_DIGITIZER") {
+        usrp_tuners[idx].tune_cache.invalidate();
         usrp_device_ptr->set_rx_antenna(antenna, frontend_tuner_status[idx].tuner_number);
         frontend_tuner_status[idx].antenna =
                 usrp_device_ptr->get_rx_antenna(frontend_tuner_status[idx].tuner_number);
@@ -1009,16 +1901,11 @@ void USRP_UHD_i::antennaChanged(const configure_tuner_antenna_struct& old_value,
     }
 
     // Update RF Flow ID
-    str2rfinfo_map_t::iterator it=rf_port_info_map.begin();
-    for (; it!=rf_port_info_map.end(); it++) {
-        if (it->second.tuner_idx == idx
-                && it->second.antenna == frontend_tuner_status[idx].antenna) {
-            frontend_tuner_status[idx].rf_flow_id = it->second.rfinfo_pkt.rf_flow_id;
-            usrp_tuners[idx].update_sri = true;
-            break;
-        }
-    }
-    if (it==rf_port_info_map.end()) {
+    str2rfinfo_map_t::iterator it=findRFInfoPort(idx, frontend_tuner_status[idx].antenna);
+    if (it!=rf_port_info_map.end()) {
+        frontend_tuner_status[idx].rf_flow_id = it->second.rfinfo_pkt.rf_flow_id;
+        usrp_tuners[idx].update_sri = true;
+    } else {
         LOG_WARN(USRP_UHD_i,"antennaChanged|tuner_id=" << idx
                 << "No matching RFInfo port found!! Failed to update RF Flow ID.");
     }
@@ -1034,6 +1921,7 @@ void USRP_UHD_i::clearBookkeeping(){
     // additional properties
     device_channels.clear();
     device_motherboards.clear();
+    time_sync_status = time_sync_status_struct();
 
     // additional internal
     usrp_ranges.clear();
@@ -1055,6 +1943,386 @@ std::string USRP_UHD_i::getStreamId(size_t tuner_id) {
     return frontend_tuner_status[tuner_id].stream_id;
 }
 
+/* acquire prop_lock prior to calling this function */
+double USRP_UHD_i::getTunerMaxLatency(size_t tuner_id){
+    double latency_ms = max_latency_ms;
+    for (size_t i = 0; i < tuner_max_latency.size(); i++) {
+        if (tuner_max_latency[i].tuner_index == tuner_id)
+            latency_ms = tuner_max_latency[i].max_latency_ms;
+    }
+    return std::max(latency_ms, 0.0)/1000.0;
+}
+
+/* acquire prop_lock prior to calling this function */
+void USRP_UHD_i::updateTunerMaxLatency(){
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+            continue;
+        const double latency = getTunerMaxLatency(tuner_id);
+        scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
+        usrp_tuners[tuner_id].max_latency = latency;
+        LOG_DEBUG(USRP_UHD_i,"updateTunerMaxLatency|tuner_id=" << tuner_id << " max_latency=" << latency << " sec");
+    }
+}
+
+/* acquire prop_lock prior to calling this function */
+bool USRP_UHD_i::getLowLatencySettings(const std::string& allocation_id, low_latency_allocation_struct& settings){
+    for (size_t i = 0; i < low_latency_allocations.size(); i++) {
+        if (!allocation_id.empty() && low_latency_allocations[i].allocation_id == allocation_id) {
+            settings = low_latency_allocations[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+/* acquire tuner's lock prior to calling this function */
+void USRP_UHD_i::setLowLatencyMode(size_t tuner_id, bool enable, const low_latency_allocation_struct& settings){
+    usrpLowLatencyStruct &ll = usrp_tuners[tuner_id].low_latency;
+    if (enable != ll.enabled) {
+        LOG_INFO(USRP_UHD_i,"setLowLatencyMode|tuner_id=" << tuner_id << " low latency mode " << (enable ? "enabled" : "disabled"));
+        ll.reset();
+    }
+    ll.enabled = enable;
+    if (enable) {
+        ll.packets_per_push = std::max(settings.packets_per_push, (unsigned short) 1);
+        ll.recv_timeout = settings.recv_timeout_us / 1e6;
+        ll.cpu_core = settings.cpu_core;
+    }
+}
+
+/* do not hold tuner's lock when calling this function */
+void USRP_UHD_i::startLowLatencyThread(size_t tuner_id, short cpu_core){
+    exclusive_lock lock(receive_service_thread_lock);
+
+    // threads are only run while the device is started, start() creates them otherwise
+    if (receive_service_thread == NULL)
+        return;
+
+    if (low_latency_service_threads.size() <= tuner_id)
+        low_latency_service_threads.resize(tuner_id+1, NULL);
+    if (low_latency_service_threads[tuner_id] == NULL) {
+        // NOOP (i.e. not in low latency mode) sleeps for 1 ms, otherwise thread spins
+        low_latency_service_threads[tuner_id] = new MultiProcessThread<USRP_UHD_i> (
+                boost::bind(&USRP_UHD_i::serviceFunctionLowLatency, this, tuner_id), 0.001);
+        low_latency_service_threads[tuner_id]->start();
+    }
+    if (!low_latency_service_threads[tuner_id]->setAffinity(cpu_core)) {
+        LOG_WARN(USRP_UHD_i,"startLowLatencyThread|tuner_id=" << tuner_id << " could not pin thread to cpu_core=" << cpu_core);
+    }
+}
+
+/* acquire tuner's lock prior to calling this function
+ * prop_lock is only tried, so this never blocks the receive thread, and never deadlocks with
+ * functions that acquire prop_lock prior to the tuner's lock
+ */
+void USRP_UHD_i::updateLowLatencyMetrics(size_t tuner_id){
+    usrpLowLatencyStruct &ll = usrp_tuners[tuner_id].low_latency;
+    boost::system_time now = boost::get_system_time();
+    if ((now - ll.last_publish).total_milliseconds() < 1000)
+        return;
+
+    boost::mutex::scoped_try_lock lock(prop_lock);
+    if (!lock.owns_lock())
+        return;
+    ll.last_publish = now;
+
+    size_t i = 0;
+    for (; i < low_latency_metrics.size(); i++) {
+        if (low_latency_metrics[i].tuner_index == tuner_id)
+            break;
+    }
+    if (i == low_latency_metrics.size())
+        low_latency_metrics.resize(i+1);
+    low_latency_metrics[i].tuner_index = tuner_id;
+    low_latency_metrics[i].allocation_id = getControlAllocationId(tuner_id);
+    low_latency_metrics[i].pushes = ll.pushes;
+    low_latency_metrics[i].latency_last_us = ll.latency_last*1e6;
+    low_latency_metrics[i].latency_avg_us = (ll.pushes > 0) ? ll.latency_sum/ll.pushes*1e6 : 0.0;
+    low_latency_metrics[i].latency_min_us = ll.latency_min*1e6;
+    low_latency_metrics[i].latency_max_us = ll.latency_max*1e6;
+}
+
+/* acquire prop_lock prior to calling this function
+ * hops outside of the tuner's freq range are left out
+ */
+void USRP_UHD_i::getHopSchedule(const std::string& allocation_id, size_t tuner_id, std::vector<hop_struct>& hops){
+    hops.clear();
+    for (size_t i = 0; i < hop_schedule.size(); i++) {
+        if (allocation_id.empty() || hop_schedule[i].allocation_id != allocation_id)
+            continue;
+        if (hop_schedule[i].center_frequency < device_channels[tuner_id].freq_min ||
+                hop_schedule[i].center_frequency > device_channels[tuner_id].freq_max) {
+            LOG_WARN(USRP_UHD_i,"getHopSchedule|skipping hop to invalid center frequency (" << hop_schedule[i].center_frequency
+                    << ") for allocation_id=" << allocation_id);
+            continue;
+        }
+        hops.push_back(hop_schedule[i]);
+    }
+}
+
+/* acquire tuner's lock prior to calling this function
+ * replaces the hops not yet sent to the device, and leaves a tuner with an unchanged schedule as is
+ * a scanning tuner keeps its scan steps
+ */
+void USRP_UHD_i::setHopSchedule(size_t tuner_id, const std::vector<hop_struct>& hops){
+    usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    if (usrp_tuners[tuner_id].scan.active || (hops == hs.schedule && !hs.repeat))
+        return;
+    LOG_DEBUG(USRP_UHD_i,"setHopSchedule|tuner_id=" << tuner_id << " num hops=" << hops.size());
+    hs.schedule = hops;
+    hs.next = 0;
+    hs.repeat = false;
+    hs.chained = false;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * sends the hops due within hop_lookahead_us of stream_time, the device time following the last samp received,
+ * as timed retunes, with at most hop_queue_depth pending. A hop due sooner than hop_lead_us from now is late,
+ * and is sent for hop_lead_us from now instead, so the samp where it takes effect is still known.
+ */
+void USRP_UHD_i::queueHops(size_t tuner_id, const uhd::time_spec_t& stream_time){
+    usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    const size_t chan = frontend_tuner_status[tuner_id].tuner_number;
+    hs.stream_time = stream_time;
+    const uhd::time_spec_t lookahead_time = stream_time + uhd::time_spec_t(hop_lookahead_us/1e6);
+    uhd::time_spec_t earliest;
+    bool have_earliest = false;
+
+    while (hs.next < hs.schedule.size() && hs.pending.size() < hop_queue_depth) {
+        const hop_struct &hop = hs.schedule[hs.next];
+
+        // time 0 follows the previous hop, or is as soon as possible for the first hop
+        const bool asap = (hop.time <= 0.0 && !hs.chained);
+        uhd::time_spec_t time = (hop.time > 0.0) ? uhd::time_spec_t(hop.time) : hs.last_time + uhd::time_spec_t(hs.last_dwell);
+        if (!asap && time > lookahead_time)
+            break;
+
+        if (!have_earliest) {
+            earliest = usrp_device_ptr->get_time_now() + uhd::time_spec_t(hop_lead_us/1e6);
+            have_earliest = true;
+        }
+        if (asap || time < earliest) {
+            // a late hop that follows the previous one just extends its dwell
+            if (hop.time > 0.0) {
+                LOG_WARN(USRP_UHD_i,"queueHops|tuner_id=" << tuner_id << " hop to " << hop.center_frequency << " is late by "
+                        << (earliest-time).get_real_secs()*1e3 << " ms");
+            }
+            time = earliest;
+        }
+        if (!hs.pending.empty() && time < hs.pending.back().time)
+            time = hs.pending.back().time;
+
+        try {
+            usrp_tuners[tuner_id].tune_cache.invalidate();
+            usrp_device_ptr->set_rx_freq_timed(hop.center_frequency, time, chan);
+            usrpHopStruct::timedHop pending;
+            pending.time = time;
+            pending.freq = usrp_device_ptr->get_rx_freq(chan);
+            pending.index = hs.next;
+            hs.pending.push_back(pending);
+        } catch (...) {
+            LOG_ERROR(USRP_UHD_i,"queueHops|tuner_id=" << tuner_id << " could not send hop to " << hop.center_frequency);
+        }
+        hs.chained = true;
+        hs.last_time = time;
+        hs.last_dwell = hop.dwell_ms/1e3;
+        hs.next++;
+        if (hs.next == hs.schedule.size() && hs.repeat)
+            hs.next = 0;
+    }
+}
+
+/* acquire tuner's lock prior to calling this function
+ * sends a retune to freq for hop_lead_us from now, or after the last hop sent if that is later. It is applied by
+ * splitAtHop like a hop, so the new SRI starts at the first samp after the retune and the stream is not interrupted.
+ */
+void USRP_UHD_i::queueRetune(size_t tuner_id, double freq){
+    usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    const size_t chan = frontend_tuner_status[tuner_id].tuner_number;
+    uhd::time_spec_t time = usrp_device_ptr->get_time_now() + uhd::time_spec_t(hop_lead_us/1e6);
+    if (!hs.pending.empty() && time < hs.pending.back().time)
+        time = hs.pending.back().time;
+
+    usrp_device_ptr->set_rx_freq_timed(freq, time, chan);
+    usrp_tuners[tuner_id].tune_cache.invalidate();
+    usrpHopStruct::timedHop retune;
+    retune.time = time;
+    retune.freq = usrp_device_ptr->get_rx_freq(chan);
+    retune.index = hs.current;
+    hs.pending.push_back(retune);
+    LOG_DEBUG(USRP_UHD_i,"queueRetune|tuner_id=" << tuner_id << " retune to " << retune.freq << " at device time " << time.get_real_secs());
+}
+
+/* acquire tuner's lock prior to calling this function
+ * num_samps were just added to the buffer, starting at device time time_spec. Pending hops that take effect
+ * at the first of them are applied, when they are the only samps in the buffer. Otherwise, the samps from
+ * the hop on are held for the next usrpReceive, and the buffer is marked to be pushed.
+ * returns the num samps left in the buffer of the num_samps added
+ */
+size_t USRP_UHD_i::splitAtHop(size_t tuner_id, const uhd::time_spec_t& time_spec, size_t num_samps){
+    usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    const double sample_rate = rxSampleRate(tuner_id);
+    while (!hs.pending.empty()) {
+        // first samp at or after the retune
+        const double offset = (hs.pending.front().time-time_spec).get_real_secs()*sample_rate;
+        const size_t samp = (offset > 0.0) ? size_t(ceil(offset-1e-6)) : 0;
+        if (samp >= num_samps)
+            break;
+
+        if (samp == 0 && usrp_tuners[tuner_id].buffer_size == num_samps*2) {
+            LOG_DEBUG(USRP_UHD_i,"splitAtHop|tuner_id=" << tuner_id << " hopped to " << hs.pending.front().freq);
+            frontend_tuner_status[tuner_id].center_frequency = hs.pending.front().freq;
+            usrp_tuners[tuner_id].update_sri = true;
+            hs.current = hs.pending.front().index;
+            hs.applied++;
+            hs.pending.pop_front();
+            continue;
+        }
+
+        const size_t held_samps = num_samps-samp;
+        std::vector<short>::iterator end = usrp_tuners[tuner_id].output_buffer.begin()+usrp_tuners[tuner_id].buffer_size;
+        hs.held.assign(end-held_samps*2, end);
+        hs.held_time = time_spec + uhd::time_spec_t::from_ticks(samp, sample_rate);
+        usrp_tuners[tuner_id].buffer_size -= held_samps*2;
+        hs.push = true;
+        return samp;
+    }
+    return num_samps;
+}
+
+/* acquire prop_lock prior to calling this function
+ * returns false if spectrum_scan is not for this allocation, or is outside of the tuner's freq range
+ */
+bool USRP_UHD_i::getScanSettings(const std::string& allocation_id, size_t tuner_id, spectrum_scan_struct& settings){
+    if (allocation_id.empty() || spectrum_scan.allocation_id != allocation_id)
+        return false;
+    if (spectrum_scan.start_frequency < device_channels[tuner_id].freq_min || spectrum_scan.stop_frequency > device_channels[tuner_id].freq_max ||
+            spectrum_scan.start_frequency >= spectrum_scan.stop_frequency) {
+        LOG_WARN(USRP_UHD_i,"getScanSettings|invalid scan range (" << spectrum_scan.start_frequency << " to " << spectrum_scan.stop_frequency
+                << ") for allocation_id=" << allocation_id);
+        return false;
+    }
+    settings = spectrum_scan;
+    return true;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * plans the scan steps for the tuner's current sample rate, and leaves a scan with unchanged settings and rate as is
+ * stopping a scan retunes to the tuner's center freq from before the scan
+ */
+void USRP_UHD_i::setScanMode(size_t tuner_id, bool enable, const spectrum_scan_struct& settings){
+    usrpScanStruct &sc = usrp_tuners[tuner_id].scan;
+    usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    const double sample_rate = rxSampleRate(tuner_id);
+
+    if (enable && sc.active && settings == sc.settings && sample_rate == sc.sample_rate)
+        return;
+    if (enable && (sample_rate <= 0.0 || settings.fft_size > usrp_tuners[tuner_id].buffer_capacity/2 || !sc.psd.configure(settings.fft_size))) {
+        LOG_WARN(USRP_UHD_i,"setScanMode|tuner_id=" << tuner_id << " invalid fft_size (" << settings.fft_size << ")");
+        enable = false;
+    }
+
+    if (!enable) {
+        if (!sc.active)
+            return;
+        LOG_INFO(USRP_UHD_i,"setScanMode|tuner_id=" << tuner_id << " scan stopped");
+        hop_struct hop;
+        hop.center_frequency = sc.return_frequency;
+        hs.schedule.assign(1, hop);
+        hs.next = 0;
+        hs.repeat = false;
+        hs.chained = false;
+        sc = usrpScanStruct();
+        return;
+    }
+
+    if (!sc.active)
+        sc.return_frequency = frontend_tuner_status[tuner_id].center_frequency;
+    sc.active = true;
+    sc.settings = settings;
+    sc.sample_rate = sample_rate;
+    sc.full_scale = double(usrp_tuners[tuner_id].signal_stats.clip_level)+1.0;
+
+    // step k keeps bins first_bin to first_bin+bins_per_step-1, which start at bin k*bins_per_step of the sweep
+    const size_t fft_size = settings.fft_size;
+    const double bin_spacing = sample_rate/fft_size;
+    sc.bins_per_step = std::max(std::min(size_t(fft_size*settings.step_fraction), fft_size), size_t(1));
+    sc.first_bin = (fft_size-sc.bins_per_step)/2;
+    sc.num_steps = std::max(size_t(ceil((settings.stop_frequency-settings.start_frequency)/bin_spacing/sc.bins_per_step)), size_t(1));
+    sc.averages = std::max(settings.averages, (unsigned short) 1);
+    sc.settle_samps = size_t(std::max(settings.settle_ms, 0.0)/1e3*sample_rate);
+    sc.hops_applied = hs.applied+hs.pending.size(); // hops already sent are from the last plan
+    sc.measuring = false;
+    sc.sweep.clear();
+
+    hop_struct hop;
+    hop.allocation_id = getControlAllocationId(tuner_id);
+    hop.dwell_ms = (sc.settle_samps + sc.averages*fft_size)/sample_rate*1e3;
+    hs.schedule.clear();
+    for (size_t step = 0; step < sc.num_steps; step++) {
+        hop.center_frequency = settings.start_frequency + (double(step*sc.bins_per_step) + fft_size/2 - sc.first_bin)*bin_spacing;
+        hs.schedule.push_back(hop);
+    }
+    hs.next = 0;
+    hs.repeat = true;
+    hs.chained = false;
+    LOG_INFO(USRP_UHD_i,"setScanMode|tuner_id=" << tuner_id << " scanning " << settings.start_frequency << " to " << settings.stop_frequency
+            << " in " << sc.num_steps << " steps of " << hop.dwell_ms << " ms");
+}
+
+/* acquire tuner's lock prior to calling this function
+ * measures the buffer for the step of the last hop applied, in place of pushing it
+ * prop_lock is only tried when publishing a sweep, as in updateSignalStats, so a busy prop_lock drops the sweep
+ */
+void USRP_UHD_i::scanRxBuffer(size_t tuner_id){
+    usrpScanStruct &sc = usrp_tuners[tuner_id].scan;
+    const usrpHopStruct &hs = usrp_tuners[tuner_id].hops;
+    const short *data = &usrp_tuners[tuner_id].output_buffer[0];
+    size_t num_samps = usrp_tuners[tuner_id].buffer_size/2;
+    usrp_tuners[tuner_id].buffer_size = 0;
+
+    if (hs.applied > sc.hops_applied) {
+        sc.hops_applied = hs.applied;
+        sc.step = hs.current;
+        sc.skip = sc.settle_samps;
+        sc.measuring = true;
+        sc.psd.reset();
+        if (sc.step == 0) {
+            sc.sweep.clear();
+            sc.sweep_start_ns = hotPathNow();
+        }
+    } else if (!sc.measuring) {
+        return; // first step not reached yet, or current step is complete
+    }
+
+    const size_t skipped = std::min(sc.skip, num_samps);
+    sc.skip -= skipped;
+    sc.psd.add(data+2*skipped, num_samps-skipped, sc.averages);
+    if (sc.psd.frames() < sc.averages)
+        return;
+    sc.measuring = false;
+
+    // a step cut short (e.g. by an overflow) leaves out the rest of the sweep
+    if (sc.sweep.size() != sc.step*sc.bins_per_step)
+        return;
+    sc.psd.result(sc.full_scale, sc.first_bin, sc.bins_per_step, sc.sweep);
+    if (sc.step+1 < sc.num_steps)
+        return;
+
+    sc.sweeps++;
+    boost::mutex::scoped_try_lock lock(prop_lock);
+    if (!lock.owns_lock())
+        return;
+    const double bin_spacing = sc.sample_rate/sc.psd.size();
+    spectrum_scan_result.allocation_id = getControlAllocationId(tuner_id);
+    spectrum_scan_result.start_frequency = hs.schedule[0].center_frequency + (double(sc.first_bin) - sc.psd.size()/2)*bin_spacing;
+    spectrum_scan_result.bin_spacing = bin_spacing;
+    spectrum_scan_result.sweeps = sc.sweeps;
+    spectrum_scan_result.sweep_time_ms = (hotPathNow()-sc.sweep_start_ns)/1e6;
+    spectrum_scan_result.psd_dbfs.swap(sc.sweep);
+}
+
 /* acquire prop_lock prior to calling this function */
 double USRP_UHD_i::optimizeRate(const double& req_rate, const size_t tuner_id){
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " req_rate=" << req_rate);
@@ -1062,6 +2330,20 @@ double USRP_UHD_i::optimizeRate(const double& req_rate, const size_t tuner_id){
     if(frontend::floatingPointCompare(req_rate,0) <= 0){
         return usrp_ranges[tuner_id].sample_rate.clip(device_channels[tuner_id].rate_min);
     }
+
+    // lowest achievable rate at or above req_rate, from the index built at init
+    const std::vector<double>& rates = usrp_ranges[tuner_id].rates;
+    if (!rates.empty() && (!usrp_ranges[tuner_id].rates_truncated || req_rate >= rates.front())) {
+        std::vector<double>::const_iterator it = std::lower_bound(rates.begin(), rates.end(), req_rate);
+        // lower_bound is exact, but a rate within floatingPointCompare of req_rate is also good enough
+        while (it != rates.begin() && frontend::floatingPointCompare(*(it-1),req_rate) >= 0)
+            --it;
+        if (it != rates.end())
+            return *it;
+        LOG_DEBUG(USRP_UHD_i,"optimizeRate|could not optimize rate, returning req_rate (" << req_rate << ")");
+        return req_rate;
+    }
+
     size_t dec = round(device_channels[tuner_id].clock_max/req_rate);
     double opt_rate = device_channels[tuner_id].clock_max / double(dec);
     double usrp_rate = usrp_ranges[tuner_id].sample_rate.clip(opt_rate);
@@ -1200,6 +2482,26 @@ void USRP_UHD_i::updateAvailableDevices(){
     }
 }
 
+/* splits a comma separated list, dropping spaces and empty entries */
+static std::vector<std::string> splitList(const std::string& list) {
+    std::vector<std::string> values;
+    std::istringstream ss(list);
+    std::string value;
+    while (std::getline(ss, value, ',')) {
+        value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+        if (!value.empty())
+            values.push_back(value);
+    }
+    return values;
+}
+
+/* host time as a device time */
+static uhd::time_spec_t hostTime() {
+    struct timeval tmp_time;
+    gettimeofday(&tmp_time, NULL);
+    return uhd::time_spec_t(time_t(tmp_time.tv_sec), tmp_time.tv_usec / 1e6);
+}
+
 /* call acquire prop_lock prior to calling this function */
 void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
@@ -1217,13 +2519,24 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
             LOG_DEBUG(USRP_UHD_i, "adding target device hint name=" << target_device.name);
             hint["name"] = target_device.name;
         }
-        if(!target_device.serial.empty()){
-            LOG_DEBUG(USRP_UHD_i, "adding target device hint serial=" << target_device.serial);
-            hint["serial"] = target_device.serial;
+        // several addresses (or serials) combine those USRPs into one multi_usrp, numbered as addr0, addr1, ...
+        const std::vector<std::string> serials = splitList(target_device.serial);
+        const std::vector<std::string> addrs = splitList(target_device.ip_address);
+        for (size_t i = 0; i < serials.size(); i++) {
+            std::ostringstream key;
+            key << "serial";
+            if (serials.size() > 1)
+                key << i;
+            LOG_DEBUG(USRP_UHD_i, "adding target device hint " << key.str() << "=" << serials[i]);
+            hint[key.str()] = serials[i];
         }
-        if(!target_device.ip_address.empty()){
-            LOG_DEBUG(USRP_UHD_i, "adding target device hint ip_address=" << target_device.ip_address);
-            hint["addr"] = target_device.ip_address;
+        for (size_t i = 0; i < addrs.size(); i++) {
+            std::ostringstream key;
+            key << "addr";
+            if (addrs.size() > 1)
+                key << i;
+            LOG_DEBUG(USRP_UHD_i, "adding target device hint " << key.str() << "=" << addrs[i]);
+            hint[key.str()] = addrs[i];
         }
         LOG_DEBUG(USRP_UHD_i, "target device hint contains " << hint.size() << " values");
 
@@ -1231,34 +2544,40 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
             return;
         }
 
-        uhd::device_addrs_t dev_addrs = uhd::device::find(hint);
-        if( dev_addrs.size() == 0){
-            LOG_ERROR(USRP_UHD_i,"COULD NOT FIND MATCHING USRP DEVICE!");
-            throw CF::PropertySet::InvalidConfiguration();
-        }
+        if (target_device.type == "sim") {
+            LOG_INFO(USRP_UHD_i, "Using simulated USRP with " << sim_device.num_rx_channels << " RX and "
+                                 << sim_device.num_tx_channels << " TX channels");
+            usrp_sim.reset(new simBackend(sim_device));
+            usrp_device_ptr = usrp_sim;
+        } else if (!addrs.empty() || serials.size() > 1) {
+            // the addresses identify the devices, so skip the broadcast; make() only contacts those addresses
+            // find() does not understand numbered keys, so several serials are also passed straight to make()
+            LOG_DEBUG(USRP_UHD_i, "Making device at " << target_device.ip_address << target_device.serial << " without searching");
+            usrp_sim.reset();
+            usrp_device_ptr.reset(new uhdBackend(hint));
+            const size_t num_requested = std::max(addrs.size(), serials.size());
+            if (usrp_device_ptr->get_num_mboards() != num_requested) {
+                LOG_WARN(USRP_UHD_i, "Requested " << num_requested << " USRPs but got " << usrp_device_ptr->get_num_mboards() << " motherboards");
+            } else if (num_requested > 1) {
+                LOG_INFO(USRP_UHD_i, "Combined " << num_requested << " USRPs into one device");
+            }
+        } else {
+            uhd::device_addrs_t dev_addrs = uhd::device::find(hint);
+            if( dev_addrs.size() == 0){
+                LOG_ERROR(USRP_UHD_i,"COULD NOT FIND MATCHING USRP DEVICE!");
+                throw CF::PropertySet::InvalidConfiguration();
+            }
 
-        LOG_DEBUG(USRP_UHD_i, "Found " << dev_addrs.size() << " devices, choosing first one found.")
+            LOG_DEBUG(USRP_UHD_i, "Found " << dev_addrs.size() << " devices, choosing first one found.")
 
-        usrp_device_ptr = uhd::usrp::multi_usrp::make(dev_addrs[0]);
+            usrp_sim.reset();
+            usrp_device_ptr.reset(new uhdBackend(dev_addrs[0]));
+        }
         const size_t num_rx_channels = usrp_device_ptr->get_rx_num_channels();
         const size_t num_tx_channels = usrp_device_ptr->get_tx_num_channels();
 
-        // get_rx/tx_freq will throw an exception if set_rx/tx_freq has not already been called
-        for (size_t chan = 0; chan < num_rx_channels; chan++) {
-            double setFreq = (usrp_device_ptr->get_rx_freq_range(chan).start() + usrp_device_ptr->get_rx_freq_range(chan).stop()) / 2;
-            usrp_device_ptr->set_rx_freq(setFreq, chan);
-        }
-        for (size_t chan = 0; chan < num_tx_channels; chan++) {
-            double setFreq = (usrp_device_ptr->get_tx_freq_range(chan).start() + usrp_device_ptr->get_tx_freq_range(chan).stop()) / 2;
-            usrp_device_ptr->set_tx_freq(setFreq, chan);
-        }
-
-        struct timeval tmp_time;
-        struct timezone tmp_tz;
-        gettimeofday(&tmp_time, &tmp_tz);
-        time_t wsec = tmp_time.tv_sec;
-        double fsec = tmp_time.tv_usec / 1e6;
-        usrp_device_ptr->set_time_now(uhd::time_spec_t(wsec,fsec));
+        // provisional, updateDeviceReferenceSource resyncs on a PPS if there is an external reference
+        usrp_device_ptr->set_time_now(hostTime());
 
         // Initialize tasking and status vectors
         setNumChannels(num_rx_channels,num_tx_channels);
@@ -1286,12 +2605,9 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
             frontend_tuner_status[tuner_id].antenna = device_channels[tuner_id].antenna;
             frontend_tuner_status[tuner_id].available_antennas = device_channels[tuner_id].available_antennas;
 
-            for (str2rfinfo_map_t::iterator it=rf_port_info_map.begin(); it!=rf_port_info_map.end(); it++) {
-                if (it->second.tuner_idx == tuner_id && it->second.antenna == frontend_tuner_status[tuner_id].antenna) {
-                    frontend_tuner_status[tuner_id].rf_flow_id = it->second.rfinfo_pkt.rf_flow_id;
-                    break;
-                }
-            }
+            str2rfinfo_map_t::iterator rfinfo = findRFInfoPort(tuner_id, frontend_tuner_status[tuner_id].antenna);
+            if (rfinfo != rf_port_info_map.end())
+                frontend_tuner_status[tuner_id].rf_flow_id = rfinfo->second.rfinfo_pkt.rf_flow_id;
 
             frontend_tuner_status[tuner_id].reference_source = source_prop;
             frontend_tuner_status[tuner_id].gain = device_channels[tuner_id].gain_current;
@@ -1301,6 +2617,7 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
             frontend_tuner_status[tuner_id].tuner_index = tuner_id;
             frontend_tuner_status[tuner_id].tuner_number = device_channels[tuner_id].chan_num;
             frontend_tuner_status[tuner_id].enabled = false;
+            frontend_tuner_status[tuner_id].status = "disabled";
             frontend_tuner_status[tuner_id].complex = true;
             frontend_tuner_status[tuner_id].valid = true;
             frontend_tuner_status[tuner_id].sample_rate_tolerance = 0.0;
@@ -1343,6 +2660,9 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
         updateDeviceRxGain(device_rx_gain_global); // sets device with global value, so need to call this one
         updateDeviceTxGain(device_tx_gain_global); // sets device with global value, so need to call this one
         updateDeviceReferenceSource(device_reference_source_global); // sets device with global value, so need to call this one
+        // device time is set by the caller once prop_lock is released (syncCurrentDeviceTime), since the PPS wait blocks
+        time_sync_status = time_sync_status_struct();
+        updateTunerMaxLatency();
 
     } catch (...) {
         LOG_ERROR(USRP_UHD_i,"USRP COULD NOT BE INITIALIZED!");
@@ -1351,6 +2671,25 @@ void USRP_UHD_i::initUsrp() throw (CF::PropertySet::InvalidConfiguration) {
     }
 }
 
+/* A USRP that was just power cycled, or released by another process, can take a moment to answer, so retry
+ * initUsrp a few times with a short exponential backoff before giving up.
+ * acquire prop_lock prior to calling this function */
+void USRP_UHD_i::initUsrpWithRetry() throw (CF::PropertySet::InvalidConfiguration) {
+    useconds_t backoff_us = init_backoff_us;
+    for (size_t attempt = 1; ; attempt++) {
+        try {
+            initUsrp();
+            return;
+        } catch (CF::PropertySet::InvalidConfiguration& e) {
+            if (attempt >= init_attempts)
+                throw;
+            LOG_WARN(USRP_UHD_i,"CAUGHT EXCEPTION WHEN INITIALIZING USRP. WAITING " << backoff_us/1000 << " ms AND TRYING AGAIN");
+            usleep(backoff_us);
+            backoff_us *= 2;
+        }
+    }
+}
+
 /* acquire prop_lock prior to calling this function */
 void USRP_UHD_i::updateDeviceInfo() {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
@@ -1361,7 +2700,7 @@ void USRP_UHD_i::updateDeviceInfo() {
     for (size_t mthr = 0; mthr < usrp_device_ptr->get_num_mboards(); mthr++) {
         usrp_motherboard_struct availMotherboard;
         availMotherboard.mb_name = usrp_device_ptr->get_mboard_name(mthr);
-        availMotherboard.mb_ip = "[NEED TO IMPLEMENT]";
+        availMotherboard.mb_ip = usrp_device_ptr->get_mboard_addr(mthr);
         device_motherboards.push_back(availMotherboard);
     }
 
@@ -1381,16 +2720,46 @@ void USRP_UHD_i::updateDeviceInfo() {
     tx_antenna_mapping.push_back(str2strptr_pair_t("RFInfoTX_out",  &device_antenna_mapping.RFInfoTX_out));
     tx_antenna_mapping.push_back(str2strptr_pair_t("RFInfoTX_out2", &device_antenna_mapping.RFInfoTX_out2));
 
+    // The queries for each channel are independent, and each may be a round trip to a networked device, so
+    // read all of the channels at once.
+    usrp_ranges.clear();
     usrp_ranges.resize(num_rx_channels+num_tx_channels);
+    std::vector<usrp_channel_struct> channels(num_rx_channels+num_tx_channels);
+    std::vector<std::string> errors(num_rx_channels+num_tx_channels);
+    boost::thread_group readers;
+    for (size_t idx = 0; idx < channels.size(); idx++) {
+        const bool tx = (idx >= num_rx_channels);
+        readers.create_thread(boost::bind(&USRP_UHD_i::readChannelInfo, this, tx, tx ? idx-num_rx_channels : idx,
+                boost::ref(channels[idx]), boost::ref(usrp_ranges[idx]), boost::ref(errors[idx])));
+    }
+    readers.join_all();
+    for (size_t idx = 0; idx < errors.size(); idx++) {
+        if (!errors[idx].empty()) {
+            LOG_ERROR(USRP_UHD_i,"updateDeviceInfo|could not read channel " << channels[idx].chan_num << ": " << errors[idx]);
+            throw std::runtime_error(errors[idx]);
+        }
+    }
+
+    // channels beyond those with RFInfo ports (e.g. on a second motherboard) get an entry per antenna,
+    // named for the channel, so they can still be allocated. Drop the ones from a previous device.
+    for (str2rfinfo_map_t::iterator it = rf_port_info_map.begin(); it != rf_port_info_map.end();) {
+        if (it->first.compare(0, 2, "RX") == 0 || it->first.compare(0, 2, "TX") == 0)
+            rf_port_info_map.erase(it++);
+        else
+            ++it;
+    }
+    const char* rx_cal_ports[] = {"CAL_RX", "CAL_RX2"};
+    const char* tx_cal_ports[] = {"CAL_TX", "CAL_TX2"};
+
     for (size_t chan = 0; chan < num_rx_channels; chan++) {
-        usrp_channel_struct availChan;
-        availChan.chan_num = chan;
-        availChan.ch_name = usrp_device_ptr->get_rx_subdev_name(chan);
-        availChan.tuner_type = "RX_DIGITIZER";
-        if(availChan.ch_name.find("unknown") != std::string::npos)
-            availChan.tuner_type = "UNKNOWN";
-        availChan.antenna = usrp_device_ptr->get_rx_antenna(chan);
-        availChan.available_antennas = usrp_device_ptr->get_rx_antennas(chan);
+        const usrp_channel_struct& availChan = channels[chan];
+
+        if (2*chan >= rx_antenna_mapping.size()) {
+            addChannelRFInfo("RX", chan, chan, availChan.available_antennas);
+            device_channels.push_back(availChan);
+            continue;
+        }
+        rf_port_info_map[rx_cal_ports[chan]].tuner_idx = chan;
 
         // This assumes there should be at most 3 antennas, and the 3rd/last will always be CAL
         switch(availChan.available_antennas.size()) {
@@ -1407,48 +2776,17 @@ void USRP_UHD_i::updateDeviceInfo() {
             rf_port_info_map[rx_antenna_mapping[2*chan].first].tuner_idx = chan;
         }
 
-        availChan.freq_current = usrp_device_ptr->get_rx_freq(chan);
-        usrp_ranges[chan].frequency = usrp_device_ptr->get_rx_freq_range(chan); // this is the CF range, actual range is +/- (sr/2)
-        availChan.freq_min = usrp_ranges[chan].frequency.start();
-        availChan.freq_max = usrp_ranges[chan].frequency.stop();
-
-        availChan.bandwidth_current = usrp_device_ptr->get_rx_bandwidth(chan);
-        usrp_ranges[chan].bandwidth = usrp_device_ptr->get_rx_bandwidth_range(chan);
-        availChan.bandwidth_min = usrp_ranges[chan].bandwidth.start();
-        availChan.bandwidth_max = usrp_ranges[chan].bandwidth.stop();
-
-        availChan.rate_current = usrp_device_ptr->get_rx_rate(chan);
-        usrp_ranges[chan].sample_rate = usrp_device_ptr->get_rx_rates(chan);
-        availChan.rate_min = usrp_ranges[chan].sample_rate.start();
-        availChan.rate_max = usrp_ranges[chan].sample_rate.stop();
-
-        availChan.gain_current = usrp_device_ptr->get_rx_gain(chan);
-        usrp_ranges[chan].gain = usrp_device_ptr->get_rx_gain_range(chan);
-        availChan.gain_min = usrp_ranges[chan].gain.start();
-        availChan.gain_max = usrp_ranges[chan].gain.stop();
-
-        try{
-            std::vector<double> rates = usrp_device_ptr->get_rx_dboard_iface(chan)->get_clock_rates(uhd::usrp::dboard_iface::UNIT_RX);
-            availChan.clock_min = rates.back();
-            availChan.clock_max = rates.front();
-            LOG_DEBUG(USRP_UHD_i,"updateDeviceInfo|rx"<<chan<<"|got clock rates ["<<rates.back()<<":"<<rates.front()<<"]");
-        } catch(...) {
-            LOG_WARN(USRP_UHD_i,"Unable to get clock rates for RX channel " << chan << ", setting to min=0 max=2*rate_max")
-            availChan.clock_min = 0;
-            availChan.clock_max = 2*availChan.rate_max;
-        }
-
         device_channels.push_back(availChan);
     }
     for (size_t chan = 0; chan < num_tx_channels; chan++) {
-        usrp_channel_struct availChan;
-        availChan.chan_num = chan;
-        availChan.ch_name = usrp_device_ptr->get_tx_subdev_name(chan);
-        availChan.tuner_type = "TX";
-        if(availChan.ch_name.find("unknown") != std::string::npos)
-            availChan.tuner_type = "UNKNOWN";
-        availChan.antenna = usrp_device_ptr->get_tx_antenna(chan);
-        availChan.available_antennas = usrp_device_ptr->get_tx_antennas(chan);
+        const usrp_channel_struct& availChan = channels[num_rx_channels+chan];
+
+        if (chan >= tx_antenna_mapping.size()) {
+            addChannelRFInfo("TX", chan, num_rx_channels+chan, availChan.available_antennas);
+            device_channels.push_back(availChan);
+            continue;
+        }
+        rf_port_info_map[tx_cal_ports[chan]].tuner_idx = num_rx_channels+chan;
 
         // This assumes there should be at most 2 antennas, and the 2rd/last will always be CAL
         if (availChan.available_antennas.size() > 0) {
@@ -1457,42 +2795,176 @@ void USRP_UHD_i::updateDeviceInfo() {
             rf_port_info_map[tx_antenna_mapping[chan].first].tuner_idx = num_rx_channels+chan;
         }
 
-        availChan.freq_current = usrp_device_ptr->get_tx_freq(chan);
-        usrp_ranges[num_rx_channels+chan].frequency = usrp_device_ptr->get_tx_freq_range(chan); // this is the CF range, actual range is +/- (sr/2)
-        availChan.freq_min = usrp_ranges[num_rx_channels+chan].frequency.start();
-        availChan.freq_max = usrp_ranges[num_rx_channels+chan].frequency.stop();
+        device_channels.push_back(availChan);
+    }
+
+    indexRFInfoPorts();
+
+    for (size_t tuner_id = 0; tuner_id < device_channels.size(); tuner_id++)
+        buildRateIndex(tuner_id);
+}
 
-        availChan.bandwidth_current = usrp_device_ptr->get_tx_bandwidth(chan);
-        usrp_ranges[num_rx_channels+chan].bandwidth = usrp_device_ptr->get_tx_bandwidth_range(chan);
-        availChan.bandwidth_min = usrp_ranges[num_rx_channels+chan].bandwidth.start();
-        availChan.bandwidth_max = usrp_ranges[num_rx_channels+chan].bandwidth.stop();
+/* Updates the current values in device_channels for one channel after it has been tuned. The ranges read by
+ * updateDeviceInfo do not change until the device is initialized again.
+ * acquire prop_lock prior to calling this function */
+void USRP_UHD_i::refreshChannelInfo(size_t tuner_id) {
+    LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " tuner_id=" << tuner_id);
+    if (usrp_device_ptr.get() == NULL || tuner_id >= device_channels.size())
+        return;
 
-        availChan.rate_current = usrp_device_ptr->get_tx_rate(chan);
-        usrp_ranges[num_rx_channels+chan].sample_rate = usrp_device_ptr->get_tx_rates(chan);
-        availChan.rate_min = usrp_ranges[num_rx_channels+chan].sample_rate.start();
-        availChan.rate_max = usrp_ranges[num_rx_channels+chan].sample_rate.stop();
+    usrp_channel_struct& chan = device_channels[tuner_id];
+    if (chan.tuner_type == "RX_DIGITIZER") {
+        chan.freq_current = usrp_device_ptr->get_rx_freq(chan.chan_num);
+        chan.bandwidth_current = usrp_device_ptr->get_rx_bandwidth(chan.chan_num);
+        chan.rate_current = usrp_device_ptr->get_rx_rate(chan.chan_num);
+        chan.gain_current = usrp_device_ptr->get_rx_gain(chan.chan_num);
+        chan.antenna = usrp_device_ptr->get_rx_antenna(chan.chan_num);
+    } else if (chan.tuner_type == "TX") {
+        chan.freq_current = usrp_device_ptr->get_tx_freq(chan.chan_num);
+        chan.bandwidth_current = usrp_device_ptr->get_tx_bandwidth(chan.chan_num);
+        chan.rate_current = usrp_device_ptr->get_tx_rate(chan.chan_num);
+        chan.gain_current = usrp_device_ptr->get_tx_gain(chan.chan_num);
+        chan.antenna = usrp_device_ptr->get_tx_antenna(chan.chan_num);
+    }
+}
 
-        availChan.gain_current = usrp_device_ptr->get_tx_gain(chan);
-        usrp_ranges[num_rx_channels+chan].gain = usrp_device_ptr->get_tx_gain_range(chan);
-        availChan.gain_min = usrp_ranges[num_rx_channels+chan].gain.start();
-        availChan.gain_max = usrp_ranges[num_rx_channels+chan].gain.stop();
+/* Precomputes the sample rates optimizeRate can choose from, clock_max/dec for each decimation clipped to the
+ * channel's rate range, so an allocation is a binary search rather than a walk through the decimations.
+ * acquire prop_lock prior to calling this function */
+void USRP_UHD_i::buildRateIndex(size_t tuner_id) {
+    usrpRangesStruct& ranges = usrp_ranges[tuner_id];
+    const usrp_channel_struct& chan = device_channels[tuner_id];
+    ranges.rates.clear();
+    ranges.rates_truncated = false;
+    if (chan.clock_max <= 0 || chan.rate_max <= 0)
+        return;
 
+    const size_t min_dec = std::max(size_t(1), size_t(round(chan.clock_max/chan.rate_max)));
+    size_t max_dec = min_dec + max_rate_index - 1;
+    if (chan.rate_min > 0 && ceil(chan.clock_max/chan.rate_min) < max_dec)
+        max_dec = size_t(ceil(chan.clock_max/chan.rate_min));
+    else
+        ranges.rates_truncated = true;
+
+    ranges.rates.reserve(max_dec-min_dec+1);
+    for (size_t dec = max_dec; dec >= min_dec; dec--)
+        ranges.rates.push_back(ranges.sample_rate.clip(chan.clock_max/double(dec)));
+    std::sort(ranges.rates.begin(), ranges.rates.end());
+    ranges.rates.erase(std::unique(ranges.rates.begin(), ranges.rates.end()), ranges.rates.end());
+    LOG_DEBUG(USRP_UHD_i,"buildRateIndex|tuner " << tuner_id << " has " << ranges.rates.size() << " rates from "
+                         << ranges.rates.front() << " to " << ranges.rates.back());
+}
+
+/* acquire prop_lock prior to calling this function
+ * rebuilds rf_port_index after rf_port_info_map entries are added, removed, or change tuner or antenna.
+ * Where several entries have the same tuner and antenna, the first in the map is used, as a scan would find.
+ */
+void USRP_UHD_i::indexRFInfoPorts() {
+    rf_port_index.clear();
+    for (str2rfinfo_map_t::iterator it=rf_port_info_map.begin(); it!=rf_port_info_map.end(); it++)
+        rf_port_index.insert(std::make_pair(std::make_pair(it->second.tuner_idx, it->second.antenna), it->first));
+}
+
+/* the rf_port_info_map entry for a tuner and antenna, or rf_port_info_map.end() if there is none */
+USRP_UHD_i::str2rfinfo_map_t::iterator USRP_UHD_i::findRFInfoPort(size_t tuner_id, const std::string& antenna) {
+    rfport_index_t::const_iterator port = rf_port_index.find(std::make_pair(tuner_id, antenna));
+    if (port == rf_port_index.end())
+        return rf_port_info_map.end();
+    return rf_port_info_map.find(port->second);
+}
+
+/* acquire prop_lock prior to calling this function
+ * adds an rf_port_info_map entry for each antenna of a channel that has no RFInfo port, so allocations can
+ * find the channel. Antenna TX/RX of RX channel 2 is keyed RX2:TX/RX, with an rf_flow_id of USRP_RX2:TX/RX.
+ */
+void USRP_UHD_i::addChannelRFInfo(const std::string& dir, size_t chan, size_t tuner_id, const std::vector<std::string>& antennas) {
+    for (size_t i = 0; i < antennas.size(); i++) {
+        std::ostringstream name;
+        name << dir << chan << ":" << antennas[i];
+        rfinfoPortMappingStruct rf_port_info;
+        rf_port_info.tuner_idx = tuner_id;
+        rf_port_info.antenna = antennas[i];
+        rf_port_info.rfinfo_pkt.rf_center_freq = 50e9; // 50 GHz
+        rf_port_info.rfinfo_pkt.rf_bandwidth = 100e9; // 100 GHz, makes range 0 Hz to 100 GHz
+        rf_port_info.rfinfo_pkt.if_center_freq = 0; // 0 Hz, no up/down converter
+        rf_port_info.rfinfo_pkt.rf_flow_id = "USRP_" + name.str();
+        rf_port_info_map[name.str()] = rf_port_info;
+    }
+}
+
+/* Reads what the device reports for one channel, without changing its settings. Runs on its own thread from
+ * updateDeviceInfo, so it only writes to its arguments, and sets error instead of throwing.
+ */
+void USRP_UHD_i::readChannelInfo(bool tx, size_t chan, usrp_channel_struct& availChan, usrpRangesStruct& ranges, std::string& error) {
+    try {
+        availChan.chan_num = chan;
+        availChan.mb_num = tx ? usrp_device_ptr->get_tx_mboard(chan) : usrp_device_ptr->get_rx_mboard(chan);
+        if (!tx) {
+            availChan.ch_name = usrp_device_ptr->get_rx_subdev_name(chan);
+            availChan.tuner_type = "RX_DIGITIZER";
+            availChan.antenna = usrp_device_ptr->get_rx_antenna(chan);
+            availChan.available_antennas = usrp_device_ptr->get_rx_antennas(chan);
+            // some devices throw if the channel has not been tuned yet, which it is not at init
+            try {
+                availChan.freq_current = usrp_device_ptr->get_rx_freq(chan);
+            } catch(...) {
+                availChan.freq_current = 0.0;
+            }
+            ranges.frequency = usrp_device_ptr->get_rx_freq_range(chan); // this is the CF range, actual range is +/- (sr/2)
+            availChan.bandwidth_current = usrp_device_ptr->get_rx_bandwidth(chan);
+            ranges.bandwidth = usrp_device_ptr->get_rx_bandwidth_range(chan);
+            availChan.rate_current = usrp_device_ptr->get_rx_rate(chan);
+            ranges.sample_rate = usrp_device_ptr->get_rx_rates(chan);
+            availChan.gain_current = usrp_device_ptr->get_rx_gain(chan);
+            ranges.gain = usrp_device_ptr->get_rx_gain_range(chan);
+        } else {
+            availChan.ch_name = usrp_device_ptr->get_tx_subdev_name(chan);
+            availChan.tuner_type = "TX";
+            availChan.antenna = usrp_device_ptr->get_tx_antenna(chan);
+            availChan.available_antennas = usrp_device_ptr->get_tx_antennas(chan);
+            try {
+                availChan.freq_current = usrp_device_ptr->get_tx_freq(chan);
+            } catch(...) {
+                availChan.freq_current = 0.0;
+            }
+            ranges.frequency = usrp_device_ptr->get_tx_freq_range(chan); // this is the CF range, actual range is +/- (sr/2)
+            availChan.bandwidth_current = usrp_device_ptr->get_tx_bandwidth(chan);
+            ranges.bandwidth = usrp_device_ptr->get_tx_bandwidth_range(chan);
+            availChan.rate_current = usrp_device_ptr->get_tx_rate(chan);
+            ranges.sample_rate = usrp_device_ptr->get_tx_rates(chan);
+            availChan.gain_current = usrp_device_ptr->get_tx_gain(chan);
+            ranges.gain = usrp_device_ptr->get_tx_gain_range(chan);
+        }
+        if(availChan.ch_name.find("unknown") != std::string::npos)
+            availChan.tuner_type = "UNKNOWN";
+        availChan.freq_min = ranges.frequency.start();
+        availChan.freq_max = ranges.frequency.stop();
+        availChan.bandwidth_min = ranges.bandwidth.start();
+        availChan.bandwidth_max = ranges.bandwidth.stop();
+        availChan.rate_min = ranges.sample_rate.start();
+        availChan.rate_max = ranges.sample_rate.stop();
+        availChan.gain_min = ranges.gain.start();
+        availChan.gain_max = ranges.gain.stop();
+
+        const char* dir = tx ? "tx" : "rx";
         try{
-            std::vector<double> rates = usrp_device_ptr->get_tx_dboard_iface(chan)->get_clock_rates(uhd::usrp::dboard_iface::UNIT_TX);
+            std::vector<double> rates = tx ? usrp_device_ptr->get_tx_clock_rates(chan) : usrp_device_ptr->get_rx_clock_rates(chan);
             availChan.clock_min = rates.back();
             availChan.clock_max = rates.front();
-            LOG_DEBUG(USRP_UHD_i,"updateDeviceInfo|tx"<<chan<<"|got clock rates ["<<rates.back()<<":"<<rates.front()<<"]");
+            LOG_DEBUG(USRP_UHD_i,"updateDeviceInfo|"<<dir<<chan<<"|got clock rates ["<<rates.back()<<":"<<rates.front()<<"]");
         } catch(...) {
-            LOG_WARN(USRP_UHD_i,"Unable to get clock rates for TX channel " << chan << ", setting to min=0 max=2*rate_max")
+            LOG_WARN(USRP_UHD_i,"Unable to get clock rates for " << (tx ? "TX" : "RX") << " channel " << chan << ", setting to min=0 max=2*rate_max")
             availChan.clock_min = 0;
             availChan.clock_max = 2*availChan.rate_max;
         }
-
-        device_channels.push_back(availChan);
+    } catch (std::exception& e) {
+        error = e.what();
+    } catch (...) {
+        error = "unknown error";
     }
 }
 
-void USRP_UHD_i::updateDeviceRxGain(double gain, bool lock) {
+void USRP_UHD_i::updateDeviceRxGain(double gain) {
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " gain=" << gain);
 
     if (usrp_device_ptr.get() == NULL)
@@ -1500,9 +2972,7 @@ void USRP_UHD_i::updateDeviceRxGain(double gain, bool lock) {
 
     for(size_t tuner_id = 0; tuner_id < frontend_tuner_status.size(); tuner_id++){
         if(frontend_tuner_status[tuner_id].tuner_type == "RX_DIGITIZER"){
-            if (lock) {
-                scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
-            }
+            scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
             usrp_device_ptr->set_rx_gain(gain,frontend_tuner_status[tuner_id].tuner_number);
             frontend_tuner_status[tuner_id].gain = usrp_device_ptr->get_rx_gain(frontend_tuner_status[tuner_id].tuner_number);
             LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << " Updated Gain. New gain is " << frontend_tuner_status[tuner_id].gain);
@@ -1528,46 +2998,577 @@ void USRP_UHD_i::updateDeviceTxGain(double gain) {
     }
 }
 
-void USRP_UHD_i::updateDeviceReferenceSource(std::string source){
+/* acquire prop_lock prior to calling this function
+ * returns true if device time should be set again for the new source (syncDeviceTime). It is not while an RX tuner
+ * is enabled, since its hops, retunes and timed start are pending against the current device time.
+ */
+bool USRP_UHD_i::updateDeviceReferenceSource(std::string source){
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " source=" << source);
 
     if (usrp_device_ptr.get() == NULL)
-        return;
+        return false;
 
     long source_prop = 0;
     if(source != "INTERNAL"){
         source_prop = 1;
     }
+    size_t rx_enabled = 0;
     for(size_t tuner_id = 0; tuner_id < frontend_tuner_status.size(); tuner_id++){
 
         scoped_tuner_lock tuner_lock(usrp_tuners[tuner_id].lock);
         frontend_tuner_status[tuner_id].reference_source = source_prop;
+        if (frontend_tuner_status[tuner_id].tuner_type == "RX_DIGITIZER" &&
+                (frontend_tuner_status[tuner_id].enabled || usrp_tuners[tuner_id].start.state != usrpStartStruct::IDLE))
+            rx_enabled++;
     }
 
-    // TODO - disable enabled tuners first? stop/restart device? get prop_lock? ...
+    // a single motherboard is the MIMO cable slave of another device. When several are combined, the first
+    // is the master and the others follow it over the cable.
+    const size_t num_mboards = usrp_device_ptr->get_num_mboards();
+    for (size_t mboard = 0; mboard < num_mboards; mboard++) {
+        if (source == "MIMO" && (num_mboards == 1 || mboard > 0)) {
+            usrp_device_ptr->set_clock_source("MIMO",mboard);
+            usrp_device_ptr->set_time_source("MIMO",mboard);
+        } else if (source == "EXTERNAL") {
+            usrp_device_ptr->set_clock_source("external",mboard);
+            usrp_device_ptr->set_time_source("external",mboard);
+        } else if (source == "INTERNAL" || source == "MIMO") {
+            usrp_device_ptr->set_clock_source("internal",mboard);
+            usrp_device_ptr->set_time_source("external",mboard);
+        }
+    }
 
-    if (source == "MIMO") {
-        usrp_device_ptr->set_clock_source("MIMO",0);
-        usrp_device_ptr->set_time_source("MIMO",0);
-    } else if (source == "EXTERNAL") {
-        usrp_device_ptr->set_clock_source("external",0);
-        usrp_device_ptr->set_time_source("external",0);
-    } else if (source == "INTERNAL") {
-        usrp_device_ptr->set_clock_source("internal",0);
-        usrp_device_ptr->set_time_source("external",0);
+    if (rx_enabled > 0) {
+        LOG_WARN(USRP_UHD_i,"updateDeviceReferenceSource|" << rx_enabled << " RX tuner(s) enabled, so device time is not set again for source "
+                           << source << ". Disable them and set device_reference_source_global again to resynchronize.");
+        time_sync_status.synchronized = false;
+        time_sync_status.detail = "not resynchronized to " + source + " while RX tuners are enabled";
+        return false;
     }
+    return true;
 }
 
-/* acquire tuner_lock prior to calling this function *
- * this function will block up to "timeout" seconds
+/* acquire time_sync_lock, but not prop_lock, prior to calling this function
+ * sets the time of the current device for device_reference_source_global, and updates time_sync_status
+ */
+void USRP_UHD_i::syncCurrentDeviceTime(){
+    usrpBackend::sptr device;
+    bool pps = false;
+    { // scope for prop_lock
+        exclusive_lock lock(prop_lock);
+        device = usrp_device_ptr;
+        pps = device_reference_source_global == "EXTERNAL" || device_reference_source_global == "MIMO";
+    } // end scope for prop_lock
+    if (device.get() == NULL)
+        return;
+
+    const time_sync_status_struct status = syncDeviceTime(device, pps);
+
+    exclusive_lock lock(prop_lock);
+    if (usrp_device_ptr == device)
+        time_sync_status = status;
+}
+
+/* sets the time of every motherboard of device, and returns the resulting time_sync_status. With a PPS, it first
+ * waits for an edge, so the time of the next edge reaches every motherboard well before it, and then reads back
+ * the time each one latched at that edge. Blocks for up to 2.2 s, so is called without prop_lock once the device
+ * is running. Without a PPS, device time is set from host time.
+ */
+time_sync_status_struct USRP_UHD_i::syncDeviceTime(usrpBackend::sptr device, bool pps){
+    time_sync_status_struct status;
+    if (device.get() == NULL)
+        return status;
+    const size_t num_mboards = device->get_num_mboards();
+    status.num_mboards = num_mboards;
+
+    if (pps) {
+        status.method = "pps";
+        const boost::posix_time::milliseconds pps_timeout(1100);
+
+        const double last_pps = device->get_time_last_pps().get_real_secs();
+        boost::system_time deadline = boost::get_system_time() + pps_timeout;
+        while (device->get_time_last_pps().get_real_secs() == last_pps && boost::get_system_time() < deadline)
+            usleep(1000);
+
+        if (device->get_time_last_pps().get_real_secs() == last_pps) {
+            status.detail = "no PPS detected";
+        } else {
+            // the edge just seen is at the nearest whole second of host time, if the host is within 0.5 s of it
+            const time_t next_pps = time_t(floor(hostTime().get_real_secs() + 0.5)) + 1;
+            device->set_time_next_pps(uhd::time_spec_t(next_pps, 0.0));
+
+            deadline = boost::get_system_time() + pps_timeout;
+            while (device->get_time_last_pps().get_full_secs() != next_pps && boost::get_system_time() < deadline)
+                usleep(1000);
+
+            status.synchronized = true;
+            for (size_t mboard = 0; mboard < num_mboards; mboard++) {
+                const uhd::time_spec_t latched = device->get_time_last_pps(mboard);
+                if (latched.get_full_secs() != next_pps || latched.get_frac_secs() != 0.0) {
+                    std::ostringstream detail;
+                    detail << "motherboard " << mboard << " latched " << std::fixed << latched.get_real_secs() << " instead of " << next_pps;
+                    status.detail = detail.str();
+                    status.synchronized = false;
+                    break;
+                }
+            }
+        }
+        if (status.synchronized) {
+            LOG_INFO(USRP_UHD_i,"syncDeviceTime|device time of " << num_mboards << " motherboard(s) latched on PPS");
+        } else {
+            LOG_WARN(USRP_UHD_i,"syncDeviceTime|could not synchronize device time on PPS, " << status.detail << ". Setting it from host time.");
+        }
+    }
+
+    if (!status.synchronized) {
+        device->set_time_now(hostTime());
+        if (!pps) {
+            status.method = "host";
+            if (num_mboards > 1)
+                status.detail = "motherboards are set from host time one at a time, so are not aligned";
+        }
+    }
+    status.host_offset_ms = device->get_time_now().get_real_secs()*1e3 - hostTime().get_real_secs()*1e3;
+    return status;
+}
+
+/* acquire tuner's lock prior to calling this function */
+void USRP_UHD_i::pushRxBuffer(size_t tuner_id){
+    LOG_DEBUG(USRP_UHD_i,"pushRxBuffer|pushing buffer of " << usrp_tuners[tuner_id].buffer_size/2 << " samples");
+
+    // a scanning tuner measures its samps instead
+    if (usrp_tuners[tuner_id].scan.active) {
+        scanRxBuffer(tuner_id);
+        usrp_tuners[tuner_id].hops.push = false;
+        return;
+    }
+
+    // get stream id (creates one if not already created for this tuner)
+    std::string stream_id = getStreamId(tuner_id);
+
+    // low latency tuners push on their own thread rather than hand off to the push thread, so the push has been
+    // made by the time this returns (unless blocks of the stream queued before low latency mode are still pending)
+    const bool direct = usrp_tuners[tuner_id].low_latency.enabled;
+
+    // Send updated SRI
+    if (usrp_tuners[tuner_id].update_sri){
+        LOG_DEBUG(USRP_UHD_i,"USRP_UHD_i::pushRxBuffer|creating SRI for tuner: "<<tuner_id<<" with stream id: "<< stream_id);
+        BULKIO::StreamSRI sri = create(stream_id, frontend_tuner_status[tuner_id]);
+        sri.mode = 1; // complex
+        //printSRI(&sri,"USRP_UHD_i::pushRxBuffer SRI"); // DEBUG
+        short_push_queue->pushSRI(sri, direct);
+        dataSDDS_out->pushSRI(sri);
+        usrp_tuners[tuner_id].update_sri = false;
+        usrp_tuners[tuner_id].shm.sri_changed = true;
+        TRACE_EVENT(TRACE_SRI_CHANGE, tuner_id, 0, 0);
+    }
+
+    resampleRxBuffer(tuner_id);
+
+    // Pushing Data
+    // handle partial packet (b/c overflow occured, latency bound reached, or low latency mode)
+    TRACE_EVENT(TRACE_PUSH_START, tuner_id, usrp_tuners[tuner_id].buffer_size, 0);
+    std::vector<short> *push_buffer = &rxPushBuffer(tuner_id);
+    // Only push on active ports
+    // the push and its recv_to_push latency are recorded by whichever thread makes it (see pushStreamMetrics)
+    if(dataShort_out->isActive()){
+        short_push_queue->pushPacket(*push_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id, usrp_tuners[tuner_id].recv_end_ns, direct);
+    }
+    // Don't check isActive because could be relying on attach override rather than a connection
+    // It doesn't actually do anything if the tuner/stream isn't configured for sdds already anyway
+    const uint64_t sdds_push_start = hotPathNow();
+    dataSDDS_out->pushPacket(*push_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
+    usrp_tuners[tuner_id].metrics.sdds_push.record(sdds_push_start);
+    publishRxBuffer(tuner_id, false, stream_id);
+    TRACE_EVENT(TRACE_PUSH_END, tuner_id, 0, 0);
+    usrp_tuners[tuner_id].buffer_size = 0;
+    usrp_tuners[tuner_id].hops.push = false;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * the buffer_size samps of output_buffer, as a buffer of that size for pushPacket. A partial buffer is copied to
+ * partial_buffer rather than resizing output_buffer, since growing it back to capacity zero fills it
+ */
+std::vector<short>& USRP_UHD_i::rxPushBuffer(size_t tuner_id){
+    if (usrp_tuners[tuner_id].buffer_size >= usrp_tuners[tuner_id].buffer_capacity)
+        return usrp_tuners[tuner_id].output_buffer;
+    usrp_tuners[tuner_id].partial_buffer.assign(usrp_tuners[tuner_id].output_buffer.begin(),
+            usrp_tuners[tuner_id].output_buffer.begin()+usrp_tuners[tuner_id].buffer_size);
+    return usrp_tuners[tuner_id].partial_buffer;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * rate of the samps received into the output buffer, which is not the tuner's output rate while resampling
+ */
+double USRP_UHD_i::rxSampleRate(size_t tuner_id){
+    if (usrp_tuners[tuner_id].resample.active)
+        return usrp_tuners[tuner_id].resample.in_rate;
+    return frontend_tuner_status[tuner_id].sample_rate;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * replaces the samps in the output buffer with the resampled samps, and output_buffer_time with the time of the
+ * first of those. The filter is restarted if the buffer does not follow on from the previous one.
+ */
+void USRP_UHD_i::resampleRxBuffer(size_t tuner_id){
+    usrpResampleStruct &rs = usrp_tuners[tuner_id].resample;
+    if (!rs.active || usrp_tuners[tuner_id].buffer_size == 0)
+        return;
+
+    const size_t num_samps = usrp_tuners[tuner_id].buffer_size/2;
+    BULKIO::PrecisionUTCTime &time = usrp_tuners[tuner_id].output_buffer_time;
+    const double start_time = time.twsec + time.tfsec;
+    if (rs.next_time < 0.0 || fabs(start_time-rs.next_time)*rs.in_rate > 0.5) {
+        if (rs.next_time >= 0.0)
+            LOG_DEBUG(USRP_UHD_i,"resampleRxBuffer|tuner_id=" << tuner_id << " restarting filter after a gap of "
+                                 << (start_time-rs.next_time)*rs.in_rate << " samps");
+        rs.filter.reset();
+    }
+    rs.next_time = start_time + num_samps/rs.in_rate;
+
+    // the output is never longer than the input, so it is written over it
+    const double offset = rs.filter.nextOutputOffset()/rs.in_rate;
+    const size_t num_out = rs.filter.process(&usrp_tuners[tuner_id].output_buffer[0], num_samps, &usrp_tuners[tuner_id].output_buffer[0]);
+    usrp_tuners[tuner_id].buffer_size = num_out*2;
+    time.tfsec += offset;
+    const double whole = floor(time.tfsec);
+    time.twsec += whole;
+    time.tfsec -= whole;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * applies shm_output as cached at allocation. The ring is kept if it has the same name, slots and block size.
+ */
+void USRP_UHD_i::setShmOutput(size_t tuner_id, const shm_output_struct& settings){
+    usrpShmStruct &shm = usrp_tuners[tuner_id].shm;
+    shm.enabled = false;
+    shm.sri_changed = true;
+    if (!settings.enable) {
+        if (shm.ring)
+            LOG_DEBUG(USRP_UHD_i,"setShmOutput|tuner_id=" << tuner_id << " removing ring " << shm.ring->name());
+        shm.ring.reset();
+        return;
+    }
+
+    std::ostringstream name;
+    name << settings.name_prefix << "_" << tuner_id;
+    const size_t num_slots = std::max(settings.num_slots, (unsigned short) 2);
+    const size_t max_samples = usrp_tuners[tuner_id].buffer_capacity;
+    if (!shm.ring || shm.ring->name() != name.str() || shm.ring->numSlots() != num_slots || shm.ring->maxSamples() != max_samples) {
+        shm.ring.reset(new shmRingWriter());
+        if (!shm.ring->create(name.str(), num_slots, max_samples)) {
+            LOG_WARN(USRP_UHD_i,"setShmOutput|tuner_id=" << tuner_id << " shared memory output disabled, " << shm.ring->error());
+            shm.ring.reset();
+            return;
+        }
+        LOG_INFO(USRP_UHD_i,"setShmOutput|tuner_id=" << tuner_id << " publishing to " << name.str() << ", "
+                            << num_slots << " blocks of " << max_samples << " shorts");
+    }
+    shm.enabled = true;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * publishes the output buffer (once resampled) to the tuner's shared memory ring, if enabled,
+ * stamped with output_buffer_time and the tuner's current SRI values
+ */
+void USRP_UHD_i::publishRxBuffer(size_t tuner_id, bool eos, const std::string& stream_id){
+    usrpShmStruct &shm = usrp_tuners[tuner_id].shm;
+    if (!shm.enabled || !shm.ring)
+        return;
+    const frontend_tuner_status_struct_struct &fts = frontend_tuner_status[tuner_id];
+    const BULKIO::PrecisionUTCTime &T = usrp_tuners[tuner_id].output_buffer_time;
+
+    shmRingBlock *block = shm.ring->begin();
+    // the output buffer is never larger than the ring's blocks, which are sized to its capacity
+    block->num_samples = std::min(usrp_tuners[tuner_id].buffer_size, shm.ring->maxSamples());
+    block->flags = (eos ? SHM_RING_EOS : 0) | (shm.sri_changed ? SHM_RING_SRI_CHANGED : 0);
+    block->tuner_id = tuner_id;
+    block->mode = 1; // complex
+    block->tcmode = T.tcmode;
+    block->tcstatus = T.tcstatus;
+    block->toff = T.toff;
+    block->twsec = T.twsec;
+    block->tfsec = T.tfsec;
+    block->xdelta = fts.sample_rate > 0.0 ? 1.0/fts.sample_rate : 0.0;
+    block->center_frequency = fts.center_frequency;
+    block->bandwidth = fts.bandwidth;
+    strncpy(block->stream_id, stream_id.c_str(), sizeof(block->stream_id)-1);
+    block->stream_id[sizeof(block->stream_id)-1] = '\0';
+    if (block->num_samples > 0)
+        memcpy(block->samples(), &usrp_tuners[tuner_id].output_buffer[0], block->num_samples*sizeof(short));
+    shm.ring->commit();
+    shm.sri_changed = false;
+}
+
+/* acquire tuner's lock prior to calling this function
+ * measures the num_samps most recently received into the output buffer in a single pass,
+ * for both the signal statistics and the AGC window
+ */
+void USRP_UHD_i::measureRx(size_t tuner_id, size_t num_samps){
+    usrpSignalStatsStruct &ss = usrp_tuners[tuner_id].signal_stats;
+    usrpAgcStruct &agc = usrp_tuners[tuner_id].agc;
+    const bool measure_agc = agc.active() && !agc.ready;
+    const bool measure_stats = ss.period > 0.0;
+    if (num_samps == 0 || !(measure_agc || measure_stats))
+        return;
+
+    const short *data = &usrp_tuners[tuner_id].output_buffer[usrp_tuners[tuner_id].buffer_size-num_samps*2];
+    size_t len = num_samps*2;
+    while (len > 0) {
+        // measure up to the end of the current block
+        const size_t n = std::min(len, usrpSignalStatsStruct::block_len-ss.block.num_values);
+        sampleStats chunk;
+        chunk.accumulate(data, n, ss.clip_level);
+        if (measure_agc)
+            agc.stats.merge(chunk);
+        if (measure_stats) {
+            ss.block.merge(chunk);
+            if (ss.block.num_values >= usrpSignalStatsStruct::block_len) {
+                const double power = ss.block.sum_sq/(ss.block.num_values/2);
+                if (ss.min_block_power < 0.0 || power < ss.min_block_power)
+                    ss.min_block_power = power;
+                ss.window.merge(ss.block);
+                ss.block.reset();
+            }
+        }
+        data += n;
+        len -= n;
+    }
+
+    if (measure_agc) {
+        // window is update_period worth of samps, but no less than 250 complex samps
+        const size_t window = std::max(size_t(agc.update_period*rxSampleRate(tuner_id)), size_t(250))*2;
+        if (agc.stats.num_values >= window)
+            agc.ready = true;
+    }
+
+    if (measure_stats && (boost::get_system_time() - ss.window_start).total_microseconds() >= long(ss.period*1e6))
+        updateSignalStats(tuner_id);
+}
+
+/* acquire tuner's lock prior to calling this function
+ * prop_lock is only tried, as in updateLowLatencyMetrics, so a busy prop_lock extends the period
+ */
+void USRP_UHD_i::updateSignalStats(size_t tuner_id){
+    boost::mutex::scoped_try_lock lock(prop_lock);
+    if (!lock.owns_lock())
+        return;
+
+    usrpSignalStatsStruct &ss = usrp_tuners[tuner_id].signal_stats;
+    ss.window.merge(ss.block);
+    if (ss.window.num_values == 0) {
+        ss.reset();
+        return;
+    }
+
+    const double full_scale = double(ss.clip_level)+1.0;
+    const double num_samps = ss.window.num_values/2;
+    const double power = std::max(ss.window.sum_sq/num_samps, 1.0);
+    const double noise_floor = (ss.min_block_power < 0.0) ? power : std::max(ss.min_block_power, 1.0);
+
+    size_t i = 0;
+    for (; i < tuner_signal_stats.size(); i++) {
+        if (tuner_signal_stats[i].tuner_index == tuner_id)
+            break;
+    }
+    if (i == tuner_signal_stats.size())
+        tuner_signal_stats.resize(i+1);
+    tuner_signal_stats[i].tuner_index = tuner_id;
+    tuner_signal_stats[i].allocation_id = getControlAllocationId(tuner_id);
+    tuner_signal_stats[i].num_samps = CORBA::ULong(num_samps);
+    tuner_signal_stats[i].power_dbfs = 10.0*log10(power/(full_scale*full_scale));
+    tuner_signal_stats[i].peak_dbfs = 20.0*log10(std::max(double(ss.window.peak), 1.0)/full_scale);
+    tuner_signal_stats[i].clip_rate = double(ss.window.clipped)/ss.window.num_values;
+    tuner_signal_stats[i].noise_floor_dbfs = 10.0*log10(noise_floor/(full_scale*full_scale));
+
+    ss.reset();
+}
+
+/* acquire prop_lock prior to calling this function
+ * tuner counters are read without the tuner's lock (see hotPathCounter)
+ */
+void USRP_UHD_i::updateHotPathMetrics(){
+    hot_path_metrics.clear();
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (getControlAllocationId(tuner_id).empty())
+            continue;
+
+        const tunerHotPathMetrics &m = usrp_tuners[tuner_id].metrics;
+        hot_path_metric_struct entry;
+        entry.tuner_index = tuner_id;
+        entry.tuner_type = frontend_tuner_status[tuner_id].tuner_type;
+        entry.samps = m.samps.get();
+        entry.recv_calls = m.recv_calls.get();
+        entry.overflows = m.overflows.get();
+        entry.timeouts = m.timeouts.get();
+        entry.recv_errors = m.recv_errors.get();
+        hotPathStage short_push;
+        latencySummary recv_to_push;
+        const std::string &stream_id = frontend_tuner_status[tuner_id].stream_id;
+        if (!stream_id.empty())
+            short_push_queue->getStreamMetrics(stream_id, short_push, recv_to_push);
+        entry.short_pushes = short_push.calls.get();
+        entry.short_push_avg_us = (entry.short_pushes > 0) ? short_push.total_ns.get()/1e3/entry.short_pushes : 0.0;
+        entry.short_push_max_us = short_push.max_ns.get()/1e3;
+        entry.sdds_pushes = m.sdds_push.calls.get();
+        entry.sdds_push_avg_us = (entry.sdds_pushes > 0) ? m.sdds_push.total_ns.get()/1e3/entry.sdds_pushes : 0.0;
+        entry.sdds_push_max_us = m.sdds_push.max_ns.get()/1e3;
+        entry.send_calls = m.send_calls.get();
+        entry.short_sends = m.short_sends.get();
+
+        sddsHotPathMetrics sdds;
+        size_t queue_high_water = 0;
+        if (!stream_id.empty() && dataSDDS_out->getStreamMetrics(stream_id, sdds, queue_high_water)) {
+            entry.sdds_packets = sdds.packets.get();
+            entry.sdds_bytes = sdds.bytes.get();
+            entry.sdds_send_errors = sdds.send_errors.get();
+            entry.sdds_dropped_samps = sdds.dropped_samps.get();
+        } else {
+            entry.sdds_packets = entry.sdds_bytes = entry.sdds_send_errors = entry.sdds_dropped_samps = 0;
+        }
+        entry.sdds_queue_high_water = queue_high_water;
+
+        hot_path_metrics.push_back(entry);
+    }
+}
+
+/* acquire prop_lock prior to calling this function
+ * queue counters are read without the queue's lock (see pushQueueMetrics)
+ */
+void USRP_UHD_i::updatePushQueueMetrics(){
+    push_queue_metrics.clear();
+    const pushQueueMetrics &m = short_push_queue->getMetrics();
+    push_queue_metric_struct entry;
+    entry.port = "dataShort_out";
+    entry.async = short_push_queue->isAsync();
+    entry.blocks = short_push_queue->size();
+    entry.high_water = m.high_water.get();
+    entry.queued = m.queued.get();
+    entry.pushes = m.push.calls.get();
+    entry.push_avg_us = (entry.pushes > 0) ? m.push.total_ns.get()/1e3/entry.pushes : 0.0;
+    entry.push_max_us = m.push.max_ns.get()/1e3;
+    entry.dropped_blocks = m.dropped_blocks.get();
+    entry.dropped_samps = m.dropped_samps.get();
+    entry.blocked = m.blocked.get();
+    entry.blocked_ms = m.blocked_ns.get()/1e6;
+    push_queue_metrics.push_back(entry);
+}
+
+/* max_blocks and overflow_policy of the push queue */
+void USRP_UHD_i::configurePushQueues(const rx_push_queue_struct& settings){
+    pushOverflowPolicy policy = PUSH_DROP_OLDEST;
+    if (settings.overflow_policy == "block")
+        policy = PUSH_BLOCK;
+    else if (settings.overflow_policy == "drop_newest")
+        policy = PUSH_DROP_NEWEST;
+    else if (settings.overflow_policy != "drop_oldest")
+        LOG_WARN(USRP_UHD_i,"configurePushQueues|unknown overflow_policy " << settings.overflow_policy << ", using drop_oldest");
+    short_push_queue->configure(settings.max_blocks, policy);
+}
+
+/* acquire prop_lock prior to calling this function
+ * histograms are read without the tuner's lock (see latencyHistogram)
+ */
+void USRP_UHD_i::updateLatencyHistograms(){
+    latency_histograms.clear();
+    for (size_t tuner_id = 0; tuner_id < usrp_tuners.size(); tuner_id++) {
+        if (getControlAllocationId(tuner_id).empty() || frontend_tuner_status[tuner_id].tuner_type != "RX_DIGITIZER")
+            continue;
+
+        std::vector<std::pair<std::string, latencySummary> > stages;
+        stages.push_back(std::make_pair(std::string("device_to_recv"), usrp_tuners[tuner_id].device_to_recv.summarize()));
+        const std::string &stream_id = frontend_tuner_status[tuner_id].stream_id;
+        hotPathStage short_push;
+        latencySummary recv_to_push;
+        if (!stream_id.empty())
+            short_push_queue->getStreamMetrics(stream_id, short_push, recv_to_push);
+        stages.push_back(std::make_pair(std::string("recv_to_push"), recv_to_push));
+        latencySummary sdds;
+        if (!stream_id.empty() && dataSDDS_out->getStreamLatency(stream_id, sdds))
+            stages.push_back(std::make_pair(std::string("sdds_input_to_send"), sdds));
+
+        for (size_t i = 0; i < stages.size(); i++) {
+            latency_histogram_struct entry;
+            entry.tuner_index = tuner_id;
+            entry.stage = stages[i].first;
+            entry.count = stages[i].second.count;
+            entry.p50_us = stages[i].second.p50/1e3;
+            entry.p90_us = stages[i].second.p90/1e3;
+            entry.p99_us = stages[i].second.p99/1e3;
+            entry.p999_us = stages[i].second.p999/1e3;
+            entry.max_us = stages[i].second.max/1e3;
+            latency_histograms.push_back(entry);
+        }
+    }
+}
+
+/* writes a text snapshot of metrics, one line per tuner, to path
+ * a file is replaced each time, so readers never see a partial snapshot
+ * unix:<socket path> sends the snapshot as a single datagram, and is dropped if there is no reader
+ */
+void USRP_UHD_i::dumpHotPathMetrics(const std::string& path, const std::vector<hot_path_metric_struct>& metrics){
+    BULKIO::PrecisionUTCTime now = bulkio::time::utils::now();
+    std::ostringstream out;
+    for (size_t i = 0; i < metrics.size(); i++) {
+        const hot_path_metric_struct &m = metrics[i];
+        out << std::fixed << "time=" << now.twsec+now.tfsec
+            << " tuner_index=" << m.tuner_index << " tuner_type=" << m.tuner_type
+            << " samps=" << m.samps << " recv_calls=" << m.recv_calls << " overflows=" << m.overflows
+            << " timeouts=" << m.timeouts << " recv_errors=" << m.recv_errors
+            << " short_pushes=" << m.short_pushes << " short_push_avg_us=" << m.short_push_avg_us << " short_push_max_us=" << m.short_push_max_us
+            << " sdds_pushes=" << m.sdds_pushes << " sdds_push_avg_us=" << m.sdds_push_avg_us << " sdds_push_max_us=" << m.sdds_push_max_us
+            << " sdds_packets=" << m.sdds_packets << " sdds_bytes=" << m.sdds_bytes << " sdds_send_errors=" << m.sdds_send_errors
+            << " sdds_dropped_samps=" << m.sdds_dropped_samps << " sdds_queue_high_water=" << m.sdds_queue_high_water
+            << " send_calls=" << m.send_calls << " short_sends=" << m.short_sends << "\n";
+    }
+    const std::string snapshot = out.str();
+
+    if (path.compare(0, 5, "unix:") == 0) {
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str()+5, sizeof(addr.sun_path)-1);
+        int sock = socket(AF_UNIX, SOCK_DGRAM, 0);
+        if (sock < 0 || sendto(sock, snapshot.data(), snapshot.size(), MSG_DONTWAIT, (struct sockaddr*) &addr, sizeof(addr)) < 0) {
+            LOG_DEBUG(USRP_UHD_i,"dumpHotPathMetrics|could not send metrics to " << path << ": " << strerror(errno));
+        }
+        if (sock >= 0)
+            close(sock);
+        return;
+    }
+
+    const std::string tmp_path = path+".tmp";
+    std::ofstream file(tmp_path.c_str(), std::ios::out | std::ios::trunc);
+    file << snapshot;
+    file.close();
+    if (file.fail() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        LOG_WARN(USRP_UHD_i,"dumpHotPathMetrics|could not write metrics to " << path);
+    }
+}
+
+/* acquire tuner's lock prior to calling this function
+ * one_packet receives at most a single device packet and passes timeout to recv, where a timeout is not an error
+ * otherwise timeout bounds the num samps to receive
  */
-long USRP_UHD_i::usrpReceive(size_t tuner_id, double timeout){
+long USRP_UHD_i::usrpReceive(size_t tuner_id, double timeout, bool one_packet){
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " tuner_id=" << tuner_id);
 
-    // calc num samps to rx based on timeout, sr, and buffer size
-    size_t samps_to_rx = size_t((usrp_tuners[tuner_id].buffer_capacity-usrp_tuners[tuner_id].buffer_size) / 2);
-    if( timeout > 0 ){
-        samps_to_rx = std::min(samps_to_rx, size_t(timeout*frontend_tuner_status[tuner_id].sample_rate));
+    // calc num samps to rx based on timeout, sr, and push size (full buffer unless latency bound is set)
+    const size_t push_size = usrp_tuners[tuner_id].push_size(rxSampleRate(tuner_id));
+    if (usrp_tuners[tuner_id].buffer_size >= push_size)
+        return 0; // sample rate or latency bound decreased, buffer is ready to push as is
+    usrpHopStruct &hops = usrp_tuners[tuner_id].hops;
+    if (hops.push)
+        return 0; // a hop takes effect at the next samp, buffer is ready to push as is
+    size_t samps_to_rx = size_t((push_size-usrp_tuners[tuner_id].buffer_size) / 2);
+    if( timeout > 0 && !one_packet ){
+        samps_to_rx = std::min(samps_to_rx, size_t(timeout*rxSampleRate(tuner_id)));
+    }
+    // while hops wait to be sent, receive no further than the last hop sent, so the next are sent in time
+    if (hops.next < hops.schedule.size() && !hops.pending.empty()) {
+        const double samps_to_hop = (hops.pending.back().time-hops.stream_time).get_real_secs()*rxSampleRate(tuner_id);
+        if (samps_to_hop >= 1.0)
+            samps_to_rx = std::min(samps_to_rx, size_t(samps_to_hop));
     }
 
     uhd::rx_metadata_t _metadata;
@@ -1578,38 +3579,86 @@ long USRP_UHD_i::usrpReceive(size_t tuner_id, double timeout){
     }
 
     size_t num_samps = 0;
-    try{
-        num_samps = usrp_rx_streamers[frontend_tuner_status[tuner_id].tuner_number]->recv(
-            &usrp_tuners[tuner_id].output_buffer.at(usrp_tuners[tuner_id].buffer_size), // address of buffer to start filling data
-            samps_to_rx,
-            _metadata);
-    } catch(...){
-        LOG_ERROR(USRP_UHD_i,"usrpReceive|uhd::rx_streamer->recv() threw unknown exception");
-        return 0;
+    const bool held = !hops.held.empty();
+    if (held) {
+        // samps from a hop on, held while the samps before it were pushed
+        std::copy(hops.held.begin(), hops.held.end(), usrp_tuners[tuner_id].output_buffer.begin()+usrp_tuners[tuner_id].buffer_size);
+        num_samps = hops.held.size()/2;
+        _metadata.error_code = uhd::rx_metadata_t::ERROR_CODE_NONE;
+        _metadata.time_spec = hops.held_time;
+        hops.held.clear();
+        usrp_tuners[tuner_id].buffer_size += (num_samps*2);
+    } else {
+        TRACE_EVENT(TRACE_RECV_START, tuner_id, samps_to_rx, 0);
+        try{
+            if (one_packet) {
+                num_samps = usrp_rx_streamers[frontend_tuner_status[tuner_id].tuner_number]->recv(
+                    &usrp_tuners[tuner_id].output_buffer.at(usrp_tuners[tuner_id].buffer_size), // address of buffer to start filling data
+                    samps_to_rx,
+                    _metadata,
+                    timeout,
+                    true);
+            } else {
+                num_samps = usrp_rx_streamers[frontend_tuner_status[tuner_id].tuner_number]->recv(
+                    &usrp_tuners[tuner_id].output_buffer.at(usrp_tuners[tuner_id].buffer_size), // address of buffer to start filling data
+                    samps_to_rx,
+                    _metadata);
+            }
+        } catch(...){
+            usrp_tuners[tuner_id].metrics.recv_errors.add();
+            LOG_ERROR(USRP_UHD_i,"usrpReceive|uhd::rx_streamer->recv() threw unknown exception");
+            return 0;
+        }
+        TRACE_EVENT(TRACE_RECV_END, tuner_id, num_samps, _metadata.error_code);
+        LOG_TRACE(USRP_UHD_i,"usrpReceive|tuner_id=" << tuner_id << " num_samps=" << num_samps);
+        usrp_tuners[tuner_id].buffer_size += (num_samps*2);
+        usrp_tuners[tuner_id].metrics.recv_calls.add();
+        usrp_tuners[tuner_id].metrics.samps.add(num_samps);
     }
-    LOG_TRACE(USRP_UHD_i,"usrpReceive|tuner_id=" << tuner_id << " num_samps=" << num_samps);
-    usrp_tuners[tuner_id].buffer_size += (num_samps*2);
 
     //handle possible errors conditions
     switch (_metadata.error_code) {
         case uhd::rx_metadata_t::ERROR_CODE_NONE:
             break;
         case uhd::rx_metadata_t::ERROR_CODE_TIMEOUT:
+            if (one_packet)
+                return 0; // polling, no packet ready yet
+            usrp_tuners[tuner_id].metrics.timeouts.add();
             LOG_WARN(USRP_UHD_i,"WARNING: TIMEOUT OCCURED ON USRP RECEIVE! (received num_samps=" << num_samps << " try disable/enable)");
             usrpDisable(tuner_id);
             usleep(1000);
             usrpEnable(tuner_id);
             return 0;
+        case uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND:
+            usrp_tuners[tuner_id].metrics.recv_errors.add();
+            LOG_WARN(USRP_UHD_i,"WARNING: USRP STREAM START WAS LATE! (starting now, consider increasing rx_enable start_delay_ms)");
+            usrpStartStream(tuner_id, true, uhd::time_spec_t());
+            return 0;
         case uhd::rx_metadata_t::ERROR_CODE_OVERFLOW:
+            usrp_tuners[tuner_id].metrics.overflows.add();
+            eventTrace::overflow(tuner_id);
             LOG_WARN(USRP_UHD_i,"WARNING: USRP OVERFLOW DETECTED!");
             // may have received data, but 0 is returned by usrp recv function so we don't know how many samples, must throw away
             return -1; // this will just cause us to return NORMAL so there's no wait before next iteration
         default:
+            usrp_tuners[tuner_id].metrics.recv_errors.add();
             LOG_WARN(USRP_UHD_i,"WARNING: UHD source block got error code 0x" << _metadata.error_code);
             return 0;
     }
     LOG_TRACE(USRP_UHD_i,"usrpReceive|tuner_id=" << tuner_id << " after error switch");
 
+    if (num_samps > 0 && usrp_tuners[tuner_id].start.state == usrpStartStruct::STARTED) {
+        usrp_tuners[tuner_id].start.state = usrpStartStruct::STREAMING;
+        frontend_tuner_status[tuner_id].status = "enabled";
+        LOG_DEBUG(USRP_UHD_i,"usrpReceive|tuner_id=" << tuner_id << " first samps received "
+                            << (boost::get_system_time() - usrp_tuners[tuner_id].start.requested).total_microseconds() << " us after enable");
+    }
+
+    if (num_samps > 0 && !held && hops.next < hops.schedule.size())
+        queueHops(tuner_id, _metadata.time_spec + uhd::time_spec_t::from_ticks(num_samps, rxSampleRate(tuner_id)));
+    if (num_samps > 0 && !hops.pending.empty())
+        num_samps = splitAtHop(tuner_id, _metadata.time_spec, num_samps);
+
     if(num_samps == 0)
         return 0;
 
@@ -1619,6 +3668,9 @@ long USRP_UHD_i::usrpReceive(size_t tuner_id, double timeout){
 
     // if first samples in buffer, update timestamps
     if(num_samps*2 == usrp_tuners[tuner_id].buffer_size){
+        // back date host time by duration of samps received so it reflects the oldest samp
+        usrp_tuners[tuner_id].buffer_start = boost::get_system_time() -
+                boost::posix_time::microseconds(long(num_samps*1e6/rxSampleRate(tuner_id)));
         usrp_tuners[tuner_id].output_buffer_time = bulkio::time::utils::now();
         usrp_tuners[tuner_id].output_buffer_time.twsec = (double)_metadata.time_spec.get_full_secs();
         usrp_tuners[tuner_id].output_buffer_time.tfsec = _metadata.time_spec.get_frac_secs();
@@ -1627,6 +3679,17 @@ long USRP_UHD_i::usrpReceive(size_t tuner_id, double timeout){
         usrp_tuners[tuner_id].time_down = usrp_tuners[tuner_id].output_buffer_time;
     }
 
+    // device time of last samp received to now, device time is set from host time in initUsrp
+    if (!held) {
+        BULKIO::PrecisionUTCTime now = bulkio::time::utils::now();
+        const double recv_latency = (now.twsec-_metadata.time_spec.get_full_secs()) + (now.tfsec-_metadata.time_spec.get_frac_secs()) -
+                (num_samps-1)/rxSampleRate(tuner_id);
+        usrp_tuners[tuner_id].device_to_recv.record(int64_t(recv_latency*1e9));
+    }
+
+    measureRx(tuner_id, num_samps);
+
+    usrp_tuners[tuner_id].recv_end_ns = hotPathNow();
     return num_samps;
 }
 
@@ -1637,12 +3700,7 @@ template <class PACKET_TYPE> bool USRP_UHD_i::usrpTransmit(size_t tuner_id, PACK
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__);
     if(usrp_tuners[tuner_id].update_sri){
 
-        str2rfinfo_map_t::iterator it=rf_port_info_map.begin();
-        for (; it!=rf_port_info_map.end(); it++) {
-            if (it->second.tuner_idx == tuner_id && it->second.antenna == frontend_tuner_status[tuner_id].antenna) {
-                break;
-            }
-        }
+        str2rfinfo_map_t::iterator it=findRFInfoPort(tuner_id, frontend_tuner_status[tuner_id].antenna);
         if (it==rf_port_info_map.end()) {
             LOG_ERROR(USRP_UHD_i,"usrpTransmit|tuner_id=" << tuner_id << "No matching RFInfo port found!! Failed transmit.");
             return false;
@@ -1676,7 +3734,12 @@ template <class PACKET_TYPE> bool USRP_UHD_i::usrpTransmit(size_t tuner_id, PACK
     }
 
     // Send in size/2 because it is complex
-    if( usrp_tx_streamers[frontend_tuner_status[tuner_id].tuner_number]->send(&packet->dataBuffer.front(), packet->dataBuffer.size() / 2, _metadata, 0.1) != packet->dataBuffer.size() / 2){
+    const size_t num_sent = usrp_tx_streamers[frontend_tuner_status[tuner_id].tuner_number]->send(&packet->dataBuffer.front(), packet->dataBuffer.size() / 2, _metadata, 0.1);
+    TRACE_EVENT(TRACE_TX_SEND, tuner_id, packet->dataBuffer.size() / 2, num_sent);
+    usrp_tuners[tuner_id].metrics.send_calls.add();
+    usrp_tuners[tuner_id].metrics.samps.add(num_sent);
+    if( num_sent != packet->dataBuffer.size() / 2){
+        usrp_tuners[tuner_id].metrics.short_sends.add();
         LOG_WARN(USRP_UHD_i, "WARNING: THE USRP WAS UNABLE TO TRANSMIT " << size_t(packet->dataBuffer.size()) / 2 << " NUMBER OF SAMPLES!");
         return false;
     }
@@ -1692,12 +3755,7 @@ bool USRP_UHD_i::usrpEnable(size_t tuner_id){
 
     if(frontend_tuner_status[tuner_id].tuner_type == "TX"){
 
-        str2rfinfo_map_t::iterator it=rf_port_info_map.begin();
-        for (; it!=rf_port_info_map.end(); it++) {
-            if (it->second.tuner_idx == tuner_id && it->second.antenna == frontend_tuner_status[tuner_id].antenna) {
-                break;
-            }
-        }
+        str2rfinfo_map_t::iterator it=findRFInfoPort(tuner_id, frontend_tuner_status[tuner_id].antenna);
         if (it==rf_port_info_map.end()) {
             LOG_ERROR(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << "No matching RFInfo port found!! Failed enable.");
             return false;
@@ -1723,6 +3781,7 @@ bool USRP_UHD_i::usrpEnable(size_t tuner_id){
             usrpCreateTxStream<short>(tuner_id); // assume short for now since we don't know until data is received over a port
             LOG_TRACE(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << " got tx_streamer[" << frontend_tuner_status[tuner_id].tuner_number << "]");
         }
+        frontend_tuner_status[tuner_id].status = "enabled";
 
     } else {
 
@@ -1736,9 +3795,10 @@ bool USRP_UHD_i::usrpEnable(size_t tuner_id){
             BULKIO::StreamSRI sri = create(stream_id, frontend_tuner_status[tuner_id]);
             sri.mode = 1; // complex
             //printSRI(&sri,"USRP_UHD_i::usrpEnable SRI"); // DEBUG
-            dataShort_out->pushSRI(sri);
+            short_push_queue->pushSRI(sri);
             dataSDDS_out->pushSRI(sri);
             usrp_tuners[tuner_id].update_sri = false;
+            usrp_tuners[tuner_id].shm.sri_changed = true;
         }
 
         if (usrp_rx_streamers[frontend_tuner_status[tuner_id].tuner_number].get() == NULL){
@@ -1746,51 +3806,73 @@ bool USRP_UHD_i::usrpEnable(size_t tuner_id){
             LOG_TRACE(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << " got rx_streamer[" << frontend_tuner_status[tuner_id].tuner_number << "]");
         }
 
-        // check for lo_lock
-        try{
-            for(size_t i=0; i<10 && !usrp_device_ptr->get_rx_sensor("lo_locked",frontend_tuner_status[tuner_id].tuner_number).to_bool(); i++){
-                sleep(0.1);
-            }
-        } catch(...){
-            sleep(1);
+        usrpStartStruct &start = usrp_tuners[tuner_id].start;
+        if (prev_enabled && start.state != usrpStartStruct::IDLE) {
+            LOG_DEBUG(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << " already enabled, stream_id=" << stream_id);
+            return true;
         }
 
-        uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
-        stream_cmd.stream_now = true;
-        usrp_device_ptr->issue_stream_cmd(stream_cmd, frontend_tuner_status[tuner_id].tuner_number);
-        //usrp_device_ptr->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS, frontend_tuner_status[tuner_id].tuner_number);
-        LOG_DEBUG(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << " started stream_id=" << stream_id);
+        // the enable thread waits for lo_locked and starts the stream (serviceFunctionEnable)
+        start.state = usrpStartStruct::WAIT_LOCK;
+        start.requested = boost::get_system_time();
+        start.polls = 0;
+        start.no_sensor = false;
+        start.ready = false;
+        start.group = 0;
+        start.command_time = uhd::time_spec_t();
+        frontend_tuner_status[tuner_id].status = "enabling";
+        LOG_DEBUG(USRP_UHD_i,"usrpEnable|tuner_id=" << tuner_id << " waiting for LO lock, stream_id=" << stream_id);
     }
     return true;
 }
 
+/* acquire tuner's lock prior to calling this function *
+ * starts streaming at device time start_time, or as soon as the command is received if stream_now
+ */
+void USRP_UHD_i::usrpStartStream(size_t tuner_id, bool stream_now, const uhd::time_spec_t& start_time){
+    LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " tuner_id=" << tuner_id << " stream_now=" << stream_now);
+
+    uhd::stream_cmd_t stream_cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    stream_cmd.stream_now = stream_now;
+    if (!stream_now)
+        stream_cmd.time_spec = start_time;
+    usrp_device_ptr->issue_stream_cmd(stream_cmd, frontend_tuner_status[tuner_id].tuner_number);
+    usrp_tuners[tuner_id].start.state = usrpStartStruct::STARTED;
+    LOG_DEBUG(USRP_UHD_i,"usrpStartStream|tuner_id=" << tuner_id << " started stream_id=" << frontend_tuner_status[tuner_id].stream_id);
+}
+
 /* acquire tuner's lock prior to calling this function */
 bool USRP_UHD_i::usrpDisable(size_t tuner_id){
     LOG_TRACE(USRP_UHD_i,__PRETTY_FUNCTION__ << " tuner_id=" << tuner_id);
 
     bool prev_enabled = frontend_tuner_status[tuner_id].enabled;
     frontend_tuner_status[tuner_id].enabled = false;
+    frontend_tuner_status[tuner_id].status = "disabled";
 
     if(frontend_tuner_status[tuner_id].tuner_type != "TX"){
         usrp_device_ptr->issue_stream_cmd(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS,frontend_tuner_status[tuner_id].tuner_number);
+        usrp_tuners[tuner_id].start.state = usrpStartStruct::IDLE;
+        // samps held at a hop are dropped along with those still on the device
+        usrp_tuners[tuner_id].hops.held.clear();
+        usrp_tuners[tuner_id].hops.push = false;
 
         if(prev_enabled && usrp_tuners[tuner_id].buffer_size > 0){
             // get stream id (creates one if not already created for this tuner)
             std::string stream_id = getStreamId(tuner_id);
-            usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_size);
+            resampleRxBuffer(tuner_id);
+            std::vector<short> &push_buffer = rxPushBuffer(tuner_id);
             LOG_DEBUG(USRP_UHD_i,"usrpDisable|pushing remaining samples after disable."
                                                  << "  buffer_size=" << usrp_tuners[tuner_id].buffer_size
-                                                 << "  buffer_capacity=" << usrp_tuners[tuner_id].buffer_capacity
-                                                 << "  output_buffer.size()=" << usrp_tuners[tuner_id].output_buffer.size() );
+                                                 << "  buffer_capacity=" << usrp_tuners[tuner_id].buffer_capacity);
             // Only push on active ports
             if(dataShort_out->isActive()){
-                dataShort_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
+                short_push_queue->pushPacket(push_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
             }
             if(dataSDDS_out->isActive()){
-                dataSDDS_out->pushPacket(usrp_tuners[tuner_id].output_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
+                dataSDDS_out->pushPacket(push_buffer, usrp_tuners[tuner_id].output_buffer_time, false, stream_id);
             }
+            publishRxBuffer(tuner_id, false, stream_id);
             usrp_tuners[tuner_id].buffer_size = 0;
-            usrp_tuners[tuner_id].output_buffer.resize(usrp_tuners[tuner_id].buffer_capacity);
         }
     }
     return true;
@@ -1875,6 +3957,168 @@ bool USRP_UHD_i::usrpCreateTxStream(size_t tuner_id){
     return true;
 }
 
+/*************************************************************
+Functions supporting stream routing
+- These replace the connectionTable/listener routing of USRP_UHD_base,
+  keeping indexes of both so updates do not scan or copy the table
+*************************************************************/
+void USRP_UHD_i::connectionTableChanged(const std::vector<connection_descriptor_struct>* oldValue, const std::vector<connection_descriptor_struct>* newValue)
+{
+    indexConnectionTable();
+    updateConnectionFilters();
+}
+
+std::string USRP_UHD_i::connectionKey(const std::string& connection_id, const std::string& port_name, const std::string& stream_id)
+{
+    // none of the ids contain a newline
+    return connection_id + '\n' + port_name + '\n' + stream_id;
+}
+
+void USRP_UHD_i::indexConnectionTable()
+{
+    connection_index.clear();
+    for (std::vector<connection_descriptor_struct>::iterator entry=connectionTable.begin();entry!=connectionTable.end();entry++) {
+        connection_index.insert(connectionKey(entry->connection_id, entry->port_name, entry->stream_id));
+    }
+}
+
+void USRP_UHD_i::updateConnectionFilters()
+{
+    dataShort_out->updateConnectionFilter(connectionTable);
+    dataSDDS_out->updateConnectionFilter(connectionTable);
+}
+
+/* adds an entry to connectionTable unless it already has one, returns whether it was added */
+bool USRP_UHD_i::addConnection(const std::string& connection_id, const std::string& port_name, const std::string& stream_id)
+{
+    if (!connection_index.insert(connectionKey(connection_id, port_name, stream_id)).second)
+        return false;
+    connection_descriptor_struct tmp;
+    tmp.connection_id = connection_id;
+    tmp.port_name = port_name;
+    tmp.stream_id = stream_id;
+    connectionTable.push_back(tmp);
+    return true;
+}
+
+/* erases the connectionTable entries of the given connection ids (or any id if empty) for stream_id (or any
+ * stream if NULL) in one pass, returns num erased */
+size_t USRP_UHD_i::eraseConnections(const id_set_t& connection_ids, const std::string* stream_id)
+{
+    std::vector<connection_descriptor_struct>::iterator keep = connectionTable.begin();
+    for (std::vector<connection_descriptor_struct>::iterator entry=connectionTable.begin();entry!=connectionTable.end();entry++) {
+        if ((connection_ids.empty() || connection_ids.count(entry->connection_id)) &&
+                (stream_id == NULL || entry->stream_id == *stream_id)) {
+            connection_index.erase(connectionKey(entry->connection_id, entry->port_name, entry->stream_id));
+            continue;
+        }
+        if (keep != entry)
+            *keep = *entry;
+        keep++;
+    }
+    const size_t num_erased = connectionTable.end() - keep;
+    connectionTable.erase(keep, connectionTable.end());
+    return num_erased;
+}
+
+/* returns the control allocation_id and the ids of its listeners */
+USRP_UHD_i::id_set_t USRP_UHD_i::routedConnectionIds(const std::string& allocation_id)
+{
+    id_set_t connection_ids;
+    connection_ids.insert(allocation_id);
+    boost::unordered_map<std::string, id_set_t>::iterator control = listeners_by_allocation.find(allocation_id);
+    if (control != listeners_by_allocation.end())
+        connection_ids.insert(control->second.begin(), control->second.end());
+    return connection_ids;
+}
+
+void USRP_UHD_i::assignListener(const std::string& listen_alloc_id, const std::string& allocation_id)
+{
+    // find control allocation_id
+    std::string existing_alloc_id = allocation_id;
+    std::map<std::string,std::string>::iterator existing_listener;
+    while ((existing_listener=listeners.find(existing_alloc_id)) != listeners.end())
+        existing_alloc_id = existing_listener->second;
+    listeners[listen_alloc_id] = existing_alloc_id;
+    listeners_by_allocation[existing_alloc_id].insert(listen_alloc_id);
+
+    // route the control allocation's streams to the listener too
+    std::vector<connection_descriptor_struct> new_entries;
+    for (std::vector<connection_descriptor_struct>::iterator entry=connectionTable.begin();entry!=connectionTable.end();entry++) {
+        if (entry->connection_id == existing_alloc_id) {
+            new_entries.push_back(*entry);
+        }
+    }
+    bool changed = false;
+    for (std::vector<connection_descriptor_struct>::iterator new_entry=new_entries.begin();new_entry!=new_entries.end();new_entry++) {
+        changed |= addConnection(listen_alloc_id, new_entry->port_name, new_entry->stream_id);
+    }
+    if (changed)
+        updateConnectionFilters();
+}
+
+void USRP_UHD_i::removeListener(const std::string& listen_alloc_id)
+{
+    std::map<std::string, std::string>::iterator listener = listeners.find(listen_alloc_id);
+    if (listener != listeners.end()) {
+        boost::unordered_map<std::string, id_set_t>::iterator control = listeners_by_allocation.find(listener->second);
+        if (control != listeners_by_allocation.end()) {
+            control->second.erase(listen_alloc_id);
+            if (control->second.empty())
+                listeners_by_allocation.erase(control);
+        }
+        listeners.erase(listener);
+    }
+    id_set_t connection_ids;
+    connection_ids.insert(listen_alloc_id);
+    const bool changed = eraseConnections(connection_ids, NULL) > 0;
+    ExtendedCF::UsesConnectionSequence_var tmp;
+    // Check to see if port "dataShort_out" has a connection for this listener
+    tmp = this->dataShort_out->connections();
+    for (unsigned int i=0; i<tmp->length(); i++) {
+        const char* connection_id = tmp[i].connectionId;
+        if (connection_id == listen_alloc_id) {
+            this->dataShort_out->disconnectPort(connection_id);
+        }
+    }
+    // Check to see if port "dataSDDS_out" has a connection for this listener
+    tmp = this->dataSDDS_out->connections();
+    for (unsigned int i=0; i<tmp->length(); i++) {
+        const char* connection_id = tmp[i].connectionId;
+        if (connection_id == listen_alloc_id) {
+            this->dataSDDS_out->disconnectPort(connection_id);
+        }
+    }
+    if (changed)
+        updateConnectionFilters();
+}
+
+void USRP_UHD_i::removeAllocationIdRouting(const size_t tuner_id) {
+    if (eraseConnections(routedConnectionIds(getControlAllocationId(tuner_id)), NULL) > 0)
+        updateConnectionFilters();
+}
+
+void USRP_UHD_i::removeStreamIdRouting(const std::string stream_id, const std::string allocation_id) {
+    // without an allocation_id, the stream is removed from every connection
+    id_set_t connection_ids;
+    if (allocation_id != "")
+        connection_ids = routedConnectionIds(allocation_id);
+    if (eraseConnections(connection_ids, &stream_id) > 0)
+        updateConnectionFilters();
+}
+
+void USRP_UHD_i::matchAllocationIdToStreamId(const std::string allocation_id, const std::string stream_id, const std::string port_name) {
+    bool changed;
+    if (port_name != "") {
+        changed = addConnection(allocation_id, port_name, stream_id);
+    } else {
+        changed = addConnection(allocation_id, "dataShort_out", stream_id);
+        changed |= addConnection(allocation_id, "dataSDDS_out", stream_id);
+    }
+    if (changed)
+        updateConnectionFilters();
+}
+
 /*************************************************************
 Functions servicing the RFInfo port(s)
 - port_name is the port over which the call was received
@@ -2034,22 +4278,36 @@ void USRP_UHD_i::setTunerCenterFrequency(const std::string& allocation_id, doubl
 
             scoped_tuner_lock tuner_lock(usrp_tuners[idx].lock);
 
-            // If the freq has changed (change in stream) or the tuner is disabled, then set it as disabled
-            bool is_tuner_enabled = frontend_tuner_status[idx].enabled;
-            if (usrp_device_ptr->get_rx_freq(frontend_tuner_status[idx].tuner_number) != freq)
-                usrpDisable(idx);
-
-            // set hw with new value
-            usrp_device_ptr->set_rx_freq(freq, frontend_tuner_status[idx].tuner_number);
-
-            // update status from hw
-            frontend_tuner_status[idx].center_frequency = usrp_device_ptr->get_rx_freq(frontend_tuner_status[idx].tuner_number);
-            usrp_tuners[idx].update_sri = true;
-            if (rx_autogain_on_tune)
-                trigger_rx_autogain = true;
-            // re-enable
-            if (is_tuner_enabled)
-                usrpEnable(idx);
+            if (usrp_tuners[idx].scan.active) {
+                // a scanning tuner returns to the new freq when the scan stops
+                usrp_tuners[idx].scan.return_frequency = freq;
+            } else if (frontend_tuner_status[idx].enabled && usrp_tuners[idx].start.state == usrpStartStruct::STREAMING) {
+                // retune a streaming tuner at a known samp, without interrupting the stream
+                if (frontend_tuner_status[idx].center_frequency != freq || !usrp_tuners[idx].hops.pending.empty()) {
+                    queueRetune(idx, freq);
+                    if (rx_autogain_on_tune)
+                        usrp_tuners[idx].agc.one_shot = true;
+                }
+            } else {
+                // If the freq has changed (change in stream) or the tuner is disabled, then set it as disabled
+                bool is_tuner_enabled = frontend_tuner_status[idx].enabled;
+                // (from the status rather than the device, which may throw if the channel was never tuned)
+                if (frontend_tuner_status[idx].center_frequency != freq)
+                    usrpDisable(idx);
+
+                // set hw with new value
+                usrp_tuners[idx].tune_cache.invalidate();
+                usrp_device_ptr->set_rx_freq(freq, frontend_tuner_status[idx].tuner_number);
+
+                // update status from hw
+                frontend_tuner_status[idx].center_frequency = usrp_device_ptr->get_rx_freq(frontend_tuner_status[idx].tuner_number);
+                usrp_tuners[idx].update_sri = true;
+                if (rx_autogain_on_tune)
+                    usrp_tuners[idx].agc.one_shot = true;
+                // re-enable
+                if (is_tuner_enabled)
+                    usrpEnable(idx);
+            }
 
         } else if (frontend_tuner_status[idx].tuner_type == "TX") {
 
@@ -2075,12 +4333,16 @@ void USRP_UHD_i::setTunerCenterFrequency(const std::string& allocation_id, doubl
     }
 
     exclusive_lock lock(prop_lock);
-    updateDeviceInfo();
+    refreshChannelInfo(idx);
 }
 double USRP_UHD_i::getTunerCenterFrequency(const std::string& allocation_id) {
     LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__);
     long idx = getTunerMapping(allocation_id);
     if (idx < 0) throw FRONTEND::FrontendException("Invalid allocation id");
+    // a retune sent to the device is reported before it reaches the output
+    scoped_tuner_lock tuner_lock(usrp_tuners[idx].lock);
+    if (!usrp_tuners[idx].hops.pending.empty())
+        return usrp_tuners[idx].hops.pending.back().freq;
     return frontend_tuner_status[idx].center_frequency;
 }
 void USRP_UHD_i::setTunerBandwidth(const std::string& allocation_id, double bw) {
@@ -2094,12 +4356,31 @@ double USRP_UHD_i::getTunerBandwidth(const std::string& allocation_id) {
     return frontend_tuner_status[idx].bandwidth;
 }
 void USRP_UHD_i::setTunerAgcEnable(const std::string& allocation_id, bool enable){
-    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__);
-    throw FRONTEND::NotSupportedException("setTunerAgcEnable not supported");
+    LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__ << " allocation_id=" << allocation_id << " enable=" << enable);
+
+    long idx = getTunerMapping(allocation_id);
+    if (idx < 0) throw FRONTEND::FrontendException("Invalid allocation id");
+    if(allocation_id != getControlAllocationId(idx)){
+        std::ostringstream msg;
+        msg << "setTunerAgcEnable|ID (" << allocation_id << ") does not have authorization to modify tuner.";
+        LOG_WARN(USRP_UHD_i,msg.str());
+        throw FRONTEND::FrontendException(msg.str().c_str());
+    }
+    if (frontend_tuner_status[idx].tuner_type != "RX_DIGITIZER")
+        throw FRONTEND::NotSupportedException("setTunerAgcEnable not supported for TX tuners");
+
+    scoped_tuner_lock tuner_lock(usrp_tuners[idx].lock);
+    usrp_tuners[idx].agc.continuous = enable;
+    if (!usrp_tuners[idx].agc.active()) {
+        usrp_tuners[idx].agc.stats.reset();
+        usrp_tuners[idx].agc.ready = false;
+    }
 }
 bool USRP_UHD_i::getTunerAgcEnable(const std::string& allocation_id){
     LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__);
-    throw FRONTEND::NotSupportedException("getTunerAgcEnable not supported");
+    long idx = getTunerMapping(allocation_id);
+    if (idx < 0) throw FRONTEND::FrontendException("Invalid allocation id");
+    return usrp_tuners[idx].agc.continuous;
 }
 void USRP_UHD_i::setTunerGain(const std::string& allocation_id, float gain){
     LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__);
@@ -2135,6 +4416,7 @@ void USRP_UHD_i::setTunerEnable(const std::string& allocation_id, bool enable) {
         throw FRONTEND::FrontendException(msg.str().c_str());
     }
 
+    boost::mutex::scoped_lock sync_guard(time_sync_lock);
     scoped_tuner_lock tuner_lock(usrp_tuners[idx].lock);
     if(enable)
         usrpEnable(idx);
@@ -2187,7 +4469,9 @@ void USRP_UHD_i::setTunerOutputSampleRate(const std::string& allocation_id, doub
 
             scoped_tuner_lock tuner_lock(usrp_tuners[idx].lock);
 
-            // set hw with new value
+            // set hw with new value, which replaces any resampling set up by the allocation
+            usrp_tuners[idx].tune_cache.invalidate();
+            usrp_tuners[idx].resample.active = false;
             usrp_device_ptr->set_rx_rate(opt_sr, frontend_tuner_status[idx].tuner_number);
 
             // update status from hw
@@ -2196,8 +4480,10 @@ void USRP_UHD_i::setTunerOutputSampleRate(const std::string& allocation_id, doub
             frontend_tuner_status[idx].bandwidth = std::min(frontend_tuner_status[idx].sample_rate,usrp_device_ptr->get_rx_bandwidth(frontend_tuner_status[idx].tuner_number));
             LOG_DEBUG(USRP_UHD_i,"setTunerOutputSampleRate|REQ_SR=" << sr << " OPT_SR=" << opt_sr << " TUNER_SR=" << frontend_tuner_status[idx].sample_rate);
             usrp_tuners[idx].update_sri = true;
+            if (usrp_tuners[idx].scan.active)
+                setScanMode(idx, true, usrp_tuners[idx].scan.settings); // replan steps for the new rate
             if (rx_autogain_on_tune)
-                trigger_rx_autogain = true;
+                usrp_tuners[idx].agc.one_shot = true;
 
         } else if (frontend_tuner_status[idx].tuner_type == "TX") {
 
@@ -2223,7 +4509,7 @@ void USRP_UHD_i::setTunerOutputSampleRate(const std::string& allocation_id, doub
         throw FRONTEND::FrontendException(msg.str().c_str());
     }
     exclusive_lock lock(prop_lock);
-    updateDeviceInfo();
+    refreshChannelInfo(idx);
 }
 
 double USRP_UHD_i::getTunerOutputSampleRate(const std::string& allocation_id) {
@@ -2235,87 +4521,33 @@ double USRP_UHD_i::getTunerOutputSampleRate(const std::string& allocation_id) {
 }
 
 /*----------------------------------------------------------------------------
-        This is a very simple auto-gain function.
+        Gain adjustment for a single tuner's AGC measurement window.
         Notes:
-             1. Calculates the bit 'loading' of a sample over a sample set.
-             2. Kept generic to work for all daughtercard types in all modes.
-             3. Calculates instantaneous values; not continuously calculating.
-             4. Requires minimum of 500 samples (250 complex samples)
+             1. Peak is the largest magnitude of I or Q, so negative peaks count.
+             2. Target peak level leaves rx_autogain_guard_bits unused (6.02 dB per bit).
+             3. One shot adjustments move straight to the target level.
+             4. Continuous adjustments decrease gain by at most attack_db, and increase
+                gain by at most decay_db, only once the peak falls more than
+                hysteresis_db below target.
  ----------------------------------------------------------------------------*/
-float USRP_UHD_i::auto_gain() {
-    size_t  samplesRequired = 500; // not configurable; hard-coded to 500, which is really 250 complex samples
-    size_t  samplesFound    = 0;
-    long    maxBits         = (device_rx_mode == "8bit") ? 8 : 16;
-    maxBits -= this->rx_autogain_guard_bits;
-    short   maxValue        = (device_rx_mode == "8bit") ? 0x7f  : 0x7fff;
-    short   maxValueFound   = 0; // max value in current buffer
-    long    bitsInUse       = 0;
-    float   maxGain         = 0;
-    float   minGain         = 0;
-    float   gainAdjust      = 0;
-    float   newGain         = device_rx_gain_global;
-
-    // Find max input value of all current receive buffers
-    for (size_t tuner_id=0; tuner_id<usrp_tuners.size(); tuner_id++) {
-        if (frontend_tuner_status[tuner_id].tuner_type =="RX_DIGITIZER") {
-            // If the tuner is a receiver, save off the max and min gain for later.
-            // All receive channels should have the same min and max gain
-            maxGain = device_channels[tuner_id].gain_max;
-            minGain = device_channels[tuner_id].gain_min;
-            samplesFound += usrp_tuners[tuner_id].buffer_size;
-            for(size_t sampleNum=0 ; sampleNum<usrp_tuners[tuner_id].buffer_size; sampleNum++) {
-                // max value tracker. Look at Real and Complex values.
-                if((short)(usrp_tuners[tuner_id].output_buffer[sampleNum]) > maxValueFound)
-                    maxValueFound = (short)(usrp_tuners[tuner_id].output_buffer[sampleNum]);
-            }
-        }
-    }
-
-    // require buffer to have sufficient number of samples before turning off trigger
-    LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Got " << samplesFound << " of " << samplesRequired << " samples required for auto-gain calculation.");
-    if (samplesFound >= samplesRequired) {
-        LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Max value in buffer is " << maxValueFound << " compared to a fully loaded max of " << maxValue);
-        trigger_rx_autogain = false;
-    } else {
-        LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Not enough samples to calculate auto-gain; not resetting trigger yet.");
-        trigger_rx_autogain = true;
-        return device_rx_gain_global; // no change yet
-    }
-
-    // compute bits currently in use
-    for (int32_t m=maxValueFound; m; m>>=1) bitsInUse++; // floor(log10(maxValueFound) / log10(2)) + 1
-    bitsInUse++; // add 1 to account for negative range as well
-    LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Max value in buffer uses " << bitsInUse <<" bits compared to " << maxBits << " available non-guard bits");
-
-    // compute gain adjustment
-    gainAdjust = (maxBits-bitsInUse) * 6; // x6 to convert bits to dB
-    LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Gain adjustment calculated is " << gainAdjust);
-
-    // adjust gain according to actual device min and max values
-    if (gainAdjust > 0) { // increase gain if possible
-        LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " device_rx_gain_global=" << device_rx_gain_global << "  maxGain=" << maxGain);
-        if (device_rx_gain_global < maxGain) {
-            newGain = fmin(gainAdjust+device_rx_gain_global, maxGain);
-            LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__<<" Increasing Gain to " << newGain);
-        } else {
-            // input signal too low.  can't increase gain further
-            LOG_DEBUG(USRP_UHD_i,__PRETTY_FUNCTION__<<" Input too low; no more gain possible!");
-            newGain = maxGain;
-        }
-    } else if (gainAdjust < 0) { // reduce gain if possible
-        LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " device_rx_gain_global=" << device_rx_gain_global << "  minGain=" << minGain);
-        if (device_rx_gain_global > minGain) {
-            newGain = fmax(gainAdjust+device_rx_gain_global, minGain);
-            LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Decreasing Gain to " << newGain);
-        } else {
-            // input signal too hot.  can't reduce gain further
-            LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " Input too high; no more attenuation possible!");
-            newGain = minGain;
-        }
-    } else { // no change necessary
-        LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " No gain adjustments necessary.");
-        newGain = device_rx_gain_global;
+double USRP_UHD_i::agcGainAdjustment(const sampleStats& stats, bool one_shot, const rx_agc_struct& settings, double full_scale, double target_dbfs) {
+    if (stats.num_values == 0)
+        return 0.0;
+
+    const double peak_dbfs = 20.0*log10(std::max(double(stats.peak), 1.0)/full_scale);
+    const double rms_dbfs = 10.0*log10(std::max(stats.sum_sq/(stats.num_values/2), 1.0)/(full_scale*full_scale));
+    LOG_DEBUG(USRP_UHD_i, __PRETTY_FUNCTION__ << " peak=" << peak_dbfs << " dBFS  rms=" << rms_dbfs << " dBFS  target=" << target_dbfs << " dBFS");
+
+    double adjust = 0.0;
+    if (peak_dbfs > target_dbfs) {
+        adjust = target_dbfs-peak_dbfs;
+        if (!one_shot)
+            adjust = std::max(adjust, -double(settings.attack_db));
+    } else if (one_shot || peak_dbfs < target_dbfs-settings.hysteresis_db) {
+        adjust = target_dbfs-peak_dbfs;
+        if (!one_shot)
+            adjust = std::min(adjust, double(settings.decay_db));
     }
-    return newGain;
+    return adjust;
 }
 
@@ -22,7 +22,21 @@
 
 #include "USRP_UHD_base.h"
 #include "port_impl_customized.h"
+#include "PushQueue.h"
+#include "Resampler.h"
+#include "ShmRing.h"
+#include "SampleStats.h"
+#include "SpectrumScan.h"
+#include "HotPathMetrics.h"
+#include "EventTrace.h"
+#include "UsrpBackend.h"
+#include "SimBackend.h"
 #include <math.h>
+#include <sched.h>
+#include <deque>
+#include <map>
+#include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
 #include <uhd/usrp/multi_usrp.hpp>
 
 
@@ -45,6 +59,14 @@ public:
         _udelay = (__useconds_t)(_delay * 1000000);
     };
 
+    MultiProcessThread(boost::function<int ()> _func,float _delay)
+    {
+        service_function = _func;
+        _mythread = 0;
+        _thread_running = false;
+        _udelay = (__useconds_t)(_delay * 1000000);
+    };
+
     // kick off the thread
     void start() {
         if (_mythread == 0) {
@@ -90,6 +112,21 @@ public:
 
     void updateDelay(float _delay) { _udelay = (__useconds_t)(_delay * 1000000); };
 
+    // pin underlying boost::thread to a single cpu core, negative core clears pinning
+    bool setAffinity(int core) {
+        if (_mythread == 0)
+            return false;
+        cpu_set_t cpuset;
+        CPU_ZERO(&cpuset);
+        if (core < 0) {
+            for (int i = 0; i < CPU_SETSIZE; i++)
+                CPU_SET(i, &cpuset);
+        } else {
+            CPU_SET(core, &cpuset);
+        }
+        return pthread_setaffinity_np(_mythread->native_handle(), sizeof(cpu_set_t), &cpuset) == 0;
+    };
+
 private:
     boost::thread *_mythread;
     bool _thread_running;
@@ -115,12 +152,19 @@ class scoped_tuner_lock{
         scoped_tuner_lock(ticket_lock_t& _ticket){
             ticket = &_ticket;
 
+#ifdef USRP_UHD_TRACE
+            const uint64_t wait_start = eventTrace::enabled ? hotPathNow() : 0;
+#endif
             boost::mutex::scoped_lock lock(*ticket->mutex);
             queue_me = ticket->queue_tail++;
             while (queue_me != ticket->queue_head)
             {
                 ticket->cond->wait(lock);
             }
+#ifdef USRP_UHD_TRACE
+            if (wait_start != 0)
+                TRACE_EVENT(TRACE_LOCK_WAIT, TRACE_NO_TUNER, hotPathNow()-wait_start, 0);
+#endif
         }
         ~scoped_tuner_lock(){
             boost::mutex::scoped_lock lock(*ticket->mutex);
@@ -133,6 +177,281 @@ class scoped_tuner_lock{
 };
 
 
+/** Low latency receive settings and metrics for a tuner. When enabled, the tuner is serviced by its own
+ *  thread that receives a single device packet at a time and pushes every packets_per_push packets.
+ *  Latencies are measured from the device time_spec of the last sample pushed to the return of pushPacket.
+ */
+struct usrpLowLatencyStruct {
+    usrpLowLatencyStruct(){
+        enabled = false;
+        packets_per_push = 1;
+        recv_timeout = 0.0;
+        cpu_core = -1;
+        reset();
+    }
+
+    bool enabled;
+    size_t packets_per_push;
+    double recv_timeout; // sec
+    short cpu_core; // negative means not pinned
+    size_t packets; // num packets in output buffer
+    size_t pushes;
+    double latency_last; // sec
+    double latency_min; // sec
+    double latency_max; // sec
+    double latency_sum; // sec
+    boost::system_time last_publish;
+
+    void reset(){
+        packets = 0;
+        pushes = 0;
+        latency_last = latency_min = latency_max = latency_sum = 0.0;
+        last_publish = boost::get_system_time();
+    }
+};
+
+/** RX AGC state for a tuner. The receive thread accumulates level measurements of received samples into
+ *  stats until a full window has been collected, and then sets ready. The AGC thread consumes the window,
+ *  adjusts the gain of this tuner's channel only, and clears ready. Gain is never set by the receive thread.
+ */
+struct usrpAgcStruct {
+    usrpAgcStruct(){
+        continuous = false;
+        one_shot = false;
+        ready = false;
+        update_period = 0.1;
+    }
+
+    bool continuous; // adjust gain after every window
+    bool one_shot; // adjust gain after next window only
+    bool ready; // stats holds a full window, waiting on AGC thread
+    double update_period; // sec, duration of a window
+    sampleStats stats;
+
+    bool active() const { return continuous || one_shot; }
+};
+
+/** Signal statistics for a tuner, measured by the receive thread and published to tuner_signal_stats once
+ *  per period. Received samps are measured in blocks of block_len values, and each complete block is folded
+ *  into window. The lowest mean power of any complete block in the window is the noise floor estimate.
+ */
+struct usrpSignalStatsStruct {
+    static const size_t block_len = 2048; // I and Q values (1024 complex samps)
+
+    usrpSignalStatsStruct(){
+        period = 1.0;
+        clip_level = 32767;
+        reset();
+    }
+
+    double period; // sec, 0 disables measurements
+    unsigned short clip_level; // max magnitude of I or Q for the sample format
+    sampleStats block; // current block
+    sampleStats window; // complete blocks in current period
+    double min_block_power; // mean I^2+Q^2 of quietest complete block in window, < 0 if none
+    boost::system_time window_start;
+
+    void reset(){
+        block.reset();
+        window.reset();
+        min_block_power = -1.0;
+        window_start = boost::get_system_time();
+    }
+};
+
+/** Stream start state for an RX tuner. usrpEnable configures the tuner and leaves it in WAIT_LOCK, without
+ *  blocking on the LO. The enable thread (serviceFunctionEnable) polls lo_locked until the LO locks or the
+ *  rx_enable timeout passes, and then sends a timed start stream command. The receive threads skip the tuner
+ *  until it is STARTED, and it reports "enabling" in frontend_tuner_status until the first samps arrive.
+ *  Tuners of the same nonzero group (usrpTuneBatchStruct) are started together, once all of them are ready.
+ */
+struct usrpStartStruct {
+    enum startState { IDLE, WAIT_LOCK, STARTED, STREAMING };
+
+    usrpStartStruct(){
+        state = IDLE;
+        polls = 0;
+        no_sensor = false;
+        ready = false;
+        group = 0;
+    }
+
+    startState state;
+    boost::system_time requested; // host time of usrpEnable
+    size_t polls; // lo_locked reads since requested
+    bool no_sensor; // lo_locked could not be read, so the full timeout is waited
+    bool ready; // LO locked or timed out, waiting on the rest of group
+    size_t group; // start group, 0 if started alone
+    uhd::time_spec_t command_time; // device time of the group's retunes, lo_locked is only read after it
+};
+
+/** RX tuner allocations made by a single allocateCapacity call. The requests are validated, and each assigned
+ *  its own unallocated tuner, before any tuner is configured. The tuners are retuned at the same device time,
+ *  their channel info is refreshed once at the end, and their streams are started at the same device time once
+ *  all of their LOs have locked.
+ *  A retune that cannot be sent before command_time is made at once instead, and the batch is allocated but
+ *  no longer coherent, which is logged.
+ */
+struct usrpTuneBatchStruct {
+    usrpTuneBatchStruct(){
+        active = false;
+        coherent = true;
+        group = 0;
+    }
+
+    bool active;
+    bool coherent; // every retune so far was sent ahead of command_time. Not protected by prop_lock: only thread uses it
+    boost::thread::id thread; // allocating thread, the only one that tunes as part of the batch
+    uhd::time_spec_t command_time; // device time of the retunes
+    size_t group; // start group of the batch, incremented for each batch
+    std::vector<size_t> tuners; // tuner_ids tuned so far
+    std::map<std::string, size_t> assignment; // tuner_id of each request's allocation_id, from validateTuneBatch
+};
+
+/** Frequency hop state for an RX tuner. Hops from hop_schedule are sent to the device as timed retunes
+ *  shortly before they are due (queueHops), and stay pending until the receive thread reaches the first
+ *  sample at or after the retune time (splitAtHop). The output buffer is pushed up to that sample, and the
+ *  samples from the hop on are held for the next usrpReceive, so they start a push with the new SRI.
+ */
+struct usrpHopStruct {
+    struct timedHop {
+        uhd::time_spec_t time; // device time of retune
+        double freq; // center freq reported by the device
+        size_t index; // in schedule
+    };
+
+    usrpHopStruct(){
+        next = 0;
+        repeat = false;
+        chained = false;
+        last_dwell = 0.0;
+        applied = 0;
+        current = 0;
+        push = false;
+    }
+
+    std::vector<hop_struct> schedule; // hop_schedule entries for the tuner's allocation
+    size_t next; // index in schedule of next hop to send to the device
+    bool repeat; // start schedule over after the last hop
+    bool chained; // a hop of schedule has been sent, so last_time and last_dwell apply
+    uhd::time_spec_t last_time; // device time of last hop sent
+    double last_dwell; // sec, dwell of last hop sent
+    std::deque<timedHop> pending; // sent to the device, in time order
+    uhd::time_spec_t stream_time; // device time following the last samp received
+    size_t applied; // num hops applied to the output
+    size_t current; // index in schedule of last hop applied
+    std::vector<short> held; // samps from the first pending hop on
+    uhd::time_spec_t held_time; // device time of first held samp
+    bool push; // buffer must be pushed before held samps are added
+};
+
+/** Spectrum scan state for an RX tuner (see spectrum_scan). The scan steps run as a repeating hop schedule,
+ *  and each buffer goes to scanRxBuffer rather than being pushed. A buffer never spans a hop, so all of its
+ *  samps belong to the step of the last hop applied.
+ */
+struct usrpScanStruct {
+    usrpScanStruct(){
+        active = false;
+        sample_rate = 0.0;
+        return_frequency = 0.0;
+        full_scale = 32768.0;
+        num_steps = bins_per_step = first_bin = averages = settle_samps = 0;
+        hops_applied = 0;
+        step = skip = 0;
+        measuring = false;
+        sweeps = 0;
+        sweep_start_ns = 0;
+    }
+
+    bool active;
+    spectrum_scan_struct settings;
+    double sample_rate; // steps are planned for this rate
+    double return_frequency; // tuner's center freq before the scan
+    double full_scale;
+    size_t num_steps;
+    size_t bins_per_step; // bins kept from each step
+    size_t first_bin; // first bin kept, of fft_size
+    size_t averages;
+    size_t settle_samps;
+    psdAccumulator psd;
+
+    size_t hops_applied; // hops.applied when the current step started
+    size_t step; // current step
+    size_t skip; // samps left to discard while the LO settles
+    bool measuring; // current step needs more frames
+    std::vector<float> sweep; // bins of the steps measured so far
+    size_t sweeps;
+    uint64_t sweep_start_ns; // host time (hotPathNow)
+};
+
+/** Hardware settings last applied to an RX tuner's channel by deviceSetTuning, and the actual values read back.
+ *  It is kept through deallocation, so reallocating the channel with the same settings skips the UHD calls.
+ *  Anything else that sets the channel's freq, bandwidth, rate or antenna invalidates it. Other channels can
+ *  still change its rate (master clock rate), freq (shared LO) or analog bandwidth, so a hit is only used if the
+ *  channel's current rate, freq and bandwidth still read back as actual_rate, actual_freq and actual_bandwidth.
+ */
+struct usrpTuneCacheStruct {
+    usrpTuneCacheStruct(){
+        invalidate();
+    }
+
+    bool valid;
+    double freq; // requested, after if_offset
+    double bandwidth; // requested, from optimizeBandwidth
+    double rate; // requested, from optimizeRate
+    std::string antenna;
+    double actual_freq;
+    double actual_bandwidth;
+    double actual_rate;
+    double lo_freq; // actual_rf_freq of the tune result
+    double dsp_freq; // actual_dsp_freq of the tune result
+
+    bool matches(double req_freq, double req_bandwidth, double req_rate, const std::string& req_antenna) const {
+        return valid && req_freq == freq && req_bandwidth == bandwidth && req_rate == rate && req_antenna == antenna;
+    }
+
+    void invalidate(){
+        valid = false;
+        freq = bandwidth = rate = 0.0;
+        actual_freq = actual_bandwidth = actual_rate = 0.0;
+        lo_freq = dsp_freq = 0.0;
+        antenna.clear();
+    }
+};
+
+/** Host side resampling of an RX tuner's output (rx_resampler), configured by deviceSetTuning.
+ *  While active, the tuner status reports out_rate, and the samps in the output buffer are at in_rate until
+ *  resampleRxBuffer replaces them just before they are pushed.
+ */
+struct usrpResampleStruct {
+    usrpResampleStruct(){
+        active = false;
+        in_rate = 0.0;
+        out_rate = 0.0;
+        next_time = -1.0;
+    }
+
+    bool active;
+    double in_rate; // hw rate
+    double out_rate; // in_rate*up/down
+    double next_time; // device time (sec) of the input samp expected next, negative before the first block
+    polyphaseResampler filter;
+};
+
+/** Shared memory output of an RX tuner (shm_output). The ring outlives allocations, so that readers can stay
+ *  attached while the tuner is reallocated, and is only replaced when an allocation needs a different one.
+ */
+struct usrpShmStruct {
+    usrpShmStruct(){
+        enabled = false;
+        sri_changed = true;
+    }
+
+    bool enabled; // publish the current allocation's output to ring
+    bool sri_changed; // flag the next block published with SHM_RING_SRI_CHANGED
+    boost::shared_ptr<shmRingWriter> ring;
+};
+
 /** Device Individual Tuner. This structure contains stream specific data for channel/tuner to include:
  *      - Data buffer
  *      - Additional stream metadata (timestamps)
@@ -152,25 +471,64 @@ struct usrpTunerStruct {
 
         buffer_capacity = max_samples_per_push;
         output_buffer.resize( buffer_capacity );
+        max_latency = 0.0;
 
         reset();
     }
 
     std::vector<short> output_buffer;
+    std::vector<short> partial_buffer; // copy of output_buffer contents for pushes smaller than buffer_capacity
     size_t buffer_capacity; // num samps buffer can hold
     size_t buffer_size; // num samps in buffer
+    double max_latency; // max age (sec) of oldest sample in buffer before pushing, 0 pushes only full buffers
+    boost::system_time buffer_start; // host time when first samps in buffer were received
     BULKIO::PrecisionUTCTime output_buffer_time;
     BULKIO::PrecisionUTCTime time_up;
     BULKIO::PrecisionUTCTime time_down;
     bool update_sri;
+    usrpLowLatencyStruct low_latency;
+    usrpAgcStruct agc;
+    usrpSignalStatsStruct signal_stats;
+    usrpStartStruct start;
+    usrpHopStruct hops;
+    usrpScanStruct scan;
+    usrpResampleStruct resample;
+    usrpTuneCacheStruct tune_cache; // not cleared by reset, outlives allocations
+    usrpShmStruct shm; // reset only disables it, the ring outlives allocations
+    tunerHotPathMetrics metrics;
+    latencyHistogram device_to_recv; // device time of last samp received to end of usrpReceive
+    uint64_t recv_end_ns; // host time (hotPathNow) at end of last usrpReceive that received samps
     ticket_lock_t lock;
 
+    // num samps that triggers a push at the given sample rate
+    // with a latency bound, this is the whole number of SDDS payloads (512 samps)
+    // that can be received within max_latency, or fewer samps if the rate is very low
+    size_t push_size(double sample_rate) const {
+        if (max_latency <= 0.0 || sample_rate <= 0.0)
+            return buffer_capacity;
+        size_t samps = size_t(sample_rate*max_latency)*2; // complex
+        if (samps >= 512)
+            samps -= samps%512;
+        return std::min(std::max(samps, size_t(2)), buffer_capacity);
+    }
+
     void reset(){
         buffer_size = 0;
         bulkio::sri::zeroTime(output_buffer_time);
         bulkio::sri::zeroTime(time_up);
         bulkio::sri::zeroTime(time_down);
         update_sri = false;
+        low_latency = usrpLowLatencyStruct();
+        agc = usrpAgcStruct();
+        signal_stats.reset();
+        start = usrpStartStruct();
+        hops = usrpHopStruct();
+        scan = usrpScanStruct();
+        resample = usrpResampleStruct();
+        shm.enabled = false;
+        metrics.reset();
+        device_to_recv.clear();
+        recv_end_ns = 0;
     }
 };
 
@@ -183,12 +541,16 @@ struct usrpRangesStruct {
     uhd::meta_range_t bandwidth;
     uhd::meta_range_t sample_rate;
     uhd::meta_range_t gain;
+    std::vector<double> rates; // achievable sample rates, ascending (USRP_UHD_i::buildRateIndex)
+    bool rates_truncated; // rates stops short of sample_rate.start()
 
     void reset(){
         frequency.clear();
         bandwidth.clear();
         sample_rate.clear();
         gain.clear();
+        rates.clear();
+        rates_truncated = false;
     };
 };
 
@@ -204,6 +566,8 @@ class USRP_UHD_i : public USRP_UHD_base
     typedef std::pair<std::string, std::string*>           str2strptr_pair_t;
     typedef std::map<std::string,rfinfoPortMappingStruct>  str2rfinfo_map_t;
     typedef std::pair<std::string,rfinfoPortMappingStruct> str2rfinfo_pair_t;
+    typedef boost::unordered_map<std::pair<size_t,std::string>, std::string> rfport_index_t;
+    typedef boost::unordered_set<std::string> id_set_t;
     public:
         USRP_UHD_i(char *devMgr_ior, char *id, char *lbl, char *sftwrPrfl);
         USRP_UHD_i(char *devMgr_ior, char *id, char *lbl, char *sftwrPrfl, char *compDev);
@@ -213,10 +577,25 @@ class USRP_UHD_i : public USRP_UHD_base
         void constructor();
         int serviceFunction(){return FINISH;} // unused
         int serviceFunctionReceive();
+        int serviceFunctionLowLatency(size_t tuner_id);
+        int serviceFunctionAgc();
+        int serviceFunctionEnable();
+        int serviceFunctionMetrics();
+        int serviceFunctionShortPush();
         int serviceFunctionTransmit();
         void start() throw (CF::Resource::StartError, CORBA::SystemException);
         void stop() throw (CF::Resource::StopError, CORBA::SystemException);
+        CORBA::Boolean allocateCapacity(const CF::Properties& capacities)
+            throw (CF::Device::InvalidState, CF::Device::InvalidCapacity, CF::Device::InsufficientCapacity, CORBA::SystemException);
+
+        // stream routing, in place of USRP_UHD_base's
+        void matchAllocationIdToStreamId(const std::string allocation_id, const std::string stream_id, const std::string port_name="");
+        void removeAllocationIdRouting(const size_t tuner_id);
+        void removeStreamIdRouting(const std::string stream_id, const std::string allocation_id="");
+        void assignListener(const std::string& listen_alloc_id, const std::string& allocation_id);
+        void removeListener(const std::string& listen_alloc_id);
     protected:
+        void connectionTableChanged(const std::vector<connection_descriptor_struct>* oldValue, const std::vector<connection_descriptor_struct>* newValue);
         std::string get_rf_flow_id(const std::string& port_name);
         void set_rf_flow_id(const std::string& port_name, const std::string& id);
         frontend::RFInfoPkt get_rfinfo_pkt(const std::string& port_name);
@@ -239,7 +618,7 @@ class USRP_UHD_i : public USRP_UHD_base
         void setTunerEnable(const std::string& allocation_id, bool enable);
         double getTunerOutputSampleRate(const std::string& allocation_id);
         void setTunerOutputSampleRate(const std::string& allocation_id, double sr);
-        float auto_gain();
+
 
     private:
         // Custom SDDS port
@@ -268,8 +647,21 @@ class USRP_UHD_i : public USRP_UHD_base
         // serviceFunctionTransmit thread
         MultiProcessThread<USRP_UHD_i> *receive_service_thread;
         MultiProcessThread<USRP_UHD_i> *transmit_service_thread;
+        std::vector<MultiProcessThread<USRP_UHD_i>*> low_latency_service_threads; // indices map to tuner_id
+                                                                                  // protected by receive_service_thread_lock
         boost::mutex receive_service_thread_lock;
         boost::mutex transmit_service_thread_lock;
+        MultiProcessThread<USRP_UHD_i> *agc_service_thread;
+        boost::mutex agc_service_thread_lock;
+        MultiProcessThread<USRP_UHD_i> *enable_service_thread;
+        boost::mutex enable_service_thread_lock;
+        MultiProcessThread<USRP_UHD_i> *metrics_service_thread;
+        boost::mutex metrics_service_thread_lock;
+        boost::system_time last_metrics_update; // only accessed by metrics_service_thread
+        // RX output is pushed to dataShort_out through a queue, by its own thread (rx_push_queue)
+        asyncPushQueue<bulkio::OutShortPort, short> *short_push_queue;
+        MultiProcessThread<USRP_UHD_i> *short_push_thread;
+        boost::mutex push_service_thread_lock;
         template <class IN_PORT_TYPE> bool transmitHelper(IN_PORT_TYPE *dataIn);
 
         // Ensures access to properties is thread safe
@@ -278,6 +670,11 @@ class USRP_UHD_i : public USRP_UHD_base
 
         // global properties for all channels
         str2rfinfo_map_t rf_port_info_map;
+        rfport_index_t rf_port_index; // (tuner_idx, antenna) -> rf_port_info_map key, see indexRFInfoPorts
+
+        // indexes kept in step with listeners and connectionTable, so routing updates do not scan them
+        boost::unordered_map<std::string, id_set_t> listeners_by_allocation; // control allocation_id -> listener ids
+        id_set_t connection_index; // connectionKey of each connectionTable entry
         void updateRfFlowId(const std::string &port_name);
         void updateGroupId(const std::string &group);
 
@@ -292,6 +689,20 @@ class USRP_UHD_i : public USRP_UHD_base
         void deviceReferenceSourceChanged(std::string old_value, std::string new_value);
         void deviceGroupIdChanged(std::string old_value, std::string new_value);
         void antennaChanged(const configure_tuner_antenna_struct& old_value, const configure_tuner_antenna_struct& new_value);
+        void maxLatencyChanged(double old_value, double new_value);
+        void tunerMaxLatencyChanged(const std::vector<tuner_latency_struct>* old_value, const std::vector<tuner_latency_struct>* new_value);
+        void rxAgcChanged(const rx_agc_struct& old_value, const rx_agc_struct& new_value);
+        void rxPushQueueChanged(const rx_push_queue_struct& old_value, const rx_push_queue_struct& new_value);
+        void triggerRxAutogainChanged(bool old_value, bool new_value);
+        void lowLatencyAllocationsChanged(const std::vector<low_latency_allocation_struct>* old_value, const std::vector<low_latency_allocation_struct>* new_value);
+        void signalStatsPeriodChanged(double old_value, double new_value);
+        void resetLatencyHistogramsChanged(bool old_value, bool new_value);
+        void traceSettingsChanged(const trace_settings_struct& old_value, const trace_settings_struct& new_value);
+        void triggerTraceDumpChanged(bool old_value, bool new_value);
+        void simDeviceChanged(const sim_device_struct& old_value, const sim_device_struct& new_value);
+        void hopScheduleChanged(const std::vector<hop_struct>* old_value, const std::vector<hop_struct>* new_value);
+        void spectrumScanChanged(const spectrum_scan_struct& old_value, const spectrum_scan_struct& new_value);
+        void dumpEventTrace();
 
         // additional bookkeeping for each channel
         std::vector<usrpRangesStruct> usrp_ranges; // freq/bw/sr/gain ranges supported by each tuner channel
@@ -306,6 +717,9 @@ class USRP_UHD_i : public USRP_UHD_base
                                                                // each element protected by corresponding usrp_tuners[tuner_id].lock
         std::vector<size_t> usrp_tx_streamer_typesize; // indices map to usrp_tuners[tuner_id].tuner_number
                                                        // each element protected by corresponding usrp_tuners[tuner_id].lock
+        usrpTuneBatchStruct tune_batch; // protected by prop_lock, except coherent (see usrpTuneBatchStruct)
+        boost::mutex tune_batch_lock; // held by allocateCapacity for the whole batch
+        boost::mutex time_sync_lock; // held while device time is set, and by allocateCapacity and setTunerEnable, before any other lock
 
         // usrp helper functions/etc.
         void clearBookkeeping(); // clear bookkeeping when not associated with a H/W device
@@ -313,23 +727,81 @@ class USRP_UHD_i : public USRP_UHD_base
         double optimizeRate(const double& req_rate, const size_t tuner_id);
         double optimizeBandwidth(const double& req_bw, const size_t tuner_id);
         void updateSriTimes(BULKIO::StreamSRI *sri, double timeUp, double timeDown, frontend::timeTypes timeType);
+        double getTunerMaxLatency(size_t tuner_id);
+        void updateTunerMaxLatency();
+        bool getLowLatencySettings(const std::string& allocation_id, low_latency_allocation_struct& settings);
+        void setLowLatencyMode(size_t tuner_id, bool enable, const low_latency_allocation_struct& settings);
+        void startLowLatencyThread(size_t tuner_id, short cpu_core);
+        void updateLowLatencyMetrics(size_t tuner_id);
+        bool validateTuneBatch(const std::vector<frontend::frontend_tuner_allocation_struct>& requests,
+                               const std::vector<frontend::frontend_tuner_allocation_struct>& listeners);
+        bool endTuneBatch();
+        void getHopSchedule(const std::string& allocation_id, size_t tuner_id, std::vector<hop_struct>& hops);
+        void setHopSchedule(size_t tuner_id, const std::vector<hop_struct>& hops);
+        void queueHops(size_t tuner_id, const uhd::time_spec_t& stream_time);
+        void queueRetune(size_t tuner_id, double freq);
+        size_t splitAtHop(size_t tuner_id, const uhd::time_spec_t& time_spec, size_t num_samps);
+        bool getScanSettings(const std::string& allocation_id, size_t tuner_id, spectrum_scan_struct& settings);
+        void setScanMode(size_t tuner_id, bool enable, const spectrum_scan_struct& settings);
+        void scanRxBuffer(size_t tuner_id);
+        double rxSampleRate(size_t tuner_id);
+        void resampleRxBuffer(size_t tuner_id);
+        void setShmOutput(size_t tuner_id, const shm_output_struct& settings);
+        void publishRxBuffer(size_t tuner_id, bool eos, const std::string& stream_id);
+        void pushRxBuffer(size_t tuner_id);
+        std::vector<short>& rxPushBuffer(size_t tuner_id);
+        void measureRx(size_t tuner_id, size_t num_samps);
+        void updateSignalStats(size_t tuner_id);
+        void updateHotPathMetrics();
+        void updatePushQueueMetrics();
+        void configurePushQueues(const rx_push_queue_struct& settings);
+        void updateLatencyHistograms();
+        void dumpHotPathMetrics(const std::string& path, const std::vector<hot_path_metric_struct>& metrics);
+        double agcGainAdjustment(const sampleStats& stats, bool one_shot, const rx_agc_struct& settings, double full_scale, double target_dbfs);
 
         // interface with usrp device
         void updateAvailableDevices();
         void initUsrp() throw (CF::PropertySet::InvalidConfiguration);
+        void initUsrpWithRetry() throw (CF::PropertySet::InvalidConfiguration);
         void updateDeviceInfo();
-        void updateDeviceRxGain(double gain,bool lock=true);
+        void refreshChannelInfo(size_t tuner_id);
+        void buildRateIndex(size_t tuner_id);
+        void indexRFInfoPorts();
+        str2rfinfo_map_t::iterator findRFInfoPort(size_t tuner_id, const std::string& antenna);
+        static std::string connectionKey(const std::string& connection_id, const std::string& port_name, const std::string& stream_id);
+        void indexConnectionTable();
+        void updateConnectionFilters();
+        bool addConnection(const std::string& connection_id, const std::string& port_name, const std::string& stream_id);
+        size_t eraseConnections(const id_set_t& connection_ids, const std::string* stream_id);
+        id_set_t routedConnectionIds(const std::string& allocation_id);
+        void addChannelRFInfo(const std::string& dir, size_t chan, size_t tuner_id, const std::vector<std::string>& antennas);
+        void readChannelInfo(bool tx, size_t chan, usrp_channel_struct& availChan, usrpRangesStruct& ranges, std::string& error);
+        void updateDeviceRxGain(double gain);
         void updateDeviceTxGain(double gain);
-        void updateDeviceReferenceSource(std::string source);
-        long usrpReceive(size_t tuner_id, double timeout = 0.0);
+        bool updateDeviceReferenceSource(std::string source);
+        time_sync_status_struct syncDeviceTime(usrpBackend::sptr device, bool pps);
+        void syncCurrentDeviceTime();
+        long usrpReceive(size_t tuner_id, double timeout = 0.0, bool one_packet = false);
         template <class PACKET_TYPE> bool usrpTransmit(size_t tuner_id, PACKET_TYPE *packet);
         bool usrpEnable(size_t tuner_id);
         bool usrpDisable(size_t tuner_id);
+        void usrpStartStream(size_t tuner_id, bool stream_now, const uhd::time_spec_t& start_time);
         bool usrpCreateRxStream(size_t tuner_id);
         template <class PACKET_ELEMENT_TYPE> bool usrpCreateTxStream(size_t tuner_id);
 
         // UHD driver specific
-        uhd::usrp::multi_usrp::sptr usrp_device_ptr;
+        static const size_t init_attempts = 5; // initUsrpWithRetry
+        static const useconds_t init_backoff_us = 50000; // doubled after each failed attempt
+        static const size_t max_rate_index = 65536; // most decimations in a buildRateIndex index
+        static const size_t hop_queue_depth = 4; // most timed retunes pending on the device per tuner
+        static const long hop_lead_us = 5000; // least time ahead a retune is sent
+        static const long hop_lookahead_us = 100000; // most time ahead a retune is sent
+        static const long max_start_delay_us = 50000; // timed stream start, well within the recv timeout
+        static const long batch_lead_us = 20000; // time ahead the retunes of a batch are sent, plus batch_tuner_lead_us per tuner
+        static const long batch_tuner_lead_us = 25000; // time allowed to configure each tuner of a batch
+        static const long batch_settle_us = 2000; // least time after the retunes of a batch that its streams start
+        usrpBackend::sptr usrp_device_ptr; // USRP hardware, or usrp_sim
+        simBackend::sptr usrp_sim; // set when target_device.type is "sim"
         uhd::device_addr_t usrp_device_addr;
 
     protected:
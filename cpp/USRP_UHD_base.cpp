@@ -243,6 +243,42 @@ void USRP_UHD_base::loadProperties()
                 "external",
                 "property");
 
+    addProperty(max_latency_ms,
+                0.0,
+                "max_latency_ms",
+                "max_latency_ms",
+                "readwrite",
+                "ms",
+                "external",
+                "property");
+
+    addProperty(signal_stats_period_ms,
+                1000.0,
+                "signal_stats_period_ms",
+                "signal_stats_period_ms",
+                "readwrite",
+                "ms",
+                "external",
+                "property");
+
+    addProperty(reset_latency_histograms,
+                false,
+                "reset_latency_histograms",
+                "reset_latency_histograms",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(trigger_trace_dump,
+                false,
+                "trigger_trace_dump",
+                "trigger_trace_dump",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
     addProperty(sdds_settings,
                 sdds_settings_struct(),
                 "sdds_settings",
@@ -279,6 +315,105 @@ void USRP_UHD_base::loadProperties()
                 "external",
                 "property");
 
+    addProperty(rx_agc,
+                rx_agc_struct(),
+                "rx_agc",
+                "rx_agc",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(rx_enable,
+                rx_enable_struct(),
+                "rx_enable",
+                "rx_enable",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(rx_resampler,
+                rx_resampler_struct(),
+                "rx_resampler",
+                "rx_resampler",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(shm_output,
+                shm_output_struct(),
+                "shm_output",
+                "shm_output",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(rx_push_queue,
+                rx_push_queue_struct(),
+                "rx_push_queue",
+                "rx_push_queue",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(hot_path_metrics_settings,
+                hot_path_metrics_settings_struct(),
+                "hot_path_metrics_settings",
+                "hot_path_metrics_settings",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(trace_settings,
+                trace_settings_struct(),
+                "trace_settings",
+                "trace_settings",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(sim_device,
+                sim_device_struct(),
+                "sim_device",
+                "sim_device",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(spectrum_scan,
+                spectrum_scan_struct(),
+                "spectrum_scan",
+                "spectrum_scan",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(spectrum_scan_result,
+                spectrum_scan_result_struct(),
+                "spectrum_scan_result",
+                "spectrum_scan_result",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(time_sync_status,
+                time_sync_status_struct(),
+                "time_sync_status",
+                "time_sync_status",
+                "readonly",
+                "",
+                "external",
+                "property");
+
     frontend_tuner_allocation = frontend::frontend_tuner_allocation_struct();
     frontend_listener_allocation = frontend::frontend_listener_allocation_struct();
     addProperty(sdds_network_settings,
@@ -313,6 +448,70 @@ void USRP_UHD_base::loadProperties()
                 "external",
                 "property");
 
+    addProperty(tuner_max_latency,
+                "tuner_max_latency",
+                "tuner_max_latency",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(low_latency_allocations,
+                "low_latency_allocations",
+                "low_latency_allocations",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(hop_schedule,
+                "hop_schedule",
+                "hop_schedule",
+                "readwrite",
+                "",
+                "external",
+                "property");
+
+    addProperty(low_latency_metrics,
+                "low_latency_metrics",
+                "low_latency_metrics",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(tuner_signal_stats,
+                "tuner_signal_stats",
+                "tuner_signal_stats",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(hot_path_metrics,
+                "hot_path_metrics",
+                "hot_path_metrics",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(latency_histograms,
+                "latency_histograms",
+                "latency_histograms",
+                "readonly",
+                "",
+                "external",
+                "property");
+
+    addProperty(push_queue_metrics,
+                "push_queue_metrics",
+                "push_queue_metrics",
+                "readonly",
+                "",
+                "external",
+                "property");
+
     addProperty(connectionTable,
                 "connectionTable",
                 "",
@@ -79,6 +79,14 @@ class USRP_UHD_base : public frontend::FrontendTunerDevice<frontend_tuner_status
         bool trigger_rx_autogain;
         /// Property: rx_autogain_guard_bits
         unsigned short rx_autogain_guard_bits;
+        /// Property: max_latency_ms
+        double max_latency_ms;
+        /// Property: signal_stats_period_ms
+        double signal_stats_period_ms;
+        /// Property: reset_latency_histograms
+        bool reset_latency_histograms;
+        /// Property: trigger_trace_dump
+        bool trigger_trace_dump;
         /// Property: sdds_settings
         sdds_settings_struct sdds_settings;
         /// Property: target_device
@@ -87,6 +95,28 @@ class USRP_UHD_base : public frontend::FrontendTunerDevice<frontend_tuner_status
         device_antenna_mapping_struct device_antenna_mapping;
         /// Property: configure_tuner_antenna
         configure_tuner_antenna_struct configure_tuner_antenna;
+        /// Property: rx_agc
+        rx_agc_struct rx_agc;
+        /// Property: rx_enable
+        rx_enable_struct rx_enable;
+        /// Property: rx_resampler
+        rx_resampler_struct rx_resampler;
+        /// Property: shm_output
+        shm_output_struct shm_output;
+        /// Property: rx_push_queue
+        rx_push_queue_struct rx_push_queue;
+        /// Property: hot_path_metrics_settings
+        hot_path_metrics_settings_struct hot_path_metrics_settings;
+        /// Property: trace_settings
+        trace_settings_struct trace_settings;
+        /// Property: sim_device
+        sim_device_struct sim_device;
+        /// Property: spectrum_scan
+        spectrum_scan_struct spectrum_scan;
+        /// Property: spectrum_scan_result
+        spectrum_scan_result_struct spectrum_scan_result;
+        /// Property: time_sync_status
+        time_sync_status_struct time_sync_status;
         /// Property: sdds_network_settings
         std::vector<sdds_network_settings_struct_struct> sdds_network_settings;
         /// Property: available_devices
@@ -95,6 +125,22 @@ class USRP_UHD_base : public frontend::FrontendTunerDevice<frontend_tuner_status
         std::vector<usrp_motherboard_struct> device_motherboards;
         /// Property: device_channels
         std::vector<usrp_channel_struct> device_channels;
+        /// Property: tuner_max_latency
+        std::vector<tuner_latency_struct> tuner_max_latency;
+        /// Property: low_latency_allocations
+        std::vector<low_latency_allocation_struct> low_latency_allocations;
+        /// Property: hop_schedule
+        std::vector<hop_struct> hop_schedule;
+        /// Property: low_latency_metrics
+        std::vector<low_latency_metric_struct> low_latency_metrics;
+        /// Property: tuner_signal_stats
+        std::vector<tuner_signal_stat_struct> tuner_signal_stats;
+        /// Property: hot_path_metrics
+        std::vector<hot_path_metric_struct> hot_path_metrics;
+        /// Property: latency_histograms
+        std::vector<latency_histogram_struct> latency_histograms;
+        /// Property: push_queue_metrics
+        std::vector<push_queue_metric_struct> push_queue_metrics;
         /// Property: connectionTable
         std::vector<connection_descriptor_struct> connectionTable;
 
@@ -0,0 +1,214 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+#ifndef USRP_UHD_USRPBACKEND_H
+#define USRP_UHD_USRPBACKEND_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <uhd/usrp/multi_usrp.hpp>
+
+/** The subset of uhd::usrp::multi_usrp used by the device. All hardware access goes through this interface,
+ *  so that a USRP can be replaced by a simulated one (see simBackend). Functions have the same names and
+ *  arguments as their multi_usrp counterparts, and the same semantics unless noted.
+ */
+class usrpBackend {
+public:
+    typedef boost::shared_ptr<usrpBackend> sptr;
+    static const size_t ALL_MBOARDS = size_t(~0);
+    static const size_t ALL_CHANS = size_t(~0);
+
+    virtual ~usrpBackend() {}
+
+    // motherboard
+    virtual size_t get_num_mboards() = 0;
+    virtual std::string get_mboard_name(size_t mboard = 0) = 0;
+    virtual void set_time_now(const uhd::time_spec_t& time_spec, size_t mboard = ALL_MBOARDS) = 0;
+    virtual void set_clock_source(const std::string& source, size_t mboard = ALL_MBOARDS) = 0;
+    virtual void set_time_source(const std::string& source, size_t mboard = ALL_MBOARDS) = 0;
+    virtual uhd::time_spec_t get_time_now(size_t mboard = 0) = 0;
+    virtual void set_time_next_pps(const uhd::time_spec_t& time_spec, size_t mboard = ALL_MBOARDS) = 0;
+    virtual uhd::time_spec_t get_time_last_pps(size_t mboard = 0) = 0;
+    // not in multi_usrp: the addr (or addrN) the motherboard was made with, empty if none
+    virtual std::string get_mboard_addr(size_t mboard = 0) = 0;
+    // not in multi_usrp: the motherboard a channel is on, from the size of each motherboard's subdev spec
+    virtual size_t get_rx_mboard(size_t chan = 0) = 0;
+    virtual size_t get_tx_mboard(size_t chan = 0) = 0;
+
+    // RX
+    virtual size_t get_rx_num_channels() = 0;
+    virtual std::string get_rx_subdev_name(size_t chan = 0) = 0;
+    virtual uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t& args) = 0;
+    virtual void issue_stream_cmd(const uhd::stream_cmd_t& stream_cmd, size_t chan = ALL_CHANS) = 0;
+    virtual void set_rx_rate(double rate, size_t chan = ALL_CHANS) = 0;
+    virtual double get_rx_rate(size_t chan = 0) = 0;
+    virtual uhd::meta_range_t get_rx_rates(size_t chan = 0) = 0;
+    virtual uhd::tune_result_t set_rx_freq(const uhd::tune_request_t& tune_request, size_t chan = 0) = 0;
+    // multi_usrp: set_command_time(cmd_time), set_rx_freq(tune_request, chan), clear_command_time()
+    // the retune takes effect at device time cmd_time, or immediately if cmd_time has passed
+    virtual uhd::tune_result_t set_rx_freq_timed(const uhd::tune_request_t& tune_request, const uhd::time_spec_t& cmd_time, size_t chan = 0) = 0;
+    virtual double get_rx_freq(size_t chan = 0) = 0;
+    virtual uhd::freq_range_t get_rx_freq_range(size_t chan = 0) = 0;
+    virtual void set_rx_gain(double gain, size_t chan = 0) = 0;
+    virtual double get_rx_gain(size_t chan = 0) = 0;
+    virtual uhd::gain_range_t get_rx_gain_range(size_t chan = 0) = 0;
+    virtual void set_rx_antenna(const std::string& ant, size_t chan = 0) = 0;
+    virtual std::string get_rx_antenna(size_t chan = 0) = 0;
+    virtual std::vector<std::string> get_rx_antennas(size_t chan = 0) = 0;
+    virtual void set_rx_bandwidth(double bandwidth, size_t chan = 0) = 0;
+    virtual double get_rx_bandwidth(size_t chan = 0) = 0;
+    virtual uhd::meta_range_t get_rx_bandwidth_range(size_t chan = 0) = 0;
+    virtual uhd::sensor_value_t get_rx_sensor(const std::string& name, size_t chan = 0) = 0;
+    // multi_usrp: get_rx_dboard_iface(chan)->get_clock_rates(UNIT_RX)
+    virtual std::vector<double> get_rx_clock_rates(size_t chan = 0) = 0;
+
+    // TX
+    virtual size_t get_tx_num_channels() = 0;
+    virtual std::string get_tx_subdev_name(size_t chan = 0) = 0;
+    virtual uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t& args) = 0;
+    virtual void set_tx_rate(double rate, size_t chan = ALL_CHANS) = 0;
+    virtual double get_tx_rate(size_t chan = 0) = 0;
+    virtual uhd::meta_range_t get_tx_rates(size_t chan = 0) = 0;
+    virtual uhd::tune_result_t set_tx_freq(const uhd::tune_request_t& tune_request, size_t chan = 0) = 0;
+    virtual double get_tx_freq(size_t chan = 0) = 0;
+    virtual uhd::freq_range_t get_tx_freq_range(size_t chan = 0) = 0;
+    virtual void set_tx_gain(double gain, size_t chan = 0) = 0;
+    virtual double get_tx_gain(size_t chan = 0) = 0;
+    virtual uhd::gain_range_t get_tx_gain_range(size_t chan = 0) = 0;
+    virtual void set_tx_antenna(const std::string& ant, size_t chan = 0) = 0;
+    virtual std::string get_tx_antenna(size_t chan = 0) = 0;
+    virtual std::vector<std::string> get_tx_antennas(size_t chan = 0) = 0;
+    virtual void set_tx_bandwidth(double bandwidth, size_t chan = 0) = 0;
+    virtual double get_tx_bandwidth(size_t chan = 0) = 0;
+    virtual uhd::meta_range_t get_tx_bandwidth_range(size_t chan = 0) = 0;
+    // multi_usrp: get_tx_dboard_iface(chan)->get_clock_rates(UNIT_TX)
+    virtual std::vector<double> get_tx_clock_rates(size_t chan = 0) = 0;
+};
+
+/** usrpBackend for real hardware, which forwards each call to a uhd::usrp::multi_usrp. A command time applies
+ *  to every command sent to the motherboard until it is cleared, by any thread, so the set_* functions hold
+ *  command_lock to keep them out of the window in set_rx_freq_timed.
+ */
+class uhdBackend : public usrpBackend {
+public:
+    uhdBackend(const uhd::device_addr_t& addr) : usrp(uhd::usrp::multi_usrp::make(addr)), args(addr) {}
+
+    size_t get_num_mboards() { return usrp->get_num_mboards(); }
+    std::string get_mboard_name(size_t mboard) { return usrp->get_mboard_name(mboard); }
+    void set_time_now(const uhd::time_spec_t& time_spec, size_t mboard) { guard g(command_lock); usrp->set_time_now(time_spec, mboard); }
+    void set_clock_source(const std::string& source, size_t mboard) { guard g(command_lock); usrp->set_clock_source(source, mboard); }
+    void set_time_source(const std::string& source, size_t mboard) { guard g(command_lock); usrp->set_time_source(source, mboard); }
+    uhd::time_spec_t get_time_now(size_t mboard) { return usrp->get_time_now(mboard); }
+    void set_time_next_pps(const uhd::time_spec_t& time_spec, size_t mboard) { guard g(command_lock); usrp->set_time_next_pps(time_spec, mboard); }
+    uhd::time_spec_t get_time_last_pps(size_t mboard) { return usrp->get_time_last_pps(mboard); }
+    std::string get_mboard_addr(size_t mboard) {
+        std::ostringstream key;
+        key << "addr" << mboard;
+        if (args.has_key(key.str()))
+            return args[key.str()];
+        return (mboard == 0) ? args.get("addr", "") : "";
+    }
+    size_t get_rx_mboard(size_t chan) {
+        for (size_t mboard = 0; mboard < usrp->get_num_mboards(); mboard++) {
+            const size_t num_chans = usrp->get_rx_subdev_spec(mboard).size();
+            if (chan < num_chans)
+                return mboard;
+            chan -= num_chans;
+        }
+        return 0;
+    }
+    size_t get_tx_mboard(size_t chan) {
+        for (size_t mboard = 0; mboard < usrp->get_num_mboards(); mboard++) {
+            const size_t num_chans = usrp->get_tx_subdev_spec(mboard).size();
+            if (chan < num_chans)
+                return mboard;
+            chan -= num_chans;
+        }
+        return 0;
+    }
+
+    size_t get_rx_num_channels() { return usrp->get_rx_num_channels(); }
+    std::string get_rx_subdev_name(size_t chan) { return usrp->get_rx_subdev_name(chan); }
+    uhd::rx_streamer::sptr get_rx_stream(const uhd::stream_args_t& args) { return usrp->get_rx_stream(args); }
+    void issue_stream_cmd(const uhd::stream_cmd_t& stream_cmd, size_t chan) { guard g(command_lock); usrp->issue_stream_cmd(stream_cmd, chan); }
+    void set_rx_rate(double rate, size_t chan) { guard g(command_lock); usrp->set_rx_rate(rate, chan); }
+    double get_rx_rate(size_t chan) { return usrp->get_rx_rate(chan); }
+    uhd::meta_range_t get_rx_rates(size_t chan) { return usrp->get_rx_rates(chan); }
+    uhd::tune_result_t set_rx_freq(const uhd::tune_request_t& tune_request, size_t chan) { guard g(command_lock); return usrp->set_rx_freq(tune_request, chan); }
+    uhd::tune_result_t set_rx_freq_timed(const uhd::tune_request_t& tune_request, const uhd::time_spec_t& cmd_time, size_t chan) {
+        guard g(command_lock);
+        usrp->set_command_time(cmd_time);
+        try {
+            uhd::tune_result_t result = usrp->set_rx_freq(tune_request, chan);
+            usrp->clear_command_time();
+            return result;
+        } catch (...) {
+            usrp->clear_command_time();
+            throw;
+        }
+    }
+    double get_rx_freq(size_t chan) { return usrp->get_rx_freq(chan); }
+    uhd::freq_range_t get_rx_freq_range(size_t chan) { return usrp->get_rx_freq_range(chan); }
+    void set_rx_gain(double gain, size_t chan) { guard g(command_lock); usrp->set_rx_gain(gain, chan); }
+    double get_rx_gain(size_t chan) { return usrp->get_rx_gain(chan); }
+    uhd::gain_range_t get_rx_gain_range(size_t chan) { return usrp->get_rx_gain_range(chan); }
+    void set_rx_antenna(const std::string& ant, size_t chan) { guard g(command_lock); usrp->set_rx_antenna(ant, chan); }
+    std::string get_rx_antenna(size_t chan) { return usrp->get_rx_antenna(chan); }
+    std::vector<std::string> get_rx_antennas(size_t chan) { return usrp->get_rx_antennas(chan); }
+    void set_rx_bandwidth(double bandwidth, size_t chan) { guard g(command_lock); usrp->set_rx_bandwidth(bandwidth, chan); }
+    double get_rx_bandwidth(size_t chan) { return usrp->get_rx_bandwidth(chan); }
+    uhd::meta_range_t get_rx_bandwidth_range(size_t chan) { return usrp->get_rx_bandwidth_range(chan); }
+    uhd::sensor_value_t get_rx_sensor(const std::string& name, size_t chan) { return usrp->get_rx_sensor(name, chan); }
+    std::vector<double> get_rx_clock_rates(size_t chan) {
+        return usrp->get_rx_dboard_iface(chan)->get_clock_rates(uhd::usrp::dboard_iface::UNIT_RX);
+    }
+
+    size_t get_tx_num_channels() { return usrp->get_tx_num_channels(); }
+    std::string get_tx_subdev_name(size_t chan) { return usrp->get_tx_subdev_name(chan); }
+    uhd::tx_streamer::sptr get_tx_stream(const uhd::stream_args_t& args) { return usrp->get_tx_stream(args); }
+    void set_tx_rate(double rate, size_t chan) { guard g(command_lock); usrp->set_tx_rate(rate, chan); }
+    double get_tx_rate(size_t chan) { return usrp->get_tx_rate(chan); }
+    uhd::meta_range_t get_tx_rates(size_t chan) { return usrp->get_tx_rates(chan); }
+    uhd::tune_result_t set_tx_freq(const uhd::tune_request_t& tune_request, size_t chan) { guard g(command_lock); return usrp->set_tx_freq(tune_request, chan); }
+    double get_tx_freq(size_t chan) { return usrp->get_tx_freq(chan); }
+    uhd::freq_range_t get_tx_freq_range(size_t chan) { return usrp->get_tx_freq_range(chan); }
+    void set_tx_gain(double gain, size_t chan) { guard g(command_lock); usrp->set_tx_gain(gain, chan); }
+    double get_tx_gain(size_t chan) { return usrp->get_tx_gain(chan); }
+    uhd::gain_range_t get_tx_gain_range(size_t chan) { return usrp->get_tx_gain_range(chan); }
+    void set_tx_antenna(const std::string& ant, size_t chan) { guard g(command_lock); usrp->set_tx_antenna(ant, chan); }
+    std::string get_tx_antenna(size_t chan) { return usrp->get_tx_antenna(chan); }
+    std::vector<std::string> get_tx_antennas(size_t chan) { return usrp->get_tx_antennas(chan); }
+    void set_tx_bandwidth(double bandwidth, size_t chan) { guard g(command_lock); usrp->set_tx_bandwidth(bandwidth, chan); }
+    double get_tx_bandwidth(size_t chan) { return usrp->get_tx_bandwidth(chan); }
+    uhd::meta_range_t get_tx_bandwidth_range(size_t chan) { return usrp->get_tx_bandwidth_range(chan); }
+    std::vector<double> get_tx_clock_rates(size_t chan) {
+        return usrp->get_tx_dboard_iface(chan)->get_clock_rates(uhd::usrp::dboard_iface::UNIT_TX);
+    }
+
+private:
+    typedef boost::mutex::scoped_lock guard;
+    uhd::usrp::multi_usrp::sptr usrp;
+    const uhd::device_addr_t args;
+    boost::mutex command_lock;
+};
+
+#endif
@@ -0,0 +1,587 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* queue_bench: throughput, latency, fairness and shutdown stress for the queues between the device and the
+ * SddsProcessor thread. Runs without a USRP, a domain or a network. Modes:
+ *
+ *   pipeline  BoundedBuffer<short> plus BlockingReadFifo of block metadata, used as SddsProcessor uses them:
+ *             the producer trywrite()s each block and pushes its metadata, the consumer pops the metadata and
+ *             reads the samples a packet at a time with front(n)/skip(n), which copies past buf_capacity when
+ *             a read wraps. Samples that do not fit are dropped, as in dataIn(). Latency is from the push of
+ *             a block to the skip() of its last sample. With -v every sample read is checked.
+ *   fifo      BlockingReadFifo alone, with -n producers pushing as fast as they can (each waits while the
+ *             fifo holds more than 1024 items) and one consumer. fair is the fewest items pushed by one
+ *             producer over the most, 1.0 when the mutex is shared evenly. Latency is from push to pop.
+ *   stress    start a consumer blocked in BlockingReadFifo::pop(), push a few items, then stop it the way
+ *             SddsProcessor::join() does (interrupt() and join). A consumer still running after 1 s is a
+ *             hang; it is released with another push so the run can go on. Latency is interrupt to join.
+ *
+ * Each run can pin the producers and the consumer to CPUs (-c), to compare e.g. the same core, hyperthread
+ * siblings and separate sockets. The queue types are template parameters of runPipeline() and runFifo(), so
+ * a replacement queue is measured against the current one by adding a row for it in main().
+ *
+ *   make queue_bench
+ *   ./queue_bench -m pipeline -b 1024,16384 -c any,0:1 -v
+ */
+
+#include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <sstream>
+#include <boost/thread.hpp>
+
+#include "HotPathMetrics.h"
+#include "sdds/BlockingReadFifo.h"
+#include "sdds/BoundedBuffer.h"
+
+namespace {
+
+const size_t PACKET_SHORTS = 512; // SDDS_DATA_SIZE/sizeof(short), what SddsProcessor reads at a time
+const size_t FIFO_MAX_ITEMS = 1024;
+const uint64_t HANG_NS = 1000000000ULL;
+
+struct placement {
+    placement() : producer_cpu(-1), consumer_cpu(-1) {}
+
+    std::string name() const {
+        if (producer_cpu < 0)
+            return "any";
+        std::ostringstream out;
+        out << producer_cpu << ":" << consumer_cpu;
+        return out.str();
+    }
+
+    int producer_cpu; // -1 to leave the thread unpinned
+    int consumer_cpu;
+};
+
+struct benchOptions {
+    benchOptions() : duration_s(2.0), rate_msps(0.0), producers(1), buffer_cnt(20000), verify(false) {}
+
+    std::vector<std::string> modes;
+    std::vector<size_t> block_samps;
+    std::vector<placement> placements;
+    double duration_s;
+    double rate_msps; // 0 for as fast as possible
+    size_t producers;
+    size_t buffer_cnt;
+    bool verify;
+};
+
+/** What the pipeline producer pushes for each block, like the SDDS metadata. */
+struct blockMeta {
+    blockMeta() : samps(0), first(0), producer(0), seq(0), input_ns(0), last(false) {}
+
+    size_t samps; // shorts written to the data queue
+    uint64_t first; // index of the first short in the stream of shorts written
+    size_t producer;
+    uint64_t seq;
+    uint64_t input_ns;
+    bool last;
+};
+
+struct threadStats {
+    threadStats() : items(0), shorts(0), dropped(0), errors(0), cpu_s(0.0), pinned(true) {}
+
+    uint64_t items;
+    uint64_t shorts;
+    uint64_t dropped;
+    uint64_t errors; // bad sample values, or items out of order
+    double cpu_s;
+    bool pinned;
+};
+
+double threadCpuSeconds(){
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+bool pinThread(int cpu){
+    if (cpu < 0)
+        return true;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    return pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) == 0;
+}
+
+void sleepUntil(uint64_t deadline_ns){
+    struct timespec ts;
+    ts.tv_sec = deadline_ns/1000000000ULL;
+    ts.tv_nsec = deadline_ns%1000000000ULL;
+    clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+}
+
+void printLatency(const latencySummary& latency){
+    printf(" %9.1f %9.1f %9.1f %9.1f\n", latency.p50*1e-3, latency.p99*1e-3, latency.p999*1e-3, latency.max*1e-3);
+}
+
+/** One producer and one consumer of a data queue and a metadata queue, with the interface of BoundedBuffer
+ *  and BlockingReadFifo.
+ */
+template <class DataQueue, class MetaQueue>
+class pipelineRun {
+public:
+    pipelineRun(const benchOptions& opts, const placement& where, size_t block_samps) :
+        opts(opts), where(where), block_shorts(2*block_samps),
+        data_q(opts.buffer_cnt*PACKET_SHORTS, 2*PACKET_SHORTS-1) {}
+
+    void run(){
+        start_ns = hotPathNow();
+        boost::thread consumer(&pipelineRun::consume, this);
+        boost::thread producer(&pipelineRun::produce, this);
+        producer.join();
+        consumer.join();
+        wall_s = (hotPathNow()-start_ns)*1e-9;
+    }
+
+    threadStats produced;
+    threadStats consumed;
+    latencyHistogram latency;
+    double wall_s;
+    size_t high_water() { return data_q.high_water_mark(); }
+
+private:
+    void produce(){
+        produced.pinned = pinThread(where.producer_cpu);
+        std::vector<short> block(block_shorts);
+        const uint64_t block_ns = opts.rate_msps > 0 ? uint64_t(block_shorts/2/opts.rate_msps*1e3) : 0;
+        const uint64_t end_ns = start_ns + uint64_t(opts.duration_s*1e9);
+        uint64_t deadline_ns = start_ns + block_ns;
+        uint64_t written = 0;
+        blockMeta meta;
+        while (deadline_ns <= end_ns && hotPathNow() < end_ns) {
+            if (block_ns > 0)
+                sleepUntil(deadline_ns);
+            if (opts.verify) {
+                for (size_t i = 0; i < block_shorts; i++)
+                    block[i] = short(written+i);
+            }
+            const size_t samps = data_q.trywrite(&block[0], block_shorts);
+            produced.dropped += block_shorts - samps;
+            if (samps > 0) {
+                // unlike dataIn(), a block that was dropped entirely is not queued, which would only grow
+                // the metadata queue without bound when the producer is not paced
+                meta.samps = samps;
+                meta.first = written;
+                meta.seq = produced.items++;
+                meta.input_ns = hotPathNow();
+                meta_q.push(meta);
+                written += samps;
+            }
+            deadline_ns += block_ns;
+        }
+        produced.shorts = written;
+        meta = blockMeta();
+        meta.last = true;
+        meta_q.push(meta);
+        produced.cpu_s = threadCpuSeconds();
+    }
+
+    void consume(){
+        consumed.pinned = pinThread(where.consumer_cpu);
+        blockMeta meta;
+        while (meta_q.pop(meta) && !meta.last) {
+            size_t offset = 0;
+            while (offset < meta.samps) {
+                const size_t read = std::min(meta.samps-offset, PACKET_SHORTS);
+                const short* samples = &data_q.front(read);
+                if (opts.verify) {
+                    const uint64_t first = meta.first + offset;
+                    for (size_t i = 0; i < read; i++) {
+                        if (samples[i] != short(first+i))
+                            consumed.errors++;
+                    }
+                }
+                data_q.skip(read);
+                offset += read;
+            }
+            consumed.shorts += meta.samps;
+            if (meta.seq != consumed.items++)
+                consumed.errors++;
+            latency.record(int64_t(hotPathNow()-meta.input_ns));
+        }
+        consumed.cpu_s = threadCpuSeconds();
+    }
+
+    const benchOptions& opts;
+    placement where;
+    size_t block_shorts;
+    uint64_t start_ns;
+    DataQueue data_q;
+    MetaQueue meta_q;
+};
+
+/** Several producers and one consumer of a queue with the interface of BlockingReadFifo. */
+template <class Fifo>
+class fifoRun {
+public:
+    fifoRun(const benchOptions& opts, const placement& where) : produced(opts.producers),
+        consumed_per_producer(opts.producers), opts(opts), where(where), next_seq(opts.producers) {}
+
+    void run(){
+        start_ns = hotPathNow();
+        boost::thread consumer(&fifoRun::consume, this);
+        boost::thread_group producers;
+        for (size_t p = 0; p < opts.producers; p++)
+            producers.create_thread(boost::bind(&fifoRun::produce, this, p));
+        producers.join_all();
+        blockMeta meta;
+        meta.last = true;
+        fifo.push(meta);
+        consumer.join();
+        wall_s = (hotPathNow()-start_ns)*1e-9;
+    }
+
+    std::vector<threadStats> produced;
+    threadStats consumed;
+    std::vector<uint64_t> consumed_per_producer;
+    latencyHistogram latency;
+    double wall_s;
+
+private:
+    void produce(size_t producer){
+        threadStats& stats = produced[producer];
+        stats.pinned = pinThread(where.producer_cpu);
+        const uint64_t end_ns = start_ns + uint64_t(opts.duration_s*1e9);
+        blockMeta meta;
+        meta.producer = producer;
+        while (hotPathNow() < end_ns) {
+            // size() takes the lock too, so only check it every so often
+            if (stats.items % 64 == 0) {
+                while (fifo.size() > FIFO_MAX_ITEMS && hotPathNow() < end_ns)
+                    boost::this_thread::yield();
+            }
+            meta.seq = stats.items++;
+            meta.input_ns = hotPathNow();
+            fifo.push(meta);
+        }
+        stats.cpu_s = threadCpuSeconds();
+    }
+
+    void consume(){
+        consumed.pinned = pinThread(where.consumer_cpu);
+        blockMeta meta;
+        while (fifo.pop(meta) && !meta.last) {
+            latency.record(int64_t(hotPathNow()-meta.input_ns));
+            if (meta.seq != next_seq[meta.producer])
+                consumed.errors++;
+            next_seq[meta.producer] = meta.seq+1;
+            consumed_per_producer[meta.producer]++;
+            consumed.items++;
+        }
+        consumed.cpu_s = threadCpuSeconds();
+    }
+
+    const benchOptions& opts;
+    placement where;
+    uint64_t start_ns;
+    Fifo fifo;
+    std::vector<uint64_t> next_seq;
+};
+
+/** Starts and stops a consumer of a BlockingReadFifo the way SddsProcessor::join() stops its thread. */
+class stressCycle {
+public:
+    stressCycle(const placement& where, uint32_t& random) : where(where), stop(false), items(0), pinned(true),
+        random(random) {}
+
+    // returns the time from interrupt() until the consumer was joined, or 0 if it was not joined in HANG_NS
+    uint64_t run(uint64_t& release_ns){
+        boost::thread consumer(&stressCycle::consume, this);
+        pinThread(where.producer_cpu);
+        // push a few items and wait a little, so the consumer is caught at a different point each time
+        blockMeta meta;
+        const size_t pushes = nextRandom() % 4;
+        for (size_t i = 0; i < pushes; i++)
+            fifo.push(meta);
+        const uint64_t wait_ns = nextRandom() % 50000;
+        if (wait_ns > 1000)
+            sleepUntil(hotPathNow() + wait_ns);
+
+        stop = true;
+        const uint64_t interrupt_ns = hotPathNow();
+        fifo.interrupt();
+        if (consumer.timed_join(boost::posix_time::microseconds(HANG_NS/1000)))
+            return hotPathNow() - interrupt_ns;
+
+        // hung in pop(); a push wakes it up
+        const uint64_t release_start_ns = hotPathNow();
+        while (!consumer.timed_join(boost::posix_time::milliseconds(10)))
+            fifo.push(meta);
+        release_ns = hotPathNow() - release_start_ns;
+        return 0;
+    }
+
+    bool consumerPinned() const { return pinned; }
+
+private:
+    void consume(){
+        pinned = pinThread(where.consumer_cpu);
+        blockMeta meta;
+        while (!stop) {
+            if (fifo.pop(meta))
+                items++;
+        }
+    }
+
+    uint32_t nextRandom(){
+        random ^= random << 13;
+        random ^= random >> 17;
+        random ^= random << 5;
+        return random;
+    }
+
+    placement where;
+    BlockingReadFifo<blockMeta> fifo;
+    volatile bool stop;
+    uint64_t items;
+    bool pinned;
+    uint32_t& random;
+};
+
+template <class DataQueue, class MetaQueue>
+void runPipeline(const char* queue, const benchOptions& opts, const placement& where, size_t block_samps){
+    pipelineRun<DataQueue, MetaQueue> run(opts, where, block_samps);
+    run.run();
+    const uint64_t offered = run.produced.shorts + run.produced.dropped;
+    printf("%-18s %-7s %8lu %10.2f %8.3f %10.1f %10.1f %9lu %7lu",
+            queue, where.name().c_str(), (unsigned long) block_samps,
+            run.consumed.shorts/2/run.wall_s*1e-6,
+            offered > 0 ? 100.0*run.produced.dropped/offered : 0.0,
+            100.0*run.produced.cpu_s/run.wall_s, 100.0*run.consumed.cpu_s/run.wall_s,
+            (unsigned long) run.high_water(), (unsigned long) run.consumed.errors);
+    printLatency(run.latency.summarize());
+    if (!run.produced.pinned || !run.consumed.pinned)
+        printf("#   could not pin threads to CPUs %s\n", where.name().c_str());
+}
+
+template <class Fifo>
+void runFifo(const char* queue, const benchOptions& opts, const placement& where){
+    fifoRun<Fifo> run(opts, where);
+    run.run();
+    uint64_t pushed = 0;
+    uint64_t fewest = run.produced[0].items;
+    uint64_t most = run.produced[0].items;
+    double producer_cpu_s = 0.0;
+    bool pinned = run.consumed.pinned;
+    for (size_t p = 0; p < run.produced.size(); p++) {
+        pushed += run.produced[p].items;
+        fewest = std::min(fewest, run.produced[p].items);
+        most = std::max(most, run.produced[p].items);
+        producer_cpu_s += run.produced[p].cpu_s;
+        pinned = pinned && run.produced[p].pinned;
+    }
+    printf("%-18s %-7s %8lu %10.3f %8.3f %10.1f %10.1f %9lu %7lu",
+            queue, where.name().c_str(), (unsigned long) opts.producers,
+            run.consumed.items/run.wall_s*1e-6, most > 0 ? double(fewest)/most : 1.0,
+            100.0*producer_cpu_s/run.wall_s, 100.0*run.consumed.cpu_s/run.wall_s,
+            (unsigned long) (pushed-run.consumed.items), (unsigned long) run.consumed.errors);
+    printLatency(run.latency.summarize());
+    if (!pinned)
+        printf("#   could not pin threads to CPUs %s\n", where.name().c_str());
+}
+
+void runStress(const benchOptions& opts, const placement& where){
+    latencyHistogram shutdown;
+    uint64_t cycles = 0;
+    uint64_t hangs = 0;
+    uint64_t worst_release_ns = 0;
+    bool pinned = true;
+    uint32_t random = 2463534242U;
+    cpu_set_t main_cpus; // the cycles pin this thread as the producer
+    pthread_getaffinity_np(pthread_self(), sizeof(main_cpus), &main_cpus);
+    const uint64_t end_ns = hotPathNow() + uint64_t(opts.duration_s*1e9);
+    while (hotPathNow() < end_ns) {
+        stressCycle cycle(where, random);
+        uint64_t release_ns = 0;
+        const uint64_t join_ns = cycle.run(release_ns);
+        if (join_ns > 0) {
+            shutdown.record(int64_t(join_ns));
+        } else {
+            hangs++;
+            worst_release_ns = std::max(worst_release_ns, release_ns);
+        }
+        pinned = pinned && cycle.consumerPinned();
+        cycles++;
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(main_cpus), &main_cpus);
+    printf("%-18s %-7s %10lu %8lu", "BlockingReadFifo", where.name().c_str(), (unsigned long) cycles,
+            (unsigned long) hangs);
+    printLatency(shutdown.summarize());
+    if (hangs > 0)
+        printf("#   %lu consumers missed interrupt(); slowest release by push took %.1f ms\n",
+                (unsigned long) hangs, worst_release_ns*1e-6);
+    if (!pinned)
+        printf("#   could not pin threads to CPUs %s\n", where.name().c_str());
+}
+
+template <class T>
+bool parseList(const char* arg, std::vector<T>& values){
+    values.clear();
+    std::string list(arg);
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos)
+            end = list.size();
+        const double value = atof(list.substr(begin, end-begin).c_str());
+        if (value <= 0)
+            return false;
+        values.push_back(T(value));
+        begin = end+1;
+    }
+    return !values.empty();
+}
+
+bool parseNames(const char* arg, std::vector<std::string>& names){
+    names.clear();
+    std::string list(arg);
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos)
+            end = list.size();
+        names.push_back(list.substr(begin, end-begin));
+        if (names.back().empty())
+            return false;
+        begin = end+1;
+    }
+    return !names.empty();
+}
+
+bool parsePlacements(const char* arg, std::vector<placement>& placements){
+    std::vector<std::string> names;
+    if (!parseNames(arg, names))
+        return false;
+    placements.clear();
+    for (size_t i = 0; i < names.size(); i++) {
+        placement where;
+        if (names[i] != "any") {
+            const size_t colon = names[i].find(':');
+            if (colon == std::string::npos || colon == 0 || colon+1 == names[i].size())
+                return false;
+            where.producer_cpu = atoi(names[i].c_str());
+            where.consumer_cpu = atoi(names[i].c_str()+colon+1);
+            if (where.producer_cpu < 0 || where.consumer_cpu < 0)
+                return false;
+        }
+        placements.push_back(where);
+    }
+    return true;
+}
+
+void usage(const char* name){
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -m MODE[,MODE...]    pipeline, fifo and/or stress (default all three)\n"
+        "  -b SAMPS[,SAMPS...]  complex samples per block in pipeline mode (default 1024,16384)\n"
+        "  -c CPUS[,CPUS...]    thread placements, any or PRODUCER:CONSUMER CPU numbers (default any)\n"
+        "  -d SECONDS           duration of each run (default 2)\n"
+        "  -r MSPS              pace the pipeline producer at this complex sample rate (default 0, unpaced)\n"
+        "  -n COUNT             producers in fifo mode (default 1)\n"
+        "  -q COUNT             BoundedBuffer size in %lu short packets, as for sdds_bench (default 20000)\n"
+        "  -v                   check every sample read in pipeline mode\n",
+        name, (unsigned long) PACKET_SHORTS);
+}
+
+bool selected(const benchOptions& opts, const std::string& mode){
+    return std::find(opts.modes.begin(), opts.modes.end(), mode) != opts.modes.end();
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    benchOptions opts;
+    int opt;
+    while ((opt = getopt(argc, argv, "m:b:c:d:r:n:q:vh")) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'm': ok = parseNames(optarg, opts.modes); break;
+        case 'b': ok = parseList(optarg, opts.block_samps); break;
+        case 'c': ok = parsePlacements(optarg, opts.placements); break;
+        case 'd': opts.duration_s = atof(optarg); ok = opts.duration_s > 0; break;
+        case 'r': opts.rate_msps = atof(optarg); ok = opts.rate_msps >= 0; break;
+        case 'n': opts.producers = atoi(optarg); ok = opts.producers > 0; break;
+        case 'q': opts.buffer_cnt = atoi(optarg); ok = opts.buffer_cnt > 0; break;
+        case 'v': opts.verify = true; break;
+        default: ok = false; break;
+        }
+        for (size_t i = 0; ok && i < opts.modes.size(); i++)
+            ok = opts.modes[i] == "pipeline" || opts.modes[i] == "fifo" || opts.modes[i] == "stress";
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opts.modes.empty()) {
+        opts.modes.push_back("pipeline");
+        opts.modes.push_back("fifo");
+        opts.modes.push_back("stress");
+    }
+    if (opts.block_samps.empty()) {
+        opts.block_samps.push_back(1024);
+        opts.block_samps.push_back(16384);
+    }
+    if (opts.placements.empty())
+        opts.placements.push_back(placement());
+
+    printf("# %.1f s per run, %lu CPUs online\n", opts.duration_s, (unsigned long) sysconf(_SC_NPROCESSORS_ONLN));
+    if (selected(opts, "pipeline")) {
+        printf("# pipeline: BoundedBuffer of %lu shorts, %s, %s\n",
+                (unsigned long) (opts.buffer_cnt*PACKET_SHORTS),
+                opts.rate_msps > 0 ? "paced producer" : "unpaced producer",
+                opts.verify ? "samples checked" : "samples not checked");
+        printf("%-18s %-7s %8s %10s %8s %10s %10s %9s %7s %9s %9s %9s %9s\n",
+                "queue", "cpus", "block", "MS/s", "drop%", "prod_cpu%", "cons_cpu%", "hwm", "errors",
+                "p50_us", "p99_us", "p999_us", "max_us");
+        for (size_t c = 0; c < opts.placements.size(); c++) {
+            for (size_t b = 0; b < opts.block_samps.size(); b++) {
+                runPipeline<BoundedBuffer<short>, BlockingReadFifo<blockMeta> >("BoundedBuffer", opts,
+                        opts.placements[c], opts.block_samps[b]);
+                fflush(stdout);
+            }
+        }
+    }
+    if (selected(opts, "fifo")) {
+        printf("# fifo: %lu producers\n", (unsigned long) opts.producers);
+        printf("%-18s %-7s %8s %10s %8s %10s %10s %9s %7s %9s %9s %9s %9s\n",
+                "queue", "cpus", "prods", "Mitems/s", "fair", "prod_cpu%", "cons_cpu%", "left", "errors",
+                "p50_us", "p99_us", "p999_us", "max_us");
+        for (size_t c = 0; c < opts.placements.size(); c++) {
+            runFifo<BlockingReadFifo<blockMeta> >("BlockingReadFifo", opts, opts.placements[c]);
+            fflush(stdout);
+        }
+    }
+    if (selected(opts, "stress")) {
+        printf("# stress: interrupt() and join a consumer blocked in pop()\n");
+        printf("%-18s %-7s %10s %8s %9s %9s %9s %9s\n",
+                "queue", "cpus", "cycles", "hangs", "p50_us", "p99_us", "p999_us", "max_us");
+        for (size_t c = 0; c < opts.placements.size(); c++) {
+            runStress(opts, opts.placements[c]);
+            fflush(stdout);
+        }
+    }
+    return 0;
+}
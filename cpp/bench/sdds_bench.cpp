@@ -0,0 +1,359 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* sdds_bench: drives the SDDS output path (OutSDDSPort_customized and SddsProcessor) the way the device
+ * does, without a USRP or a REDHAWK domain. Complex short samples are pushed at each configured sample rate
+ * and block size to a UDP sink in this process (loopback by default, or e.g. one end of a veth pair), and
+ * for each run it reports packet rate, sender CPU per MS/s, drops and the per-packet latency distribution.
+ *
+ * Latency is measured at the sink, from the time of the last sample in a packet (SDDS time tag plus the
+ * packet duration) to the time the packet is received. Each block is pushed as soon as its last sample is
+ * "received", so this covers the wait for the rest of the block, the input queue, the processor thread and
+ * the network stack. q_hwm is the input queue high water mark in shorts.
+ *
+ *   make sdds_bench
+ *   ./sdds_bench -r 1,5,10,25 -b 1024,16384 -d 5
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <sstream>
+#include <boost/thread.hpp>
+
+#include "port_impl_customized.h"
+#include "HotPathMetrics.h"
+#include "sdds/sddspacket.h"
+#include "sdds/socketUtils/multicast.h"
+#include "sdds/socketUtils/unicast.h"
+
+namespace {
+
+const size_t SAMPS_PER_PACKET = SDDS_DATA_SIZE/sizeof(short)/2; // complex
+const char* SEND_MODE = "sendmsg"; // SddsProcessor::sendPacket, one sendmsg per packet
+
+struct benchOptions {
+    benchOptions() : iface("lo"), ip("127.0.0.1"), port(29495), duration_s(5.0), buffer_cnt(20000) {}
+
+    std::vector<double> rates_msps;
+    std::vector<size_t> block_samps;
+    std::string iface;
+    std::string ip;
+    int port;
+    double duration_s;
+    size_t buffer_cnt;
+};
+
+struct benchResult {
+    benchResult() : pushed_samps(0), late_pushes(0), sender_cpu_s(0.0), wall_s(0.0), queue_high_water(0) {}
+
+    uint64_t pushed_samps;
+    uint64_t late_pushes; // pushes that started more than one block late
+    double sender_cpu_s;
+    double wall_s;
+    sddsHotPathMetrics sdds;
+    size_t queue_high_water;
+};
+
+double realtimeNow(){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+double cpuSeconds(clockid_t clock){
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+// UTC start of the current year, as SddsProcessor::getSecondsSinceStartOfYear computes it
+double startOfYear(){
+    time_t now = time(NULL);
+    struct tm year;
+    gmtime_r(&now, &year);
+    year.tm_sec = 0;
+    year.tm_min = 0;
+    year.tm_hour = 0;
+    year.tm_mday = 1;
+    year.tm_mon = 0;
+    return timegm(&year);
+}
+
+bool isMulticast(const std::string& ip){
+    const int first_octet = atoi(ip.c_str());
+    return first_octet >= 224 && first_octet <= 239;
+}
+
+// next sequence number SddsProcessor sends, which skips the parity packet (every 32nd)
+uint16_t nextSeq(uint16_t seq){
+    uint16_t next = seq+1;
+    if (next != 0 && next % 32 == 31)
+        next++;
+    return next;
+}
+
+/** Receives and checks the packets of one run on its own thread. Written only by that thread until it is
+ *  joined.
+ */
+class udpSink {
+public:
+    udpSink(const benchOptions& opts, double samp_rate) :
+        samp_rate(samp_rate), year_start_s(startOfYear()), running(true), packets(0), bytes(0), missing(0),
+        out_of_order(0), cpu_s(0.0)
+    {
+        if (isMulticast(opts.ip))
+            connection = multicast_client(opts.iface.c_str(), opts.ip.c_str(), opts.port);
+        else
+            connection = unicast_client(opts.iface.c_str(), opts.ip.c_str(), opts.port);
+        if (connection.sock < 0)
+            throw std::runtime_error("cannot open UDP sink on "+opts.iface+" "+opts.ip);
+        int rcvbuf = 64*1024*1024;
+        setsockopt(connection.sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+        struct timeval timeout = {0, 100000};
+        setsockopt(connection.sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        thread = boost::thread(&udpSink::run, this);
+    }
+
+    ~udpSink(){
+        stop();
+        close(connection.sock);
+    }
+
+    // returns once the sink has been idle for 100 ms
+    void stop(){
+        running = false;
+        if (thread.joinable())
+            thread.join();
+    }
+
+    double samp_rate;
+    double year_start_s;
+    volatile bool running;
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t missing; // sequence gaps
+    uint64_t out_of_order;
+    double cpu_s;
+    latencyHistogram wire_latency;
+
+private:
+    void run(){
+        char buffer[SDDS_HEADER_SIZE+SDDS_DATA_SIZE];
+        const double packet_duration_s = SAMPS_PER_PACKET/samp_rate;
+        bool first = true;
+        uint16_t expected = 0;
+        while (true) {
+            ssize_t len = recv(connection.sock, buffer, sizeof(buffer), 0);
+            const double received_s = realtimeNow();
+            if (len < 0) {
+                if (!running)
+                    break; // idle and asked to stop
+                continue;
+            }
+            if (size_t(len) < SDDS_HEADER_SIZE)
+                continue;
+            SDDSpacket* pkt = reinterpret_cast<SDDSpacket*>(buffer);
+            const uint16_t seq = pkt->get_seq();
+            if (!first && seq != expected) {
+                // count the packets skipped from expected to seq, or call it reordering if seq is behind
+                uint64_t gap = 0;
+                for (uint16_t s = expected; s != seq && gap < 32768; s = nextSeq(s))
+                    gap++;
+                if (gap < 32768)
+                    missing += gap;
+                else
+                    out_of_order++;
+            }
+            first = false;
+            expected = nextSeq(seq);
+            packets++;
+            bytes += len;
+            const double last_samp_s = year_start_s + pkt->get_SDDSTime().seconds() + packet_duration_s;
+            wire_latency.record(int64_t((received_s-last_samp_s)*1e9));
+        }
+        cpu_s = cpuSeconds(CLOCK_THREAD_CPUTIME_ID);
+    }
+
+    connection_t connection;
+    boost::thread thread;
+};
+
+template <class T>
+bool parseList(const char* arg, std::vector<T>& values){
+    values.clear();
+    std::string list(arg);
+    size_t begin = 0;
+    while (begin <= list.size()) {
+        size_t end = list.find(',', begin);
+        if (end == std::string::npos)
+            end = list.size();
+        const double value = atof(list.substr(begin, end-begin).c_str());
+        if (value <= 0)
+            return false;
+        values.push_back(T(value));
+        begin = end+1;
+    }
+    return !values.empty();
+}
+
+void usage(const char* name){
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -r MSPS[,MSPS...]    complex sample rates in MS/s (default 1,5,10)\n"
+        "  -b SAMPS[,SAMPS...]  complex samples per pushPacket (default 16384)\n"
+        "  -d SECONDS           duration of each run (default 5)\n"
+        "  -i IFACE             interface to send on and receive from (default lo)\n"
+        "  -a IP                destination address, unicast or multicast (default 127.0.0.1)\n"
+        "  -p PORT              destination UDP port (default 29495)\n"
+        "  -q COUNT             SddsProcessor input queue size in packets (default 20000)\n",
+        name);
+}
+
+benchResult runOne(OutSDDSPort_customized<short>& port, const benchOptions& opts, const std::string& stream_id, double samp_rate, size_t block_samps){
+    benchResult result;
+    if (!port.setStream(stream_id, opts.iface, opts.ip, opts.port, 0, "sdds_bench", -1, -1, false,
+            SDDS_DATA_SIZE/sizeof(short), opts.buffer_cnt) || !port.startStream(stream_id))
+        throw std::runtime_error("cannot set up SDDS stream on "+opts.iface+" "+opts.ip);
+    BULKIO::StreamSRI sri = bulkio::sri::create(stream_id, samp_rate);
+    sri.mode = 1;
+    port.pushSRI(sri);
+
+    std::vector<short> block(block_samps*2);
+    for (size_t i = 0; i < block.size(); i++)
+        block[i] = short(i);
+    const uint64_t block_ns = uint64_t(block_samps/samp_rate*1e9);
+    const double block_s = block_samps/samp_rate;
+
+    const double cpu_start_s = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID);
+    const uint64_t start_ns = hotPathNow();
+    const uint64_t end_ns = start_ns + uint64_t(opts.duration_s*1e9);
+    uint64_t deadline_ns = start_ns + block_ns;
+    while (deadline_ns <= end_ns) {
+        uint64_t now_ns = hotPathNow();
+        if (now_ns < deadline_ns) {
+            struct timespec ts;
+            ts.tv_sec = deadline_ns/1000000000ULL;
+            ts.tv_nsec = deadline_ns%1000000000ULL;
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+        } else if (now_ns - deadline_ns > block_ns) {
+            result.late_pushes++;
+        }
+        // the block's last sample has just been received
+        const double first_samp_s = realtimeNow() - block_s;
+        BULKIO::PrecisionUTCTime T = bulkio::time::utils::create(floor(first_samp_s), first_samp_s-floor(first_samp_s));
+        port.pushPacket(block, T, false, stream_id);
+        result.pushed_samps += block_samps;
+        deadline_ns += block_ns;
+    }
+
+    // let the processor drain its queue before taking the end of run numbers
+    const uint64_t expected_packets = result.pushed_samps/SAMPS_PER_PACKET;
+    for (int i = 0; i < 100; i++) {
+        port.getStreamMetrics(stream_id, result.sdds, result.queue_high_water);
+        if (result.sdds.packets.get() + result.sdds.dropped_samps.get()/SAMPS_PER_PACKET >= expected_packets)
+            break;
+        usleep(10000);
+    }
+    result.wall_s = (hotPathNow()-start_ns)*1e-9;
+    result.sender_cpu_s = cpuSeconds(CLOCK_PROCESS_CPUTIME_ID) - cpu_start_s;
+    port.getStreamMetrics(stream_id, result.sdds, result.queue_high_water);
+
+    std::vector<short> empty;
+    port.pushPacket(empty, bulkio::time::utils::now(), true, stream_id);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    benchOptions opts;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:b:d:i:a:p:q:h")) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'r': ok = parseList(optarg, opts.rates_msps); break;
+        case 'b': ok = parseList(optarg, opts.block_samps); break;
+        case 'd': opts.duration_s = atof(optarg); ok = opts.duration_s > 0; break;
+        case 'i': opts.iface = optarg; break;
+        case 'a': opts.ip = optarg; break;
+        case 'p': opts.port = atoi(optarg); ok = opts.port > 0 && opts.port < 65536; break;
+        case 'q': opts.buffer_cnt = atoi(optarg); ok = opts.buffer_cnt > 0; break;
+        default: ok = false; break;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (opts.rates_msps.empty()) {
+        opts.rates_msps.push_back(1.0);
+        opts.rates_msps.push_back(5.0);
+        opts.rates_msps.push_back(10.0);
+    }
+    if (opts.block_samps.empty())
+        opts.block_samps.push_back(16384);
+
+    printf("# iface %s, destination %s:%d, %.1f s per run, input queue %lu packets\n",
+            opts.iface.c_str(), opts.ip.c_str(), opts.port, opts.duration_s, (unsigned long) opts.buffer_cnt);
+    printf("%-8s %8s %8s %10s %10s %12s %10s %10s %8s %9s %9s %9s %9s %9s\n",
+            "mode", "MS/s", "block", "tx_pps", "rx_pps", "cpu%/MS/s", "q_dropped", "net_lost", "late",
+            "q_hwm", "p50_us", "p99_us", "p999_us", "max_us");
+
+    OutSDDSPort_customized<short> port("dataSDDS_out");
+    int run = 0;
+    int status = 0;
+    for (size_t r = 0; r < opts.rates_msps.size(); r++) {
+        for (size_t b = 0; b < opts.block_samps.size(); b++) {
+            const double samp_rate = opts.rates_msps[r]*1e6;
+            std::ostringstream stream_id;
+            stream_id << "sdds_bench_" << run++;
+            try {
+                udpSink sink(opts, samp_rate);
+                benchResult result = runOne(port, opts, stream_id.str(), samp_rate, opts.block_samps[b]);
+                sink.stop();
+                const double sender_cpu_s = result.sender_cpu_s - sink.cpu_s;
+                const latencySummary latency = sink.wire_latency.summarize();
+                printf("%-8s %8.2f %8lu %10.0f %10.0f %12.2f %10lu %10lu %8lu %9lu %9.1f %9.1f %9.1f %9.1f\n",
+                        SEND_MODE, opts.rates_msps[r], (unsigned long) opts.block_samps[b],
+                        result.sdds.packets.get()/result.wall_s, sink.packets/result.wall_s,
+                        100.0*sender_cpu_s/result.wall_s/opts.rates_msps[r],
+                        (unsigned long) (result.sdds.dropped_samps.get()/SAMPS_PER_PACKET),
+                        (unsigned long) std::max(sink.missing, result.sdds.packets.get() > sink.packets ?
+                                result.sdds.packets.get() - sink.packets : 0),
+                        (unsigned long) result.late_pushes, (unsigned long) result.queue_high_water,
+                        latency.p50*1e-3, latency.p99*1e-3, latency.p999*1e-3, latency.max*1e-3);
+                if (result.sdds.send_errors.get() > 0 || sink.out_of_order > 0)
+                    printf("#   %lu send errors, %lu out of order packets\n",
+                            (unsigned long) result.sdds.send_errors.get(), (unsigned long) sink.out_of_order);
+                fflush(stdout);
+            } catch (const std::exception& e) {
+                fprintf(stderr, "%s: %s\n", stream_id.str().c_str(), e.what());
+                status = 1;
+            }
+        }
+    }
+    return status;
+}
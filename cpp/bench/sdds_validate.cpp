@@ -0,0 +1,441 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* sdds_validate: joins an SDDS stream, e.g. the device's dataSDDS_out or sdds_bench, and checks it the way
+ * SddsProcessor is meant to send it:
+ *
+ *   - sequence numbers are continuous, skipping the parity slot (every 32nd) that is never sent
+ *   - each time tag is the previous one plus the samples in between at the SDDS clock (freq), which counts
+ *     real values, so 2x the complex sample rate. Packets lost in between are allowed for.
+ *   - sf is set, sos is set on sequence 0 of a new stream and clear after the sequence rolls over, and ttv
+ *     is as expected (-T)
+ *   - packets are full size, with no change in format (dmode, bps, cx) and clock
+ *
+ * It also measures the received sample and packet rate, inter-packet jitter (arrival interval less the time
+ * the packet's samples span) and latency from the time tag of a packet's last sample to its arrival, which
+ * needs the sender's clock to be in sync with this host's.
+ *
+ * The report is written as JSON when the run ends (after -d seconds, -n packets or on SIGINT), and the
+ * exit status is 0 if every check passed, 2 if any failed and 1 if the stream could not be joined.
+ *
+ *   make sdds_validate
+ *   ./sdds_validate -i eth1 -a 239.1.1.1 -p 29495 -d 30 -o sdds_report.json
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <algorithm>
+#include <string>
+
+#include "HotPathMetrics.h"
+#include "sdds/sddspacket.h"
+#include "sdds/socketUtils/multicast.h"
+#include "sdds/socketUtils/unicast.h"
+
+namespace {
+
+const size_t MAX_REPORTED_ERRORS = 20; // printed to stderr with -v
+
+volatile sig_atomic_t interrupted = 0;
+
+void onSignal(int){
+    interrupted = 1;
+}
+
+struct validateOptions {
+    validateOptions() : iface("lo"), ip("127.0.0.1"), port(29495), duration_s(10.0), max_packets(0),
+        tolerance_ns(1.0), expect_ttv(true), verbose(false) {}
+
+    std::string iface;
+    std::string ip;
+    int port;
+    double duration_s; // 0 to run until SIGINT
+    uint64_t max_packets; // 0 for no limit
+    double tolerance_ns;
+    bool expect_ttv;
+    bool verbose;
+    std::string output;
+};
+
+double realtimeNow(){
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return ts.tv_sec + 1e-9*ts.tv_nsec;
+}
+
+// UTC start of the current year, which SDDS time tags count from
+double startOfYear(){
+    time_t now = time(NULL);
+    struct tm year;
+    gmtime_r(&now, &year);
+    year.tm_sec = 0;
+    year.tm_min = 0;
+    year.tm_hour = 0;
+    year.tm_mday = 1;
+    year.tm_mon = 0;
+    return timegm(&year);
+}
+
+bool isMulticast(const std::string& ip){
+    const int first_octet = atoi(ip.c_str());
+    return first_octet >= 224 && first_octet <= 239;
+}
+
+// next sequence number SddsProcessor sends, which skips the parity packet (every 32nd)
+uint16_t nextSeq(uint16_t seq){
+    uint16_t next = seq+1;
+    if (next != 0 && next % 32 == 31)
+        next++;
+    return next;
+}
+
+// packets SddsProcessor would send from seq up to but not including next, or -1 if next is behind seq
+int32_t seqDistance(uint16_t seq, uint16_t next){
+    int32_t distance = 0;
+    for (uint16_t s = seq; s != next; s = nextSeq(s)) {
+        if (++distance >= 32768)
+            return -1;
+    }
+    return distance;
+}
+
+/** Checks of one stream, fed one packet at a time. */
+class sddsValidator {
+public:
+    sddsValidator(const validateOptions& opts) : opts(opts), year_start_s(startOfYear()), packets(0), bytes(0),
+        bad_size(0), first_seq(0), last_seq(0), missing(0), out_of_order(0), parity_slots(0), rollovers(0),
+        sos_first(false), sos_errors(0), ttv_errors(0), sf_errors(0), format_changes(0), freq_changes(0), time_checked(0),
+        time_errors(0), time_backwards(0), max_time_error_ns(0.0), dmode(0), bps(0), cx(0), freq(0.0),
+        first_arrival_ns(0), last_arrival_ns(0), interval_sum_ns(0.0), interval_sum_sq_ns(0.0), intervals(0),
+        reported(0) {}
+
+    void check(const char* buffer, ssize_t len, uint64_t arrival_ns, double arrival_s){
+        if (len != SDDS_psize) {
+            bad_size++;
+            report("packet of %ld bytes", (long) len);
+            return;
+        }
+        SDDSpacket* pkt = reinterpret_cast<SDDSpacket*>(const_cast<char*>(buffer));
+        const uint16_t seq = pkt->get_seq();
+        const SDDSTime ttag = pkt->get_SDDSTime();
+        const bool first = packets == 0;
+        packets++;
+        bytes += len;
+
+        if (!pkt->sf)
+            sf_errors++;
+        if ((pkt->get_ttv() != 0) != opts.expect_ttv) {
+            ttv_errors++;
+            report("seq %u: ttv %d", seq, pkt->get_ttv() != 0);
+        }
+
+        // packets sent between the previous one received and this one, which were lost
+        int32_t lost = 0;
+        if (first) {
+            first_seq = seq;
+            sos_first = pkt->sos;
+            if (seq == 0 && !pkt->sos) {
+                sos_errors++;
+                report("seq 0: sos not set at start of stream");
+            }
+        } else {
+            if (seq != 0 && seq % 32 == 31) {
+                parity_slots++;
+                report("seq %u: parity slot sent", seq);
+            }
+            lost = seqDistance(nextSeq(last_seq), seq);
+            if (lost < 0) {
+                out_of_order++;
+                report("seq %u: out of order after %u", seq, last_seq);
+            } else if (lost > 0) {
+                missing += lost;
+                report("seq %u: %d packets missing after %u", seq, lost, last_seq);
+            }
+            if (seq < last_seq && lost >= 0)
+                rollovers++;
+            if (rollovers > 0 && pkt->sos) {
+                sos_errors++;
+                report("seq %u: sos still set after sequence rollover", seq);
+            }
+        }
+
+        const unsigned packet_dmode = pkt->dmode;
+        const unsigned packet_bps = pkt->bps;
+        const unsigned packet_cx = pkt->cx;
+        const double packet_freq = pkt->get_freq();
+        bool continuous = !first && lost >= 0;
+        if (!first && (packet_dmode != dmode || packet_bps != bps || packet_cx != cx)) {
+            format_changes++;
+            continuous = false;
+            report("seq %u: format changed to dmode %u bps %u cx %u", seq, packet_dmode, packet_bps, packet_cx);
+        }
+        if (!first && packet_freq != freq) {
+            freq_changes++;
+            continuous = false;
+            report("seq %u: freq changed from %.6f to %.6f Hz", seq, freq, packet_freq);
+        }
+        dmode = packet_dmode;
+        bps = packet_bps;
+        cx = packet_cx;
+        freq = packet_freq;
+        const double packet_ns = valuesPerPacket()/freq*1e9;
+
+        if (continuous) {
+            // ticks of 250 ps from the previous time tag to this one
+            const double expected_ticks = (lost+1)*valuesPerPacket()/freq*4e9;
+            if (ttag < last_ttag) {
+                time_backwards++;
+                report("seq %u: time tag went backwards", seq);
+            } else {
+                const SDDSTime delta = ttag - last_ttag;
+                const double ticks = delta.ps250() + delta.pf250()/SDDSTime_two32;
+                const double error_ns = (ticks-expected_ticks)*SDDSTime_tic*1e9;
+                time_checked++;
+                max_time_error_ns = std::max(max_time_error_ns, fabs(error_ns));
+                if (fabs(error_ns) > opts.tolerance_ns) {
+                    time_errors++;
+                    report("seq %u: time tag off by %.3f ns", seq, error_ns);
+                }
+            }
+
+            const double interval_ns = double(arrival_ns - last_arrival_ns);
+            interval_sum_ns += interval_ns/(lost+1);
+            interval_sum_sq_ns += interval_ns/(lost+1)*interval_ns/(lost+1);
+            intervals++;
+            jitter.record(int64_t(fabs(interval_ns - (lost+1)*packet_ns)));
+        }
+        const double last_value_s = year_start_s + ttag.seconds() + packet_ns*1e-9;
+        latency.record(int64_t((arrival_s-last_value_s)*1e9));
+
+        if (first)
+            first_arrival_ns = arrival_ns;
+        last_arrival_ns = arrival_ns;
+        last_seq = seq;
+        last_ttag = ttag;
+    }
+
+    bool passed() const {
+        return packets > 0 && bad_size == 0 && missing == 0 && out_of_order == 0 && parity_slots == 0 &&
+                sos_errors == 0 && ttv_errors == 0 && sf_errors == 0 && format_changes == 0 &&
+                freq_changes == 0 && time_errors == 0 && time_backwards == 0;
+    }
+
+    void writeReport(FILE* out, double wall_s) const {
+        const double span_s = (last_arrival_ns-first_arrival_ns)*1e-9;
+        const double values = double(packets)*valuesPerPacket();
+        const double interval_mean_ns = intervals > 0 ? interval_sum_ns/intervals : 0.0;
+        const double interval_var_ns = intervals > 0 ?
+                std::max(0.0, interval_sum_sq_ns/intervals - interval_mean_ns*interval_mean_ns) : 0.0;
+        fprintf(out, "{\n");
+        fprintf(out, "  \"iface\": \"%s\",\n", opts.iface.c_str());
+        fprintf(out, "  \"address\": \"%s\",\n", opts.ip.c_str());
+        fprintf(out, "  \"port\": %d,\n", opts.port);
+        fprintf(out, "  \"wall_s\": %.3f,\n", wall_s);
+        fprintf(out, "  \"packets\": %lu,\n", (unsigned long) packets);
+        fprintf(out, "  \"bytes\": %lu,\n", (unsigned long) bytes);
+        fprintf(out, "  \"bad_size\": %lu,\n", (unsigned long) bad_size);
+        fprintf(out, "  \"sequence\": {\"first\": %u, \"missing\": %lu, \"out_of_order\": %lu, "
+                "\"parity_slots\": %lu, \"rollovers\": %lu},\n", first_seq, (unsigned long) missing,
+                (unsigned long) out_of_order, (unsigned long) parity_slots, (unsigned long) rollovers);
+        fprintf(out, "  \"flags\": {\"sos_first\": %s, \"sos_errors\": %lu, \"ttv_expected\": %s, "
+                "\"ttv_errors\": %lu, \"sf_errors\": %lu},\n", sos_first ? "true" : "false",
+                (unsigned long) sos_errors, opts.expect_ttv ? "true" : "false", (unsigned long) ttv_errors,
+                (unsigned long) sf_errors);
+        fprintf(out, "  \"format\": {\"dmode\": %u, \"bps\": %u, \"complex\": %s, \"freq_hz\": %.6f, "
+                "\"format_changes\": %lu, \"freq_changes\": %lu},\n", dmode, bps, cx ? "true" : "false", freq,
+                (unsigned long) format_changes, (unsigned long) freq_changes);
+        fprintf(out, "  \"time\": {\"tolerance_ns\": %.3f, \"checked\": %lu, \"errors\": %lu, \"backwards\": %lu, "
+                "\"max_error_ns\": %.3f},\n", opts.tolerance_ns, (unsigned long) time_checked,
+                (unsigned long) time_errors, (unsigned long) time_backwards, max_time_error_ns);
+        fprintf(out, "  \"rate\": {\"nominal_sps\": %.3f, \"received_sps\": %.3f, \"packets_per_s\": %.3f},\n",
+                freq/(cx ? 2 : 1), span_s > 0 ? (values-valuesPerPacket())/span_s/(cx ? 2 : 1) : 0.0,
+                span_s > 0 ? (packets-1)/span_s : 0.0);
+        fprintf(out, "  \"interval_us\": {\"mean\": %.3f, \"stddev\": %.3f},\n", interval_mean_ns*1e-3,
+                sqrt(interval_var_ns)*1e-3);
+        writeSummary(out, "jitter_us", jitter.summarize());
+        fprintf(out, ",\n");
+        writeSummary(out, "latency_us", latency.summarize());
+        fprintf(out, ",\n");
+        fprintf(out, "  \"pass\": %s\n", passed() ? "true" : "false");
+        fprintf(out, "}\n");
+    }
+
+private:
+    // real values in a packet, which the SDDS clock counts
+    double valuesPerPacket() const {
+        const unsigned bits = (bps == 31) ? 32 : (bps > 0 ? bps : 16);
+        return SDDS_payload_size*8.0/bits;
+    }
+
+    static void writeSummary(FILE* out, const char* name, const latencySummary& summary){
+        fprintf(out, "  \"%s\": {\"count\": %lu, \"p50\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f}",
+                name, (unsigned long) summary.count, summary.p50*1e-3, summary.p99*1e-3, summary.p999*1e-3,
+                summary.max*1e-3);
+    }
+
+    void report(const char* format, ...) __attribute__((format(printf, 2, 3))) {
+        if (!opts.verbose || reported >= MAX_REPORTED_ERRORS)
+            return;
+        va_list args;
+        va_start(args, format);
+        vfprintf(stderr, format, args);
+        va_end(args);
+        fprintf(stderr, "\n");
+        if (++reported == MAX_REPORTED_ERRORS)
+            fprintf(stderr, "(no more errors reported)\n");
+    }
+
+    const validateOptions& opts;
+    double year_start_s;
+
+    uint64_t packets;
+    uint64_t bytes;
+    uint64_t bad_size;
+    uint16_t first_seq;
+    uint16_t last_seq;
+    uint64_t missing;
+    uint64_t out_of_order;
+    uint64_t parity_slots;
+    uint64_t rollovers;
+    bool sos_first;
+    uint64_t sos_errors;
+    uint64_t ttv_errors;
+    uint64_t sf_errors;
+    uint64_t format_changes;
+    uint64_t freq_changes;
+
+    SDDSTime last_ttag;
+    uint64_t time_checked;
+    uint64_t time_errors;
+    uint64_t time_backwards;
+    double max_time_error_ns;
+
+    unsigned dmode;
+    unsigned bps;
+    unsigned cx;
+    double freq;
+
+    uint64_t first_arrival_ns;
+    uint64_t last_arrival_ns;
+    double interval_sum_ns;
+    double interval_sum_sq_ns;
+    uint64_t intervals;
+    latencyHistogram jitter;
+    latencyHistogram latency;
+    size_t reported;
+};
+
+void usage(const char* name){
+    fprintf(stderr,
+        "usage: %s [options]\n"
+        "  -i IFACE     interface to receive on (default lo)\n"
+        "  -a IP        stream address, unicast or multicast (default 127.0.0.1)\n"
+        "  -p PORT      UDP port (default 29495)\n"
+        "  -d SECONDS   how long to listen, 0 until interrupted (default 10)\n"
+        "  -n PACKETS   stop after this many packets (default no limit)\n"
+        "  -t NS        time tag tolerance in ns (default 1)\n"
+        "  -T 0|1       expected ttv flag (default 1)\n"
+        "  -o FILE      write the JSON report to FILE instead of stdout\n"
+        "  -v           print the first %lu errors to stderr\n",
+        name, (unsigned long) MAX_REPORTED_ERRORS);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]){
+    validateOptions opts;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:a:p:d:n:t:T:o:vh")) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'i': opts.iface = optarg; break;
+        case 'a': opts.ip = optarg; break;
+        case 'p': opts.port = atoi(optarg); ok = opts.port > 0 && opts.port < 65536; break;
+        case 'd': opts.duration_s = atof(optarg); ok = opts.duration_s >= 0; break;
+        case 'n': opts.max_packets = strtoull(optarg, NULL, 10); break;
+        case 't': opts.tolerance_ns = atof(optarg); ok = opts.tolerance_ns >= 0; break;
+        case 'T': opts.expect_ttv = atoi(optarg) != 0; break;
+        case 'o': opts.output = optarg; break;
+        case 'v': opts.verbose = true; break;
+        default: ok = false; break;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    connection_t connection;
+    try {
+        if (isMulticast(opts.ip))
+            connection = multicast_client(opts.iface.c_str(), opts.ip.c_str(), opts.port);
+        else
+            connection = unicast_client(opts.iface.c_str(), opts.ip.c_str(), opts.port);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "cannot join %s on %s: %s\n", opts.ip.c_str(), opts.iface.c_str(), e.what());
+        return 1;
+    }
+    if (connection.sock < 0) {
+        fprintf(stderr, "cannot join %s on %s\n", opts.ip.c_str(), opts.iface.c_str());
+        return 1;
+    }
+    int rcvbuf = 64*1024*1024;
+    setsockopt(connection.sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    struct timeval timeout = {0, 100000};
+    setsockopt(connection.sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    sddsValidator validator(opts);
+    char buffer[2*SDDS_psize];
+    uint64_t packets = 0;
+    const uint64_t start_ns = hotPathNow();
+    const uint64_t end_ns = start_ns + uint64_t(opts.duration_s*1e9);
+    while (!interrupted && (opts.duration_s == 0 || hotPathNow() < end_ns) &&
+            (opts.max_packets == 0 || packets < opts.max_packets)) {
+        const ssize_t len = recv(connection.sock, buffer, sizeof(buffer), 0);
+        if (len < 0)
+            continue; // timed out, or interrupted
+        validator.check(buffer, len, hotPathNow(), realtimeNow());
+        packets++;
+    }
+    const double wall_s = (hotPathNow()-start_ns)*1e-9;
+    close(connection.sock);
+
+    FILE* out = stdout;
+    if (!opts.output.empty()) {
+        out = fopen(opts.output.c_str(), "w");
+        if (!out) {
+            perror(opts.output.c_str());
+            return 1;
+        }
+    }
+    validator.writeReport(out, wall_s);
+    if (out != stdout)
+        fclose(out);
+    return validator.passed() ? 0 : 2;
+}
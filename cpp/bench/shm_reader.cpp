@@ -0,0 +1,196 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* shm_reader: reads a tuner's shm_output ring with shmRingReader, as a local consumer would, and reports what
+ * it received:
+ *
+ *   - blocks, samples and the sample rate they arrived at
+ *   - blocks lost because the reader fell more than num_slots behind, and blocks overwritten while being read
+ *   - gaps in the time stamps, i.e. a block that does not start where the previous one ended, which also
+ *     shows samples dropped by the device
+ *   - stream starts (SRI changes) and EOS
+ *
+ * Several can run against the same ring to check that readers do not affect the device or each other. If
+ * the device replaces the ring (e.g. num_slots changed), the reader opens the new one. The exit status is 0
+ * after a run and 1 if the ring could not be opened.
+ *
+ *   make libusrp_uhd_shm.a shm_reader
+ *   ./shm_reader -r /USRP_UHD_0 -d 30 -v
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string>
+
+#include "HotPathMetrics.h"
+#include "ShmRing.h"
+
+namespace {
+
+volatile sig_atomic_t interrupted = 0;
+
+void onSignal(int){
+    interrupted = 1;
+}
+
+struct readerOptions {
+    readerOptions() : ring("/USRP_UHD_0"), duration_s(10.0), touch(false), verbose(false) {}
+
+    std::string ring;
+    double duration_s; // 0 to run until SIGINT
+    bool touch; // sum every sample, as a consumer reading the data would
+    bool verbose;
+};
+
+struct readerStats {
+    readerStats() : blocks(0), samples(0), torn(0), gaps(0), sri_changes(0), eos(0), reopens(0), checksum(0) {}
+
+    uint64_t blocks;
+    uint64_t samples; // complex
+    uint64_t torn; // overwritten while being read
+    uint64_t gaps;
+    uint64_t sri_changes;
+    uint64_t eos;
+    uint64_t reopens;
+    int64_t checksum;
+};
+
+bool running(const readerOptions& opts, uint64_t end_ns){
+    return !interrupted && (opts.duration_s == 0 || hotPathNow() < end_ns);
+}
+
+void usage(const char* prog){
+    fprintf(stderr, "usage: %s [-r ring] [-d seconds] [-t] [-v]\n"
+            "  -r  shared memory ring, shm_output name_prefix and tuner index (default /USRP_UHD_0)\n"
+            "  -d  seconds to run, 0 until interrupted (default 10)\n"
+            "  -t  read every sample, rather than only the block metadata\n"
+            "  -v  print each stream start, gap and EOS\n", prog);
+}
+
+}
+
+int main(int argc, char* argv[]){
+    readerOptions opts;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:d:tvh")) != -1) {
+        bool ok = true;
+        switch (opt) {
+        case 'r': opts.ring = optarg; break;
+        case 'd': opts.duration_s = atof(optarg); ok = opts.duration_s >= 0; break;
+        case 't': opts.touch = true; break;
+        case 'v': opts.verbose = true; break;
+        default: ok = false; break;
+        }
+        if (!ok) {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    shmRingReader reader;
+    if (!reader.open(opts.ring)) {
+        fprintf(stderr, "%s\n", reader.error().c_str());
+        return 1;
+    }
+    signal(SIGINT, onSignal);
+    signal(SIGTERM, onSignal);
+
+    readerStats stats;
+    uint64_t lost_before = 0; // lost by readers of rings since replaced
+    double next_time = -1.0; // expected time of the next block, negative at stream start
+    const uint64_t start_ns = hotPathNow();
+    const uint64_t end_ns = start_ns + uint64_t(opts.duration_s*1e9);
+    while (running(opts, end_ns)) {
+        const shmRingBlock *block = reader.next(100);
+        if (!block) {
+            if (reader.closed()) {
+                // the device removed the ring; wait for it to create the next one
+                const uint64_t lost = reader.lost();
+                reader.close();
+                while (running(opts, end_ns) && !reader.open(opts.ring))
+                    usleep(100000);
+                if (reader.isOpen()) {
+                    lost_before += lost;
+                    stats.reopens++;
+                }
+                next_time = -1.0;
+            }
+            continue;
+        }
+
+        const uint32_t flags = block->flags;
+        const double time = block->twsec + block->tfsec;
+        const double xdelta = block->xdelta;
+        const uint32_t num_samples = block->num_samples;
+        if (flags & SHM_RING_SRI_CHANGED) {
+            stats.sri_changes++;
+            if (opts.verbose)
+                printf("stream %.*s: %.0f sps at %.6f MHz, bandwidth %.6f MHz\n", int(sizeof(block->stream_id)),
+                        block->stream_id, xdelta > 0.0 ? 1.0/xdelta : 0.0, block->center_frequency*1e-6, block->bandwidth*1e-6);
+            next_time = -1.0;
+        }
+        int64_t sum = 0;
+        if (opts.touch) {
+            const short *samples = block->samples();
+            for (uint32_t i = 0; i < num_samples; i++)
+                sum += samples[i];
+        }
+        if (!reader.intact()) {
+            stats.torn++;
+            next_time = -1.0;
+            continue;
+        }
+
+        stats.blocks++;
+        stats.samples += num_samples/2;
+        stats.checksum += sum;
+        if (next_time >= 0.0 && xdelta > 0.0 && fabs(time-next_time) > 0.5*xdelta) {
+            stats.gaps++;
+            if (opts.verbose)
+                printf("gap of %.0f samples\n", (time-next_time)/xdelta);
+        }
+        next_time = time + (num_samples/2)*xdelta;
+        if (flags & SHM_RING_EOS) {
+            stats.eos++;
+            if (opts.verbose)
+                printf("EOS\n");
+            next_time = -1.0;
+        }
+    }
+    const double wall_s = (hotPathNow()-start_ns)*1e-9;
+
+    printf("ring         %s\n", opts.ring.c_str());
+    printf("duration     %.3f s\n", wall_s);
+    printf("blocks       %llu\n", (unsigned long long) stats.blocks);
+    printf("samples      %llu (%.0f sps)\n", (unsigned long long) stats.samples, wall_s > 0.0 ? stats.samples/wall_s : 0.0);
+    printf("lost         %llu\n", (unsigned long long) (lost_before + reader.lost()));
+    printf("overwritten  %llu\n", (unsigned long long) stats.torn);
+    printf("time gaps    %llu\n", (unsigned long long) stats.gaps);
+    printf("streams      %llu\n", (unsigned long long) stats.sri_changes);
+    printf("eos          %llu\n", (unsigned long long) stats.eos);
+    printf("reopened     %llu\n", (unsigned long long) stats.reopens);
+    if (opts.touch)
+        printf("checksum     %lld\n", (long long) stats.checksum);
+    return 0;
+}
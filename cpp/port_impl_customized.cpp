@@ -95,6 +95,35 @@ bool OutSDDSPort_customized<DATA_TYPE>::startStream(std::string streamID) {
     TRACE_EXIT(OutSDDSPort_customized);
     return true;
 }
+template <class DATA_TYPE>
+bool OutSDDSPort_customized<DATA_TYPE>::getStreamMetrics(const std::string& streamID, sddsHotPathMetrics& metrics, size_t& queue_high_water) {
+    boost::mutex::scoped_lock lock(input_port_lock);
+    typename streamid_to_proc_map_t::iterator proc_iter = streamid_to_processor.find(streamID);
+    if (proc_iter == streamid_to_processor.end())
+        return false; // SDDS is not enabled for this stream
+    metrics = proc_iter->second->getMetrics();
+    queue_high_water = proc_iter->second->getQueueHighWater();
+    return true;
+}
+
+template <class DATA_TYPE>
+bool OutSDDSPort_customized<DATA_TYPE>::getStreamLatency(const std::string& streamID, latencySummary& latency) {
+    boost::mutex::scoped_lock lock(input_port_lock);
+    typename streamid_to_proc_map_t::iterator proc_iter = streamid_to_processor.find(streamID);
+    if (proc_iter == streamid_to_processor.end())
+        return false; // SDDS is not enabled for this stream
+    latency = proc_iter->second->getLatency();
+    return true;
+}
+
+template <class DATA_TYPE>
+void OutSDDSPort_customized<DATA_TYPE>::resetLatency() {
+    boost::mutex::scoped_lock lock(input_port_lock);
+    typename streamid_to_proc_map_t::iterator proc_iter = streamid_to_processor.begin();
+    for (; proc_iter != streamid_to_processor.end(); ++proc_iter)
+        proc_iter->second->resetLatency();
+}
+
 /*
 template <class DATA_TYPE>
 bool OutSDDSPort_customized<DATA_TYPE>::endStream(std::string streamID) {
@@ -44,6 +44,9 @@ public:
             std::string attach_user_id, long ttv=-1, long endiance=-1, bool sri_has_priority=false,
             size_t buffer_size=SDDS_DATA_SIZE/sizeof(DATA_TYPE), size_t buffer_cnt=20000);
     bool startStream(std::string streamID);
+    bool getStreamMetrics(const std::string& streamID, sddsHotPathMetrics& metrics, size_t& queue_high_water);
+    bool getStreamLatency(const std::string& streamID, latencySummary& latency);
+    void resetLatency();
     //bool endStream(std::string streamID);
     //bool removeStream(std::string streamID)
     //  - should call setActiveStatus(false) if previous function(s) are implemented/overridden
@@ -43,7 +43,7 @@ public:
     // and has no impact, positive or negative, when using other methods (except for increased memory footprint).
     BoundedBuffer(size_t buffer_capacity, size_t max_read=1) :
             buf(buffer_capacity+(max_read==0? buffer_capacity-1 : max_read-1)), buf_capacity(buffer_capacity), maximum_read((max_read==0? 1 : max_read)), buf_size(0), read_ptr(
-                    0), write_ptr(0) {
+                    0), write_ptr(0), high_water(0) {
         /* buf is sized to be the capacity requested plus just enough extra memory to support the
          * contiguous memory requirement of max_read. Since there will always be at least a single
          * sample in the main buffer memory, the additional capacity is one less than max_read. In
@@ -65,6 +65,7 @@ public:
         memcpy(&buf[0], data + size_write1, (size - size_write1) * sizeof(T));
         update(write_ptr, size);
         buf_size += size;
+        high_water = std::max(high_water, buf_size);
         lock.unlock();
         m_not_empty.notify_one();
         return size;
@@ -101,6 +102,7 @@ public:
         memcpy(&buf[0], data + size_write1, (size - size_write1) * sizeof(T));
         update(write_ptr, size);
         buf_size += size;
+        high_water = std::max(high_water, buf_size);
         lock.unlock();
         m_not_empty.notify_one();
         return size;
@@ -185,6 +187,12 @@ public:
         return buf_capacity;
     }
 
+    // largest number of elements ever held at once
+    size_t high_water_mark() {
+        boost::mutex::scoped_lock lock(m_mutex);
+        return high_water;
+    }
+
     void dump() {
         boost::mutex::scoped_lock lock(m_mutex);
         if (buf_size == 0) {
@@ -240,6 +248,7 @@ private:
     size_t buf_size;
     size_t read_ptr;
     size_t write_ptr;
+    size_t high_water;
 
     boost::mutex m_mutex;
     boost::condition m_not_empty;
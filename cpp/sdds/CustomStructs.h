@@ -37,6 +37,7 @@ public:
         m_sri_changed = false;
         bulkio::sri::zeroSRI(m_sri);
         m_data = 0;
+        m_input_ns = 0;
     }
 
     // used for new block with new sri
@@ -136,6 +137,16 @@ public:
         return m_data;
     }
 
+    // host time (ns, monotonic) the data block was input, 0 once its first packet has been sent
+    // combined blocks keep the time of the first block
+    uint64_t input_time() const {
+        return m_input_ns;
+    }
+
+    void input_time(uint64_t ns) {
+        m_input_ns = ns;
+    }
+
 private:
     // current values
     size_t m_num_samples;
@@ -144,6 +155,7 @@ private:
     bool m_sri_changed;
     BULKIO::StreamSRI m_sri;
     DATA_TYPE* m_data;
+    uint64_t m_input_ns;
 
     // original values
     size_t m_num_samples_;
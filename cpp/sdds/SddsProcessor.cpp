@@ -265,6 +265,7 @@ void SddsProcessor<DATA_TYPE>::_run() {
         if (m_metadata.sri_changed()) {
             LOG_INFO(SddsProcessor,"Stream SRI has changed, updating SDDS header.");
             m_metadata.sri_changed(false);
+            TRACE_EVENT(TRACE_SRI_CHANGE, TRACE_NO_TUNER, 0, 0);
             pushSri();
             setSddsHeaderFromSri();
         }
@@ -281,13 +282,16 @@ void SddsProcessor<DATA_TYPE>::_run() {
         // Loop through, pushing full packets
         bool error = false;
         char *sddsDataBlock = reinterpret_cast<char*>(m_metadata.data());
+        size_t batch_packets = 0;
         while (m_metadata.size()*sizeof(DATA_TYPE) >= SDDS_DATA_SIZE && !error) {
             if ( (error = (sendPacket(sddsDataBlock, SDDS_DATA_SIZE) < 0)) ) {
                 continue;
             }
             sddsDataBlock += SDDS_DATA_SIZE;
             m_metadata.consume(SDDS_DATA_SIZE/sizeof(DATA_TYPE));
+            batch_packets++;
         }
+        TRACE_EVENT(TRACE_SDDS_SEND, TRACE_NO_TUNER, batch_packets, batch_packets*SDDS_DATA_SIZE);
         if (error) {
             LOG_ERROR(SddsProcessor,"Failed to push packet over socket, SddsProcessor will shutdown.");
             //callDetach(); // XXX Add detach here even though it's not EOS? If we start back up, will another attach be sent?
@@ -444,9 +448,11 @@ void SddsProcessor<DATA_TYPE>::dataIn(const std::vector<DATA_TYPE>& data, const
     size_t samples = m_input_data_q.trywrite(&data[0], data.size()); // non-blocking
 
     m_input_metadata.set(samples, T, EOS, sri);
+    m_input_metadata.input_time(hotPathNow());
     m_input_metadata_q.push(m_input_metadata);
 
     if (samples < data.size()) {
+        m_metrics.dropped_samps.add((data.size()-samples)/(1+m_input_metadata.sri().mode));
         LOG_ERROR(SddsProcessor, "Failed to write full input data block, dropping " << (data.size()-samples)/(1+m_input_metadata.sri().mode) << "samples. Try increasing sdds buffer size.");
     }
 }
@@ -463,9 +469,11 @@ void SddsProcessor<DATA_TYPE>::dataIn(const std::vector<DATA_TYPE>& data, const
     size_t samples = m_input_data_q.trywrite(&data[0], data.size()); // non-blocking
 
     m_input_metadata.update(samples, T, EOS);
+    m_input_metadata.input_time(hotPathNow());
     m_input_metadata_q.push(m_input_metadata);
 
     if (samples < data.size()) {
+        m_metrics.dropped_samps.add((data.size()-samples)/(1+m_input_metadata.sri().mode));
         LOG_ERROR(SddsProcessor, "Failed to write full input data block; wrote "
         		<< (samples)/(1+m_input_metadata.sri().mode) << " and dropping "
         		<< (data.size()-samples)/(1+m_input_metadata.sri().mode) << " of "
@@ -473,6 +481,38 @@ void SddsProcessor<DATA_TYPE>::dataIn(const std::vector<DATA_TYPE>& data, const
     }
 }
 
+/**
+ * Counters updated by the processor thread and by dataIn. These are safe to read from any thread.
+ */
+template <class DATA_TYPE>
+const sddsHotPathMetrics& SddsProcessor<DATA_TYPE>::getMetrics() const {
+    return m_metrics;
+}
+
+/**
+ * Percentiles of the time from dataIn to sending the first packet of each block.
+ */
+template <class DATA_TYPE>
+latencySummary SddsProcessor<DATA_TYPE>::getLatency() const {
+    return m_input_to_send.summarize();
+}
+
+/**
+ * Requests that the processor thread clear the latency histogram before its next update.
+ */
+template <class DATA_TYPE>
+void SddsProcessor<DATA_TYPE>::resetLatency() {
+    m_input_to_send.requestReset();
+}
+
+/**
+ * Largest number of samples (scalars) held in the input queue at once.
+ */
+template <class DATA_TYPE>
+size_t SddsProcessor<DATA_TYPE>::getQueueHighWater() {
+    return m_input_data_q.high_water_mark();
+}
+
 /**
  * Takes the provided data buffer and sends it along with the SDDS header, increasing the SDDS sequence number and resetting the start
  * of stream flag when needed.
@@ -505,7 +545,14 @@ int SddsProcessor<DATA_TYPE>::sendPacket(char* dataBlock, size_t num_bytes) {
 
     setSddsTimestamp();
     numSent = sendmsg(m_connection.sock, &m_pkt_template, 0);
-    if (numSent < 0) {return numSent;} // Error occurred
+    if (numSent < 0) {m_metrics.send_errors.add(); return numSent;} // Error occurred
+    m_metrics.packets.add();
+    m_metrics.bytes.add(numSent);
+    if (m_metadata.input_time() != 0) {
+        // first packet sent from this block
+        m_input_to_send.record(hotPathNow()-m_metadata.input_time());
+        m_metadata.input_time(0);
+    }
 
     LOG_TRACE(SddsProcessor,"Pushed " << numSent << " bytes out of socket.")
     return 0;
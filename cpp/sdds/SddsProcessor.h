@@ -34,6 +34,8 @@
 #include "BlockingReadFifo.h"
 #include "CustomStructs.h"
 #include "BoundedBuffer.h"
+#include "../HotPathMetrics.h"
+#include "../EventTrace.h"
 
 #define SDDS_DATA_SIZE 1024
 #define SDDS_HEADER_SIZE 56
@@ -74,6 +76,10 @@ public:
     void removeStream(std::string streamID);
     void dataIn(const std::vector<DATA_TYPE>& data, const BULKIO::PrecisionUTCTime& T, bool EOS, const BULKIO::StreamSRI& sri);
     void dataIn(const std::vector<DATA_TYPE>& data, const BULKIO::PrecisionUTCTime& T, bool EOS);
+    const sddsHotPathMetrics& getMetrics() const;
+    size_t getQueueHighWater();
+    latencySummary getLatency() const;
+    void resetLatency();
 
 private:
     void pushSri();
@@ -118,6 +124,9 @@ private:
     time_t m_year_start_s;
     time_t m_year_end_s;
 
+    sddsHotPathMetrics m_metrics;
+    latencyHistogram m_input_to_send; // dataIn to sendmsg of the first packet of the block, written by processor thread
+
     template <typename CORBAXX>
         bool addModifyKeyword(BULKIO::StreamSRI *sri, CORBA::String_member id, CORBAXX myValue, bool addOnly = false) {
             CORBA::Any value;
@@ -334,6 +334,7 @@ struct frontend_tuner_status_struct_struct : public frontend::default_frontend_t
     CORBA::Long output_vlan;
     CORBA::Long reference_source;
     double sample_rate_tolerance;
+    std::string status;
     std::string stream_id;
     CORBA::ULong tuner_index;
     short tuner_number;
@@ -408,6 +409,9 @@ inline bool operator>>= (const CORBA::Any& a, frontend_tuner_status_struct_struc
     if (props.contains("FRONTEND::tuner_status::sample_rate_tolerance")) {
         if (!(props["FRONTEND::tuner_status::sample_rate_tolerance"] >>= s.sample_rate_tolerance)) return false;
     }
+    if (props.contains("FRONTEND::tuner_status::status")) {
+        if (!(props["FRONTEND::tuner_status::status"] >>= s.status)) return false;
+    }
     if (props.contains("FRONTEND::tuner_status::stream_id")) {
         if (!(props["FRONTEND::tuner_status::stream_id"] >>= s.stream_id)) return false;
     }
@@ -474,6 +478,8 @@ inline void operator<<= (CORBA::Any& a, const frontend_tuner_status_struct_struc
  
     props["FRONTEND::tuner_status::sample_rate_tolerance"] = s.sample_rate_tolerance;
  
+    props["FRONTEND::tuner_status::status"] = s.status;
+ 
     props["FRONTEND::tuner_status::stream_id"] = s.stream_id;
  
     props["FRONTEND::tuner_status::tuner_index"] = s.tuner_index;
@@ -531,6 +537,8 @@ inline bool operator== (const frontend_tuner_status_struct_struct& s1, const fro
         return false;
     if (s1.sample_rate_tolerance!=s2.sample_rate_tolerance)
         return false;
+    if (s1.status!=s2.status)
+        return false;
     if (s1.stream_id!=s2.stream_id)
         return false;
     if (s1.tuner_index!=s2.tuner_index)
@@ -739,6 +747,7 @@ struct usrp_channel_struct {
     std::string ch_name;
     std::string tuner_type;
     short chan_num;
+    short mb_num;
     std::string antenna;
     double bandwidth_current;
     double bandwidth_min;
@@ -770,6 +779,9 @@ inline bool operator>>= (const CORBA::Any& a, usrp_channel_struct& s) {
     if (props.contains("device_channels::chan_num")) {
         if (!(props["device_channels::chan_num"] >>= s.chan_num)) return false;
     }
+    if (props.contains("device_channels::mb_num")) {
+        if (!(props["device_channels::mb_num"] >>= s.mb_num)) return false;
+    }
     if (props.contains("device_channels::antenna")) {
         if (!(props["device_channels::antenna"] >>= s.antenna)) return false;
     }
@@ -830,6 +842,8 @@ inline void operator<<= (CORBA::Any& a, const usrp_channel_struct& s) {
  
     props["device_channels::chan_num"] = s.chan_num;
  
+    props["device_channels::mb_num"] = s.mb_num;
+ 
     props["device_channels::antenna"] = s.antenna;
  
     props["device_channels::bandwidth_current"] = s.bandwidth_current;
@@ -871,6 +885,8 @@ inline bool operator== (const usrp_channel_struct& s1, const usrp_channel_struct
         return false;
     if (s1.chan_num!=s2.chan_num)
         return false;
+    if (s1.mb_num!=s2.mb_num)
+        return false;
     if (s1.antenna!=s2.antenna)
         return false;
     if (s1.bandwidth_current!=s2.bandwidth_current)
@@ -910,4 +926,1640 @@ inline bool operator!= (const usrp_channel_struct& s1, const usrp_channel_struct
     return !(s1==s2);
 }
 
+struct tuner_latency_struct {
+    tuner_latency_struct ()
+    {
+        tuner_index = 0;
+        max_latency_ms = 0.0;
+    };
+
+    static std::string getId() {
+        return std::string("tuner_max_latency::tuner_latency");
+    };
+
+    CORBA::ULong tuner_index;
+    double max_latency_ms;
+};
+
+inline bool operator>>= (const CORBA::Any& a, tuner_latency_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("tuner_max_latency::tuner_index")) {
+        if (!(props["tuner_max_latency::tuner_index"] >>= s.tuner_index)) return false;
+    }
+    if (props.contains("tuner_max_latency::max_latency_ms")) {
+        if (!(props["tuner_max_latency::max_latency_ms"] >>= s.max_latency_ms)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const tuner_latency_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["tuner_max_latency::tuner_index"] = s.tuner_index;
+ 
+    props["tuner_max_latency::max_latency_ms"] = s.max_latency_ms;
+    a <<= props;
+}
+
+inline bool operator== (const tuner_latency_struct& s1, const tuner_latency_struct& s2) {
+    if (s1.tuner_index!=s2.tuner_index)
+        return false;
+    if (s1.max_latency_ms!=s2.max_latency_ms)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const tuner_latency_struct& s1, const tuner_latency_struct& s2) {
+    return !(s1==s2);
+}
+
+struct low_latency_allocation_struct {
+    low_latency_allocation_struct ()
+    {
+        allocation_id = "";
+        packets_per_push = 1;
+        recv_timeout_us = 0;
+        cpu_core = -1;
+    };
+
+    static std::string getId() {
+        return std::string("low_latency_allocations::low_latency_allocation");
+    };
+
+    std::string allocation_id;
+    unsigned short packets_per_push;
+    CORBA::ULong recv_timeout_us;
+    short cpu_core;
+};
+
+inline bool operator>>= (const CORBA::Any& a, low_latency_allocation_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("low_latency_allocations::allocation_id")) {
+        if (!(props["low_latency_allocations::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("low_latency_allocations::packets_per_push")) {
+        if (!(props["low_latency_allocations::packets_per_push"] >>= s.packets_per_push)) return false;
+    }
+    if (props.contains("low_latency_allocations::recv_timeout_us")) {
+        if (!(props["low_latency_allocations::recv_timeout_us"] >>= s.recv_timeout_us)) return false;
+    }
+    if (props.contains("low_latency_allocations::cpu_core")) {
+        if (!(props["low_latency_allocations::cpu_core"] >>= s.cpu_core)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const low_latency_allocation_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["low_latency_allocations::allocation_id"] = s.allocation_id;
+ 
+    props["low_latency_allocations::packets_per_push"] = s.packets_per_push;
+ 
+    props["low_latency_allocations::recv_timeout_us"] = s.recv_timeout_us;
+ 
+    props["low_latency_allocations::cpu_core"] = s.cpu_core;
+    a <<= props;
+}
+
+inline bool operator== (const low_latency_allocation_struct& s1, const low_latency_allocation_struct& s2) {
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.packets_per_push!=s2.packets_per_push)
+        return false;
+    if (s1.recv_timeout_us!=s2.recv_timeout_us)
+        return false;
+    if (s1.cpu_core!=s2.cpu_core)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const low_latency_allocation_struct& s1, const low_latency_allocation_struct& s2) {
+    return !(s1==s2);
+}
+
+struct hop_struct {
+    hop_struct ()
+    {
+        allocation_id = "";
+        center_frequency = 0.0;
+        dwell_ms = 0.0;
+        time = 0.0;
+    };
+
+    static std::string getId() {
+        return std::string("hop_schedule::hop");
+    };
+
+    std::string allocation_id;
+    double center_frequency;
+    double dwell_ms;
+    double time;
+};
+
+inline bool operator>>= (const CORBA::Any& a, hop_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("hop_schedule::allocation_id")) {
+        if (!(props["hop_schedule::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("hop_schedule::center_frequency")) {
+        if (!(props["hop_schedule::center_frequency"] >>= s.center_frequency)) return false;
+    }
+    if (props.contains("hop_schedule::dwell_ms")) {
+        if (!(props["hop_schedule::dwell_ms"] >>= s.dwell_ms)) return false;
+    }
+    if (props.contains("hop_schedule::time")) {
+        if (!(props["hop_schedule::time"] >>= s.time)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const hop_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["hop_schedule::allocation_id"] = s.allocation_id;
+ 
+    props["hop_schedule::center_frequency"] = s.center_frequency;
+ 
+    props["hop_schedule::dwell_ms"] = s.dwell_ms;
+ 
+    props["hop_schedule::time"] = s.time;
+    a <<= props;
+}
+
+inline bool operator== (const hop_struct& s1, const hop_struct& s2) {
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.center_frequency!=s2.center_frequency)
+        return false;
+    if (s1.dwell_ms!=s2.dwell_ms)
+        return false;
+    if (s1.time!=s2.time)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const hop_struct& s1, const hop_struct& s2) {
+    return !(s1==s2);
+}
+
+struct low_latency_metric_struct {
+    low_latency_metric_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("low_latency_metrics::low_latency_metric");
+    };
+
+    CORBA::ULong tuner_index;
+    std::string allocation_id;
+    CORBA::ULong pushes;
+    double latency_last_us;
+    double latency_avg_us;
+    double latency_min_us;
+    double latency_max_us;
+};
+
+inline bool operator>>= (const CORBA::Any& a, low_latency_metric_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("low_latency_metrics::tuner_index")) {
+        if (!(props["low_latency_metrics::tuner_index"] >>= s.tuner_index)) return false;
+    }
+    if (props.contains("low_latency_metrics::allocation_id")) {
+        if (!(props["low_latency_metrics::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("low_latency_metrics::pushes")) {
+        if (!(props["low_latency_metrics::pushes"] >>= s.pushes)) return false;
+    }
+    if (props.contains("low_latency_metrics::latency_last_us")) {
+        if (!(props["low_latency_metrics::latency_last_us"] >>= s.latency_last_us)) return false;
+    }
+    if (props.contains("low_latency_metrics::latency_avg_us")) {
+        if (!(props["low_latency_metrics::latency_avg_us"] >>= s.latency_avg_us)) return false;
+    }
+    if (props.contains("low_latency_metrics::latency_min_us")) {
+        if (!(props["low_latency_metrics::latency_min_us"] >>= s.latency_min_us)) return false;
+    }
+    if (props.contains("low_latency_metrics::latency_max_us")) {
+        if (!(props["low_latency_metrics::latency_max_us"] >>= s.latency_max_us)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const low_latency_metric_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["low_latency_metrics::tuner_index"] = s.tuner_index;
+ 
+    props["low_latency_metrics::allocation_id"] = s.allocation_id;
+ 
+    props["low_latency_metrics::pushes"] = s.pushes;
+ 
+    props["low_latency_metrics::latency_last_us"] = s.latency_last_us;
+ 
+    props["low_latency_metrics::latency_avg_us"] = s.latency_avg_us;
+ 
+    props["low_latency_metrics::latency_min_us"] = s.latency_min_us;
+ 
+    props["low_latency_metrics::latency_max_us"] = s.latency_max_us;
+    a <<= props;
+}
+
+inline bool operator== (const low_latency_metric_struct& s1, const low_latency_metric_struct& s2) {
+    if (s1.tuner_index!=s2.tuner_index)
+        return false;
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.pushes!=s2.pushes)
+        return false;
+    if (s1.latency_last_us!=s2.latency_last_us)
+        return false;
+    if (s1.latency_avg_us!=s2.latency_avg_us)
+        return false;
+    if (s1.latency_min_us!=s2.latency_min_us)
+        return false;
+    if (s1.latency_max_us!=s2.latency_max_us)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const low_latency_metric_struct& s1, const low_latency_metric_struct& s2) {
+    return !(s1==s2);
+}
+
+struct rx_agc_struct {
+    rx_agc_struct ()
+    {
+        continuous = false;
+        update_period_ms = 100.0;
+        attack_db = 6.0;
+        decay_db = 1.0;
+        hysteresis_db = 6.0;
+    };
+
+    static std::string getId() {
+        return std::string("rx_agc");
+    };
+
+    bool continuous;
+    double update_period_ms;
+    float attack_db;
+    float decay_db;
+    float hysteresis_db;
+};
+
+inline bool operator>>= (const CORBA::Any& a, rx_agc_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("rx_agc::continuous")) {
+        if (!(props["rx_agc::continuous"] >>= s.continuous)) return false;
+    }
+    if (props.contains("rx_agc::update_period_ms")) {
+        if (!(props["rx_agc::update_period_ms"] >>= s.update_period_ms)) return false;
+    }
+    if (props.contains("rx_agc::attack_db")) {
+        if (!(props["rx_agc::attack_db"] >>= s.attack_db)) return false;
+    }
+    if (props.contains("rx_agc::decay_db")) {
+        if (!(props["rx_agc::decay_db"] >>= s.decay_db)) return false;
+    }
+    if (props.contains("rx_agc::hysteresis_db")) {
+        if (!(props["rx_agc::hysteresis_db"] >>= s.hysteresis_db)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const rx_agc_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["rx_agc::continuous"] = s.continuous;
+ 
+    props["rx_agc::update_period_ms"] = s.update_period_ms;
+ 
+    props["rx_agc::attack_db"] = s.attack_db;
+ 
+    props["rx_agc::decay_db"] = s.decay_db;
+ 
+    props["rx_agc::hysteresis_db"] = s.hysteresis_db;
+    a <<= props;
+}
+
+inline bool operator== (const rx_agc_struct& s1, const rx_agc_struct& s2) {
+    if (s1.continuous!=s2.continuous)
+        return false;
+    if (s1.update_period_ms!=s2.update_period_ms)
+        return false;
+    if (s1.attack_db!=s2.attack_db)
+        return false;
+    if (s1.decay_db!=s2.decay_db)
+        return false;
+    if (s1.hysteresis_db!=s2.hysteresis_db)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const rx_agc_struct& s1, const rx_agc_struct& s2) {
+    return !(s1==s2);
+}
+
+struct rx_enable_struct {
+    rx_enable_struct ()
+    {
+        lo_lock_timeout_ms = 1000.0;
+        lo_lock_poll_us = 100;
+        start_delay_ms = 2.0;
+    };
+
+    static std::string getId() {
+        return std::string("rx_enable");
+    };
+
+    double lo_lock_timeout_ms;
+    CORBA::ULong lo_lock_poll_us;
+    double start_delay_ms;
+};
+
+inline bool operator>>= (const CORBA::Any& a, rx_enable_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("rx_enable::lo_lock_timeout_ms")) {
+        if (!(props["rx_enable::lo_lock_timeout_ms"] >>= s.lo_lock_timeout_ms)) return false;
+    }
+    if (props.contains("rx_enable::lo_lock_poll_us")) {
+        if (!(props["rx_enable::lo_lock_poll_us"] >>= s.lo_lock_poll_us)) return false;
+    }
+    if (props.contains("rx_enable::start_delay_ms")) {
+        if (!(props["rx_enable::start_delay_ms"] >>= s.start_delay_ms)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const rx_enable_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["rx_enable::lo_lock_timeout_ms"] = s.lo_lock_timeout_ms;
+ 
+    props["rx_enable::lo_lock_poll_us"] = s.lo_lock_poll_us;
+ 
+    props["rx_enable::start_delay_ms"] = s.start_delay_ms;
+    a <<= props;
+}
+
+inline bool operator== (const rx_enable_struct& s1, const rx_enable_struct& s2) {
+    if (s1.lo_lock_timeout_ms!=s2.lo_lock_timeout_ms)
+        return false;
+    if (s1.lo_lock_poll_us!=s2.lo_lock_poll_us)
+        return false;
+    if (s1.start_delay_ms!=s2.start_delay_ms)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const rx_enable_struct& s1, const rx_enable_struct& s2) {
+    return !(s1==s2);
+}
+
+struct rx_resampler_struct {
+    rx_resampler_struct ()
+    {
+        enable = false;
+        filter_bandwidth = false;
+        taps_per_phase = 32;
+        max_phases = 256;
+    };
+
+    static std::string getId() {
+        return std::string("rx_resampler");
+    };
+
+    bool enable;
+    bool filter_bandwidth;
+    unsigned short taps_per_phase;
+    unsigned short max_phases;
+};
+
+inline bool operator>>= (const CORBA::Any& a, rx_resampler_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("rx_resampler::enable")) {
+        if (!(props["rx_resampler::enable"] >>= s.enable)) return false;
+    }
+    if (props.contains("rx_resampler::filter_bandwidth")) {
+        if (!(props["rx_resampler::filter_bandwidth"] >>= s.filter_bandwidth)) return false;
+    }
+    if (props.contains("rx_resampler::taps_per_phase")) {
+        if (!(props["rx_resampler::taps_per_phase"] >>= s.taps_per_phase)) return false;
+    }
+    if (props.contains("rx_resampler::max_phases")) {
+        if (!(props["rx_resampler::max_phases"] >>= s.max_phases)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const rx_resampler_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["rx_resampler::enable"] = s.enable;
+ 
+    props["rx_resampler::filter_bandwidth"] = s.filter_bandwidth;
+ 
+    props["rx_resampler::taps_per_phase"] = s.taps_per_phase;
+ 
+    props["rx_resampler::max_phases"] = s.max_phases;
+    a <<= props;
+}
+
+inline bool operator== (const rx_resampler_struct& s1, const rx_resampler_struct& s2) {
+    if (s1.enable!=s2.enable)
+        return false;
+    if (s1.filter_bandwidth!=s2.filter_bandwidth)
+        return false;
+    if (s1.taps_per_phase!=s2.taps_per_phase)
+        return false;
+    if (s1.max_phases!=s2.max_phases)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const rx_resampler_struct& s1, const rx_resampler_struct& s2) {
+    return !(s1==s2);
+}
+
+struct shm_output_struct {
+    shm_output_struct ()
+    {
+        enable = false;
+        name_prefix = "/USRP_UHD";
+        num_slots = 8;
+    };
+
+    static std::string getId() {
+        return std::string("shm_output");
+    };
+
+    bool enable;
+    std::string name_prefix;
+    unsigned short num_slots;
+};
+
+inline bool operator>>= (const CORBA::Any& a, shm_output_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("shm_output::enable")) {
+        if (!(props["shm_output::enable"] >>= s.enable)) return false;
+    }
+    if (props.contains("shm_output::name_prefix")) {
+        if (!(props["shm_output::name_prefix"] >>= s.name_prefix)) return false;
+    }
+    if (props.contains("shm_output::num_slots")) {
+        if (!(props["shm_output::num_slots"] >>= s.num_slots)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const shm_output_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["shm_output::enable"] = s.enable;
+ 
+    props["shm_output::name_prefix"] = s.name_prefix;
+ 
+    props["shm_output::num_slots"] = s.num_slots;
+    a <<= props;
+}
+
+inline bool operator== (const shm_output_struct& s1, const shm_output_struct& s2) {
+    if (s1.enable!=s2.enable)
+        return false;
+    if (s1.name_prefix!=s2.name_prefix)
+        return false;
+    if (s1.num_slots!=s2.num_slots)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const shm_output_struct& s1, const shm_output_struct& s2) {
+    return !(s1==s2);
+}
+
+struct rx_push_queue_struct {
+    rx_push_queue_struct ()
+    {
+        enable = true;
+        max_blocks = 4;
+        overflow_policy = "drop_oldest";
+    };
+
+    static std::string getId() {
+        return std::string("rx_push_queue");
+    };
+
+    bool enable;
+    unsigned short max_blocks;
+    std::string overflow_policy;
+};
+
+inline bool operator>>= (const CORBA::Any& a, rx_push_queue_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("rx_push_queue::enable")) {
+        if (!(props["rx_push_queue::enable"] >>= s.enable)) return false;
+    }
+    if (props.contains("rx_push_queue::max_blocks")) {
+        if (!(props["rx_push_queue::max_blocks"] >>= s.max_blocks)) return false;
+    }
+    if (props.contains("rx_push_queue::overflow_policy")) {
+        if (!(props["rx_push_queue::overflow_policy"] >>= s.overflow_policy)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const rx_push_queue_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["rx_push_queue::enable"] = s.enable;
+ 
+    props["rx_push_queue::max_blocks"] = s.max_blocks;
+ 
+    props["rx_push_queue::overflow_policy"] = s.overflow_policy;
+    a <<= props;
+}
+
+inline bool operator== (const rx_push_queue_struct& s1, const rx_push_queue_struct& s2) {
+    if (s1.enable!=s2.enable)
+        return false;
+    if (s1.max_blocks!=s2.max_blocks)
+        return false;
+    if (s1.overflow_policy!=s2.overflow_policy)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const rx_push_queue_struct& s1, const rx_push_queue_struct& s2) {
+    return !(s1==s2);
+}
+
+struct tuner_signal_stat_struct {
+    tuner_signal_stat_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("tuner_signal_stats::tuner_signal_stat");
+    };
+
+    CORBA::ULong tuner_index;
+    std::string allocation_id;
+    CORBA::ULong num_samps;
+    double power_dbfs;
+    double peak_dbfs;
+    double clip_rate;
+    double noise_floor_dbfs;
+};
+
+inline bool operator>>= (const CORBA::Any& a, tuner_signal_stat_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("tuner_signal_stats::tuner_index")) {
+        if (!(props["tuner_signal_stats::tuner_index"] >>= s.tuner_index)) return false;
+    }
+    if (props.contains("tuner_signal_stats::allocation_id")) {
+        if (!(props["tuner_signal_stats::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("tuner_signal_stats::num_samps")) {
+        if (!(props["tuner_signal_stats::num_samps"] >>= s.num_samps)) return false;
+    }
+    if (props.contains("tuner_signal_stats::power_dbfs")) {
+        if (!(props["tuner_signal_stats::power_dbfs"] >>= s.power_dbfs)) return false;
+    }
+    if (props.contains("tuner_signal_stats::peak_dbfs")) {
+        if (!(props["tuner_signal_stats::peak_dbfs"] >>= s.peak_dbfs)) return false;
+    }
+    if (props.contains("tuner_signal_stats::clip_rate")) {
+        if (!(props["tuner_signal_stats::clip_rate"] >>= s.clip_rate)) return false;
+    }
+    if (props.contains("tuner_signal_stats::noise_floor_dbfs")) {
+        if (!(props["tuner_signal_stats::noise_floor_dbfs"] >>= s.noise_floor_dbfs)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const tuner_signal_stat_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["tuner_signal_stats::tuner_index"] = s.tuner_index;
+ 
+    props["tuner_signal_stats::allocation_id"] = s.allocation_id;
+ 
+    props["tuner_signal_stats::num_samps"] = s.num_samps;
+ 
+    props["tuner_signal_stats::power_dbfs"] = s.power_dbfs;
+ 
+    props["tuner_signal_stats::peak_dbfs"] = s.peak_dbfs;
+ 
+    props["tuner_signal_stats::clip_rate"] = s.clip_rate;
+ 
+    props["tuner_signal_stats::noise_floor_dbfs"] = s.noise_floor_dbfs;
+    a <<= props;
+}
+
+inline bool operator== (const tuner_signal_stat_struct& s1, const tuner_signal_stat_struct& s2) {
+    if (s1.tuner_index!=s2.tuner_index)
+        return false;
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.num_samps!=s2.num_samps)
+        return false;
+    if (s1.power_dbfs!=s2.power_dbfs)
+        return false;
+    if (s1.peak_dbfs!=s2.peak_dbfs)
+        return false;
+    if (s1.clip_rate!=s2.clip_rate)
+        return false;
+    if (s1.noise_floor_dbfs!=s2.noise_floor_dbfs)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const tuner_signal_stat_struct& s1, const tuner_signal_stat_struct& s2) {
+    return !(s1==s2);
+}
+
+struct hot_path_metric_struct {
+    hot_path_metric_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("hot_path_metrics::hot_path_metric");
+    };
+
+    CORBA::ULong tuner_index;
+    std::string tuner_type;
+    CORBA::ULongLong samps;
+    CORBA::ULongLong recv_calls;
+    CORBA::ULongLong overflows;
+    CORBA::ULongLong timeouts;
+    CORBA::ULongLong recv_errors;
+    CORBA::ULongLong short_pushes;
+    double short_push_avg_us;
+    double short_push_max_us;
+    CORBA::ULongLong sdds_pushes;
+    double sdds_push_avg_us;
+    double sdds_push_max_us;
+    CORBA::ULongLong sdds_packets;
+    CORBA::ULongLong sdds_bytes;
+    CORBA::ULongLong sdds_send_errors;
+    CORBA::ULongLong sdds_dropped_samps;
+    CORBA::ULongLong sdds_queue_high_water;
+    CORBA::ULongLong send_calls;
+    CORBA::ULongLong short_sends;
+};
+
+inline bool operator>>= (const CORBA::Any& a, hot_path_metric_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("hot_path_metrics::tuner_index")) {
+        if (!(props["hot_path_metrics::tuner_index"] >>= s.tuner_index)) return false;
+    }
+    if (props.contains("hot_path_metrics::tuner_type")) {
+        if (!(props["hot_path_metrics::tuner_type"] >>= s.tuner_type)) return false;
+    }
+    if (props.contains("hot_path_metrics::samps")) {
+        if (!(props["hot_path_metrics::samps"] >>= s.samps)) return false;
+    }
+    if (props.contains("hot_path_metrics::recv_calls")) {
+        if (!(props["hot_path_metrics::recv_calls"] >>= s.recv_calls)) return false;
+    }
+    if (props.contains("hot_path_metrics::overflows")) {
+        if (!(props["hot_path_metrics::overflows"] >>= s.overflows)) return false;
+    }
+    if (props.contains("hot_path_metrics::timeouts")) {
+        if (!(props["hot_path_metrics::timeouts"] >>= s.timeouts)) return false;
+    }
+    if (props.contains("hot_path_metrics::recv_errors")) {
+        if (!(props["hot_path_metrics::recv_errors"] >>= s.recv_errors)) return false;
+    }
+    if (props.contains("hot_path_metrics::short_pushes")) {
+        if (!(props["hot_path_metrics::short_pushes"] >>= s.short_pushes)) return false;
+    }
+    if (props.contains("hot_path_metrics::short_push_avg_us")) {
+        if (!(props["hot_path_metrics::short_push_avg_us"] >>= s.short_push_avg_us)) return false;
+    }
+    if (props.contains("hot_path_metrics::short_push_max_us")) {
+        if (!(props["hot_path_metrics::short_push_max_us"] >>= s.short_push_max_us)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_pushes")) {
+        if (!(props["hot_path_metrics::sdds_pushes"] >>= s.sdds_pushes)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_push_avg_us")) {
+        if (!(props["hot_path_metrics::sdds_push_avg_us"] >>= s.sdds_push_avg_us)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_push_max_us")) {
+        if (!(props["hot_path_metrics::sdds_push_max_us"] >>= s.sdds_push_max_us)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_packets")) {
+        if (!(props["hot_path_metrics::sdds_packets"] >>= s.sdds_packets)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_bytes")) {
+        if (!(props["hot_path_metrics::sdds_bytes"] >>= s.sdds_bytes)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_send_errors")) {
+        if (!(props["hot_path_metrics::sdds_send_errors"] >>= s.sdds_send_errors)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_dropped_samps")) {
+        if (!(props["hot_path_metrics::sdds_dropped_samps"] >>= s.sdds_dropped_samps)) return false;
+    }
+    if (props.contains("hot_path_metrics::sdds_queue_high_water")) {
+        if (!(props["hot_path_metrics::sdds_queue_high_water"] >>= s.sdds_queue_high_water)) return false;
+    }
+    if (props.contains("hot_path_metrics::send_calls")) {
+        if (!(props["hot_path_metrics::send_calls"] >>= s.send_calls)) return false;
+    }
+    if (props.contains("hot_path_metrics::short_sends")) {
+        if (!(props["hot_path_metrics::short_sends"] >>= s.short_sends)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const hot_path_metric_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["hot_path_metrics::tuner_index"] = s.tuner_index;
+ 
+    props["hot_path_metrics::tuner_type"] = s.tuner_type;
+ 
+    props["hot_path_metrics::samps"] = s.samps;
+ 
+    props["hot_path_metrics::recv_calls"] = s.recv_calls;
+ 
+    props["hot_path_metrics::overflows"] = s.overflows;
+ 
+    props["hot_path_metrics::timeouts"] = s.timeouts;
+ 
+    props["hot_path_metrics::recv_errors"] = s.recv_errors;
+ 
+    props["hot_path_metrics::short_pushes"] = s.short_pushes;
+ 
+    props["hot_path_metrics::short_push_avg_us"] = s.short_push_avg_us;
+ 
+    props["hot_path_metrics::short_push_max_us"] = s.short_push_max_us;
+ 
+    props["hot_path_metrics::sdds_pushes"] = s.sdds_pushes;
+ 
+    props["hot_path_metrics::sdds_push_avg_us"] = s.sdds_push_avg_us;
+ 
+    props["hot_path_metrics::sdds_push_max_us"] = s.sdds_push_max_us;
+ 
+    props["hot_path_metrics::sdds_packets"] = s.sdds_packets;
+ 
+    props["hot_path_metrics::sdds_bytes"] = s.sdds_bytes;
+ 
+    props["hot_path_metrics::sdds_send_errors"] = s.sdds_send_errors;
+ 
+    props["hot_path_metrics::sdds_dropped_samps"] = s.sdds_dropped_samps;
+ 
+    props["hot_path_metrics::sdds_queue_high_water"] = s.sdds_queue_high_water;
+ 
+    props["hot_path_metrics::send_calls"] = s.send_calls;
+ 
+    props["hot_path_metrics::short_sends"] = s.short_sends;
+    a <<= props;
+}
+
+inline bool operator== (const hot_path_metric_struct& s1, const hot_path_metric_struct& s2) {
+    if (s1.tuner_index!=s2.tuner_index)
+        return false;
+    if (s1.tuner_type!=s2.tuner_type)
+        return false;
+    if (s1.samps!=s2.samps)
+        return false;
+    if (s1.recv_calls!=s2.recv_calls)
+        return false;
+    if (s1.overflows!=s2.overflows)
+        return false;
+    if (s1.timeouts!=s2.timeouts)
+        return false;
+    if (s1.recv_errors!=s2.recv_errors)
+        return false;
+    if (s1.short_pushes!=s2.short_pushes)
+        return false;
+    if (s1.short_push_avg_us!=s2.short_push_avg_us)
+        return false;
+    if (s1.short_push_max_us!=s2.short_push_max_us)
+        return false;
+    if (s1.sdds_pushes!=s2.sdds_pushes)
+        return false;
+    if (s1.sdds_push_avg_us!=s2.sdds_push_avg_us)
+        return false;
+    if (s1.sdds_push_max_us!=s2.sdds_push_max_us)
+        return false;
+    if (s1.sdds_packets!=s2.sdds_packets)
+        return false;
+    if (s1.sdds_bytes!=s2.sdds_bytes)
+        return false;
+    if (s1.sdds_send_errors!=s2.sdds_send_errors)
+        return false;
+    if (s1.sdds_dropped_samps!=s2.sdds_dropped_samps)
+        return false;
+    if (s1.sdds_queue_high_water!=s2.sdds_queue_high_water)
+        return false;
+    if (s1.send_calls!=s2.send_calls)
+        return false;
+    if (s1.short_sends!=s2.short_sends)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const hot_path_metric_struct& s1, const hot_path_metric_struct& s2) {
+    return !(s1==s2);
+}
+
+struct hot_path_metrics_settings_struct {
+    hot_path_metrics_settings_struct ()
+    {
+        update_period_ms = 1000.0;
+        dump_path = "";
+    };
+
+    static std::string getId() {
+        return std::string("hot_path_metrics_settings");
+    };
+
+    double update_period_ms;
+    std::string dump_path;
+};
+
+inline bool operator>>= (const CORBA::Any& a, hot_path_metrics_settings_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("hot_path_metrics_settings::update_period_ms")) {
+        if (!(props["hot_path_metrics_settings::update_period_ms"] >>= s.update_period_ms)) return false;
+    }
+    if (props.contains("hot_path_metrics_settings::dump_path")) {
+        if (!(props["hot_path_metrics_settings::dump_path"] >>= s.dump_path)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const hot_path_metrics_settings_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["hot_path_metrics_settings::update_period_ms"] = s.update_period_ms;
+ 
+    props["hot_path_metrics_settings::dump_path"] = s.dump_path;
+    a <<= props;
+}
+
+inline bool operator== (const hot_path_metrics_settings_struct& s1, const hot_path_metrics_settings_struct& s2) {
+    if (s1.update_period_ms!=s2.update_period_ms)
+        return false;
+    if (s1.dump_path!=s2.dump_path)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const hot_path_metrics_settings_struct& s1, const hot_path_metrics_settings_struct& s2) {
+    return !(s1==s2);
+}
+
+struct latency_histogram_struct {
+    latency_histogram_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("latency_histograms::latency_histogram");
+    };
+
+    CORBA::ULong tuner_index;
+    std::string stage;
+    CORBA::ULongLong count;
+    double p50_us;
+    double p90_us;
+    double p99_us;
+    double p999_us;
+    double max_us;
+};
+
+inline bool operator>>= (const CORBA::Any& a, latency_histogram_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("latency_histograms::tuner_index")) {
+        if (!(props["latency_histograms::tuner_index"] >>= s.tuner_index)) return false;
+    }
+    if (props.contains("latency_histograms::stage")) {
+        if (!(props["latency_histograms::stage"] >>= s.stage)) return false;
+    }
+    if (props.contains("latency_histograms::count")) {
+        if (!(props["latency_histograms::count"] >>= s.count)) return false;
+    }
+    if (props.contains("latency_histograms::p50_us")) {
+        if (!(props["latency_histograms::p50_us"] >>= s.p50_us)) return false;
+    }
+    if (props.contains("latency_histograms::p90_us")) {
+        if (!(props["latency_histograms::p90_us"] >>= s.p90_us)) return false;
+    }
+    if (props.contains("latency_histograms::p99_us")) {
+        if (!(props["latency_histograms::p99_us"] >>= s.p99_us)) return false;
+    }
+    if (props.contains("latency_histograms::p999_us")) {
+        if (!(props["latency_histograms::p999_us"] >>= s.p999_us)) return false;
+    }
+    if (props.contains("latency_histograms::max_us")) {
+        if (!(props["latency_histograms::max_us"] >>= s.max_us)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const latency_histogram_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["latency_histograms::tuner_index"] = s.tuner_index;
+ 
+    props["latency_histograms::stage"] = s.stage;
+ 
+    props["latency_histograms::count"] = s.count;
+ 
+    props["latency_histograms::p50_us"] = s.p50_us;
+ 
+    props["latency_histograms::p90_us"] = s.p90_us;
+ 
+    props["latency_histograms::p99_us"] = s.p99_us;
+ 
+    props["latency_histograms::p999_us"] = s.p999_us;
+ 
+    props["latency_histograms::max_us"] = s.max_us;
+    a <<= props;
+}
+
+inline bool operator== (const latency_histogram_struct& s1, const latency_histogram_struct& s2) {
+    if (s1.tuner_index!=s2.tuner_index)
+        return false;
+    if (s1.stage!=s2.stage)
+        return false;
+    if (s1.count!=s2.count)
+        return false;
+    if (s1.p50_us!=s2.p50_us)
+        return false;
+    if (s1.p90_us!=s2.p90_us)
+        return false;
+    if (s1.p99_us!=s2.p99_us)
+        return false;
+    if (s1.p999_us!=s2.p999_us)
+        return false;
+    if (s1.max_us!=s2.max_us)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const latency_histogram_struct& s1, const latency_histogram_struct& s2) {
+    return !(s1==s2);
+}
+
+struct push_queue_metric_struct {
+    push_queue_metric_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("push_queue_metrics::push_queue_metric");
+    };
+
+    std::string port;
+    bool async;
+    CORBA::ULongLong blocks;
+    CORBA::ULongLong high_water;
+    CORBA::ULongLong queued;
+    CORBA::ULongLong pushes;
+    double push_avg_us;
+    double push_max_us;
+    CORBA::ULongLong dropped_blocks;
+    CORBA::ULongLong dropped_samps;
+    CORBA::ULongLong blocked;
+    double blocked_ms;
+};
+
+inline bool operator>>= (const CORBA::Any& a, push_queue_metric_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("push_queue_metrics::port")) {
+        if (!(props["push_queue_metrics::port"] >>= s.port)) return false;
+    }
+    if (props.contains("push_queue_metrics::async")) {
+        if (!(props["push_queue_metrics::async"] >>= s.async)) return false;
+    }
+    if (props.contains("push_queue_metrics::blocks")) {
+        if (!(props["push_queue_metrics::blocks"] >>= s.blocks)) return false;
+    }
+    if (props.contains("push_queue_metrics::high_water")) {
+        if (!(props["push_queue_metrics::high_water"] >>= s.high_water)) return false;
+    }
+    if (props.contains("push_queue_metrics::queued")) {
+        if (!(props["push_queue_metrics::queued"] >>= s.queued)) return false;
+    }
+    if (props.contains("push_queue_metrics::pushes")) {
+        if (!(props["push_queue_metrics::pushes"] >>= s.pushes)) return false;
+    }
+    if (props.contains("push_queue_metrics::push_avg_us")) {
+        if (!(props["push_queue_metrics::push_avg_us"] >>= s.push_avg_us)) return false;
+    }
+    if (props.contains("push_queue_metrics::push_max_us")) {
+        if (!(props["push_queue_metrics::push_max_us"] >>= s.push_max_us)) return false;
+    }
+    if (props.contains("push_queue_metrics::dropped_blocks")) {
+        if (!(props["push_queue_metrics::dropped_blocks"] >>= s.dropped_blocks)) return false;
+    }
+    if (props.contains("push_queue_metrics::dropped_samps")) {
+        if (!(props["push_queue_metrics::dropped_samps"] >>= s.dropped_samps)) return false;
+    }
+    if (props.contains("push_queue_metrics::blocked")) {
+        if (!(props["push_queue_metrics::blocked"] >>= s.blocked)) return false;
+    }
+    if (props.contains("push_queue_metrics::blocked_ms")) {
+        if (!(props["push_queue_metrics::blocked_ms"] >>= s.blocked_ms)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const push_queue_metric_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["push_queue_metrics::port"] = s.port;
+ 
+    props["push_queue_metrics::async"] = s.async;
+ 
+    props["push_queue_metrics::blocks"] = s.blocks;
+ 
+    props["push_queue_metrics::high_water"] = s.high_water;
+ 
+    props["push_queue_metrics::queued"] = s.queued;
+ 
+    props["push_queue_metrics::pushes"] = s.pushes;
+ 
+    props["push_queue_metrics::push_avg_us"] = s.push_avg_us;
+ 
+    props["push_queue_metrics::push_max_us"] = s.push_max_us;
+ 
+    props["push_queue_metrics::dropped_blocks"] = s.dropped_blocks;
+ 
+    props["push_queue_metrics::dropped_samps"] = s.dropped_samps;
+ 
+    props["push_queue_metrics::blocked"] = s.blocked;
+ 
+    props["push_queue_metrics::blocked_ms"] = s.blocked_ms;
+    a <<= props;
+}
+
+inline bool operator== (const push_queue_metric_struct& s1, const push_queue_metric_struct& s2) {
+    if (s1.port!=s2.port)
+        return false;
+    if (s1.async!=s2.async)
+        return false;
+    if (s1.blocks!=s2.blocks)
+        return false;
+    if (s1.high_water!=s2.high_water)
+        return false;
+    if (s1.queued!=s2.queued)
+        return false;
+    if (s1.pushes!=s2.pushes)
+        return false;
+    if (s1.push_avg_us!=s2.push_avg_us)
+        return false;
+    if (s1.push_max_us!=s2.push_max_us)
+        return false;
+    if (s1.dropped_blocks!=s2.dropped_blocks)
+        return false;
+    if (s1.dropped_samps!=s2.dropped_samps)
+        return false;
+    if (s1.blocked!=s2.blocked)
+        return false;
+    if (s1.blocked_ms!=s2.blocked_ms)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const push_queue_metric_struct& s1, const push_queue_metric_struct& s2) {
+    return !(s1==s2);
+}
+
+struct trace_settings_struct {
+    trace_settings_struct ()
+    {
+        enabled = false;
+        ring_events = 65536;
+        dump_on_overflow = true;
+        dump_path = "/tmp/USRP_UHD_trace.bin";
+    };
+
+    static std::string getId() {
+        return std::string("trace_settings");
+    };
+
+    bool enabled;
+    CORBA::ULong ring_events;
+    bool dump_on_overflow;
+    std::string dump_path;
+};
+
+inline bool operator>>= (const CORBA::Any& a, trace_settings_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("trace_settings::enabled")) {
+        if (!(props["trace_settings::enabled"] >>= s.enabled)) return false;
+    }
+    if (props.contains("trace_settings::ring_events")) {
+        if (!(props["trace_settings::ring_events"] >>= s.ring_events)) return false;
+    }
+    if (props.contains("trace_settings::dump_on_overflow")) {
+        if (!(props["trace_settings::dump_on_overflow"] >>= s.dump_on_overflow)) return false;
+    }
+    if (props.contains("trace_settings::dump_path")) {
+        if (!(props["trace_settings::dump_path"] >>= s.dump_path)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const trace_settings_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["trace_settings::enabled"] = s.enabled;
+ 
+    props["trace_settings::ring_events"] = s.ring_events;
+ 
+    props["trace_settings::dump_on_overflow"] = s.dump_on_overflow;
+ 
+    props["trace_settings::dump_path"] = s.dump_path;
+    a <<= props;
+}
+
+inline bool operator== (const trace_settings_struct& s1, const trace_settings_struct& s2) {
+    if (s1.enabled!=s2.enabled)
+        return false;
+    if (s1.ring_events!=s2.ring_events)
+        return false;
+    if (s1.dump_on_overflow!=s2.dump_on_overflow)
+        return false;
+    if (s1.dump_path!=s2.dump_path)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const trace_settings_struct& s1, const trace_settings_struct& s2) {
+    return !(s1==s2);
+}
+
+struct sim_device_struct {
+    sim_device_struct ()
+    {
+        num_rx_channels = 2;
+        num_tx_channels = 1;
+        master_clock_rate = 32000000.0;
+        max_decimation = 256;
+        freq_min = 50000000.0;
+        freq_max = 6000000000.0;
+        bandwidth_min = 200000.0;
+        bandwidth_max = 56000000.0;
+        gain_max = 31.5;
+        signal = "tone";
+        tone_offset = 100000.0;
+        tone_dbfs = -40.0;
+        noise_dbfs = -80.0;
+        time_scale = 1.0;
+        lo_lock_time_ms = 0.0;
+        inject_overflow = false;
+        inject_timeout = false;
+    };
+
+    static std::string getId() {
+        return std::string("sim_device");
+    };
+
+    unsigned short num_rx_channels;
+    unsigned short num_tx_channels;
+    double master_clock_rate;
+    unsigned short max_decimation;
+    double freq_min;
+    double freq_max;
+    double bandwidth_min;
+    double bandwidth_max;
+    float gain_max;
+    std::string signal;
+    double tone_offset;
+    float tone_dbfs;
+    float noise_dbfs;
+    double time_scale;
+    double lo_lock_time_ms;
+    bool inject_overflow;
+    bool inject_timeout;
+};
+
+inline bool operator>>= (const CORBA::Any& a, sim_device_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("sim_device::num_rx_channels")) {
+        if (!(props["sim_device::num_rx_channels"] >>= s.num_rx_channels)) return false;
+    }
+    if (props.contains("sim_device::num_tx_channels")) {
+        if (!(props["sim_device::num_tx_channels"] >>= s.num_tx_channels)) return false;
+    }
+    if (props.contains("sim_device::master_clock_rate")) {
+        if (!(props["sim_device::master_clock_rate"] >>= s.master_clock_rate)) return false;
+    }
+    if (props.contains("sim_device::max_decimation")) {
+        if (!(props["sim_device::max_decimation"] >>= s.max_decimation)) return false;
+    }
+    if (props.contains("sim_device::freq_min")) {
+        if (!(props["sim_device::freq_min"] >>= s.freq_min)) return false;
+    }
+    if (props.contains("sim_device::freq_max")) {
+        if (!(props["sim_device::freq_max"] >>= s.freq_max)) return false;
+    }
+    if (props.contains("sim_device::bandwidth_min")) {
+        if (!(props["sim_device::bandwidth_min"] >>= s.bandwidth_min)) return false;
+    }
+    if (props.contains("sim_device::bandwidth_max")) {
+        if (!(props["sim_device::bandwidth_max"] >>= s.bandwidth_max)) return false;
+    }
+    if (props.contains("sim_device::gain_max")) {
+        if (!(props["sim_device::gain_max"] >>= s.gain_max)) return false;
+    }
+    if (props.contains("sim_device::signal")) {
+        if (!(props["sim_device::signal"] >>= s.signal)) return false;
+    }
+    if (props.contains("sim_device::tone_offset")) {
+        if (!(props["sim_device::tone_offset"] >>= s.tone_offset)) return false;
+    }
+    if (props.contains("sim_device::tone_dbfs")) {
+        if (!(props["sim_device::tone_dbfs"] >>= s.tone_dbfs)) return false;
+    }
+    if (props.contains("sim_device::noise_dbfs")) {
+        if (!(props["sim_device::noise_dbfs"] >>= s.noise_dbfs)) return false;
+    }
+    if (props.contains("sim_device::time_scale")) {
+        if (!(props["sim_device::time_scale"] >>= s.time_scale)) return false;
+    }
+    if (props.contains("sim_device::lo_lock_time_ms")) {
+        if (!(props["sim_device::lo_lock_time_ms"] >>= s.lo_lock_time_ms)) return false;
+    }
+    if (props.contains("sim_device::inject_overflow")) {
+        if (!(props["sim_device::inject_overflow"] >>= s.inject_overflow)) return false;
+    }
+    if (props.contains("sim_device::inject_timeout")) {
+        if (!(props["sim_device::inject_timeout"] >>= s.inject_timeout)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const sim_device_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["sim_device::num_rx_channels"] = s.num_rx_channels;
+ 
+    props["sim_device::num_tx_channels"] = s.num_tx_channels;
+ 
+    props["sim_device::master_clock_rate"] = s.master_clock_rate;
+ 
+    props["sim_device::max_decimation"] = s.max_decimation;
+ 
+    props["sim_device::freq_min"] = s.freq_min;
+ 
+    props["sim_device::freq_max"] = s.freq_max;
+ 
+    props["sim_device::bandwidth_min"] = s.bandwidth_min;
+ 
+    props["sim_device::bandwidth_max"] = s.bandwidth_max;
+ 
+    props["sim_device::gain_max"] = s.gain_max;
+ 
+    props["sim_device::signal"] = s.signal;
+ 
+    props["sim_device::tone_offset"] = s.tone_offset;
+ 
+    props["sim_device::tone_dbfs"] = s.tone_dbfs;
+ 
+    props["sim_device::noise_dbfs"] = s.noise_dbfs;
+ 
+    props["sim_device::time_scale"] = s.time_scale;
+ 
+    props["sim_device::lo_lock_time_ms"] = s.lo_lock_time_ms;
+ 
+    props["sim_device::inject_overflow"] = s.inject_overflow;
+ 
+    props["sim_device::inject_timeout"] = s.inject_timeout;
+    a <<= props;
+}
+
+inline bool operator== (const sim_device_struct& s1, const sim_device_struct& s2) {
+    if (s1.num_rx_channels!=s2.num_rx_channels)
+        return false;
+    if (s1.num_tx_channels!=s2.num_tx_channels)
+        return false;
+    if (s1.master_clock_rate!=s2.master_clock_rate)
+        return false;
+    if (s1.max_decimation!=s2.max_decimation)
+        return false;
+    if (s1.freq_min!=s2.freq_min)
+        return false;
+    if (s1.freq_max!=s2.freq_max)
+        return false;
+    if (s1.bandwidth_min!=s2.bandwidth_min)
+        return false;
+    if (s1.bandwidth_max!=s2.bandwidth_max)
+        return false;
+    if (s1.gain_max!=s2.gain_max)
+        return false;
+    if (s1.signal!=s2.signal)
+        return false;
+    if (s1.tone_offset!=s2.tone_offset)
+        return false;
+    if (s1.tone_dbfs!=s2.tone_dbfs)
+        return false;
+    if (s1.noise_dbfs!=s2.noise_dbfs)
+        return false;
+    if (s1.time_scale!=s2.time_scale)
+        return false;
+    if (s1.lo_lock_time_ms!=s2.lo_lock_time_ms)
+        return false;
+    if (s1.inject_overflow!=s2.inject_overflow)
+        return false;
+    if (s1.inject_timeout!=s2.inject_timeout)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const sim_device_struct& s1, const sim_device_struct& s2) {
+    return !(s1==s2);
+}
+
+struct spectrum_scan_struct {
+    spectrum_scan_struct ()
+    {
+        allocation_id = "";
+        start_frequency = 0.0;
+        stop_frequency = 0.0;
+        fft_size = 1024;
+        averages = 8;
+        step_fraction = 0.75;
+        settle_ms = 1.0;
+    };
+
+    static std::string getId() {
+        return std::string("spectrum_scan");
+    };
+
+    std::string allocation_id;
+    double start_frequency;
+    double stop_frequency;
+    CORBA::ULong fft_size;
+    unsigned short averages;
+    double step_fraction;
+    double settle_ms;
+};
+
+inline bool operator>>= (const CORBA::Any& a, spectrum_scan_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("spectrum_scan::allocation_id")) {
+        if (!(props["spectrum_scan::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("spectrum_scan::start_frequency")) {
+        if (!(props["spectrum_scan::start_frequency"] >>= s.start_frequency)) return false;
+    }
+    if (props.contains("spectrum_scan::stop_frequency")) {
+        if (!(props["spectrum_scan::stop_frequency"] >>= s.stop_frequency)) return false;
+    }
+    if (props.contains("spectrum_scan::fft_size")) {
+        if (!(props["spectrum_scan::fft_size"] >>= s.fft_size)) return false;
+    }
+    if (props.contains("spectrum_scan::averages")) {
+        if (!(props["spectrum_scan::averages"] >>= s.averages)) return false;
+    }
+    if (props.contains("spectrum_scan::step_fraction")) {
+        if (!(props["spectrum_scan::step_fraction"] >>= s.step_fraction)) return false;
+    }
+    if (props.contains("spectrum_scan::settle_ms")) {
+        if (!(props["spectrum_scan::settle_ms"] >>= s.settle_ms)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const spectrum_scan_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["spectrum_scan::allocation_id"] = s.allocation_id;
+ 
+    props["spectrum_scan::start_frequency"] = s.start_frequency;
+ 
+    props["spectrum_scan::stop_frequency"] = s.stop_frequency;
+ 
+    props["spectrum_scan::fft_size"] = s.fft_size;
+ 
+    props["spectrum_scan::averages"] = s.averages;
+ 
+    props["spectrum_scan::step_fraction"] = s.step_fraction;
+ 
+    props["spectrum_scan::settle_ms"] = s.settle_ms;
+    a <<= props;
+}
+
+inline bool operator== (const spectrum_scan_struct& s1, const spectrum_scan_struct& s2) {
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.start_frequency!=s2.start_frequency)
+        return false;
+    if (s1.stop_frequency!=s2.stop_frequency)
+        return false;
+    if (s1.fft_size!=s2.fft_size)
+        return false;
+    if (s1.averages!=s2.averages)
+        return false;
+    if (s1.step_fraction!=s2.step_fraction)
+        return false;
+    if (s1.settle_ms!=s2.settle_ms)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const spectrum_scan_struct& s1, const spectrum_scan_struct& s2) {
+    return !(s1==s2);
+}
+
+struct spectrum_scan_result_struct {
+    spectrum_scan_result_struct ()
+    {
+    };
+
+    static std::string getId() {
+        return std::string("spectrum_scan_result");
+    };
+
+    std::string allocation_id;
+    double start_frequency;
+    double bin_spacing;
+    CORBA::ULong sweeps;
+    double sweep_time_ms;
+    std::vector<float> psd_dbfs;
+};
+
+inline bool operator>>= (const CORBA::Any& a, spectrum_scan_result_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("spectrum_scan_result::allocation_id")) {
+        if (!(props["spectrum_scan_result::allocation_id"] >>= s.allocation_id)) return false;
+    }
+    if (props.contains("spectrum_scan_result::start_frequency")) {
+        if (!(props["spectrum_scan_result::start_frequency"] >>= s.start_frequency)) return false;
+    }
+    if (props.contains("spectrum_scan_result::bin_spacing")) {
+        if (!(props["spectrum_scan_result::bin_spacing"] >>= s.bin_spacing)) return false;
+    }
+    if (props.contains("spectrum_scan_result::sweeps")) {
+        if (!(props["spectrum_scan_result::sweeps"] >>= s.sweeps)) return false;
+    }
+    if (props.contains("spectrum_scan_result::sweep_time_ms")) {
+        if (!(props["spectrum_scan_result::sweep_time_ms"] >>= s.sweep_time_ms)) return false;
+    }
+    if (props.contains("spectrum_scan_result::psd_dbfs")) {
+        if (!(props["spectrum_scan_result::psd_dbfs"] >>= s.psd_dbfs)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const spectrum_scan_result_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["spectrum_scan_result::allocation_id"] = s.allocation_id;
+ 
+    props["spectrum_scan_result::start_frequency"] = s.start_frequency;
+ 
+    props["spectrum_scan_result::bin_spacing"] = s.bin_spacing;
+ 
+    props["spectrum_scan_result::sweeps"] = s.sweeps;
+ 
+    props["spectrum_scan_result::sweep_time_ms"] = s.sweep_time_ms;
+ 
+    props["spectrum_scan_result::psd_dbfs"] = s.psd_dbfs;
+    a <<= props;
+}
+
+inline bool operator== (const spectrum_scan_result_struct& s1, const spectrum_scan_result_struct& s2) {
+    if (s1.allocation_id!=s2.allocation_id)
+        return false;
+    if (s1.start_frequency!=s2.start_frequency)
+        return false;
+    if (s1.bin_spacing!=s2.bin_spacing)
+        return false;
+    if (s1.sweeps!=s2.sweeps)
+        return false;
+    if (s1.sweep_time_ms!=s2.sweep_time_ms)
+        return false;
+    if (s1.psd_dbfs!=s2.psd_dbfs)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const spectrum_scan_result_struct& s1, const spectrum_scan_result_struct& s2) {
+    return !(s1==s2);
+}
+
+struct time_sync_status_struct {
+    time_sync_status_struct ()
+    {
+        method = "none";
+        synchronized = false;
+        num_mboards = 0;
+        host_offset_ms = 0.0;
+        detail = "";
+    };
+
+    static std::string getId() {
+        return std::string("time_sync_status");
+    };
+
+    std::string method;
+    bool synchronized;
+    unsigned short num_mboards;
+    double host_offset_ms;
+    std::string detail;
+};
+
+inline bool operator>>= (const CORBA::Any& a, time_sync_status_struct& s) {
+    CF::Properties* temp;
+    if (!(a >>= temp)) return false;
+    const redhawk::PropertyMap& props = redhawk::PropertyMap::cast(*temp);
+    if (props.contains("time_sync_status::method")) {
+        if (!(props["time_sync_status::method"] >>= s.method)) return false;
+    }
+    if (props.contains("time_sync_status::synchronized")) {
+        if (!(props["time_sync_status::synchronized"] >>= s.synchronized)) return false;
+    }
+    if (props.contains("time_sync_status::num_mboards")) {
+        if (!(props["time_sync_status::num_mboards"] >>= s.num_mboards)) return false;
+    }
+    if (props.contains("time_sync_status::host_offset_ms")) {
+        if (!(props["time_sync_status::host_offset_ms"] >>= s.host_offset_ms)) return false;
+    }
+    if (props.contains("time_sync_status::detail")) {
+        if (!(props["time_sync_status::detail"] >>= s.detail)) return false;
+    }
+    return true;
+}
+
+inline void operator<<= (CORBA::Any& a, const time_sync_status_struct& s) {
+    redhawk::PropertyMap props;
+ 
+    props["time_sync_status::method"] = s.method;
+ 
+    props["time_sync_status::synchronized"] = s.synchronized;
+ 
+    props["time_sync_status::num_mboards"] = s.num_mboards;
+ 
+    props["time_sync_status::host_offset_ms"] = s.host_offset_ms;
+ 
+    props["time_sync_status::detail"] = s.detail;
+    a <<= props;
+}
+
+inline bool operator== (const time_sync_status_struct& s1, const time_sync_status_struct& s2) {
+    if (s1.method!=s2.method)
+        return false;
+    if (s1.synchronized!=s2.synchronized)
+        return false;
+    if (s1.num_mboards!=s2.num_mboards)
+        return false;
+    if (s1.host_offset_ms!=s2.host_offset_ms)
+        return false;
+    if (s1.detail!=s2.detail)
+        return false;
+    return true;
+}
+
+inline bool operator!= (const time_sync_status_struct& s1, const time_sync_status_struct& s2) {
+    return !(s1==s2);
+}
+
 #endif // STRUCTPROPS_H
@@ -0,0 +1,127 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of latencyHistogram: the bucket resolution over the whole range, the percentiles of known
+ * distributions, and clear() and requestReset().
+ */
+
+#include <stdint.h>
+#include <vector>
+
+#include "HotPathMetrics.h"
+#include "unit_test.h"
+
+namespace {
+
+// a value alone in a histogram is reported as the middle of its bucket, within half a bucket (1/(2*sub_count)) of it
+void checkResolution(uint64_t value){
+    latencyHistogram histogram;
+    histogram.record(value);
+    const latencySummary summary = histogram.summarize();
+    const double tol = (value < latencyHistogram::sub_count) ? 0.0 : double(value)/(2*latencyHistogram::sub_count);
+    CHECK(summary.count == 1);
+    CHECK_NEAR(summary.p50, double(value), tol);
+    CHECK_NEAR(summary.p999, double(value), tol);
+    CHECK(summary.max == double(value));
+}
+
+}
+
+int main(){
+    // values below sub_count have a bucket each
+    for (uint64_t value = 0; value < latencyHistogram::sub_count; value++)
+        checkResolution(value);
+    // and above it, each power of two is split into sub_count buckets, at either end of a power of two
+    for (unsigned magnitude = latencyHistogram::sub_bits; magnitude <= latencyHistogram::max_magnitude; magnitude++) {
+        const uint64_t power = uint64_t(1) << magnitude;
+        checkResolution(power);
+        checkResolution(power + power/3);
+        checkResolution(2*power-1);
+
+        // both ends of the bucket above power are reported as its middle
+        const uint64_t width = power >> latencyHistogram::sub_bits;
+        for (uint64_t value = power+width; value < power+2*width; value += width-1) {
+            latencyHistogram histogram;
+            histogram.record(value);
+            CHECK(histogram.summarize().p50 == power + width + 0.5*width);
+            if (width == 1)
+                break;
+        }
+    }
+
+    // negative durations (a clock step) count as 0, and values past the range go in the last bucket
+    latencyHistogram clamped;
+    clamped.record(-5);
+    CHECK(clamped.summarize().p50 == 0.0);
+    const uint64_t huge = uint64_t(1) << 50;
+    clamped.record(huge);
+    latencySummary summary = clamped.summarize();
+    CHECK(summary.count == 2);
+    CHECK(summary.max == double(huge));
+    CHECK(summary.p999 >= double(uint64_t(1) << latencyHistogram::max_magnitude));
+    CHECK(summary.p999 < double(uint64_t(1) << (latencyHistogram::max_magnitude+1)));
+
+    // percentiles of 1 to 10000 us, uniform
+    latencyHistogram uniform;
+    CHECK(uniform.summarize().count == 0);
+    CHECK(uniform.summarize().p99 == 0.0);
+    for (uint64_t us = 1; us <= 10000; us++)
+        uniform.record(us*1000);
+    summary = uniform.summarize();
+    CHECK(summary.count == 10000);
+    CHECK_NEAR(summary.p50, 5000e3, 5000e3/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p90, 9000e3, 9000e3/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p99, 9900e3, 9900e3/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p999, 9990e3, 9990e3/latencyHistogram::sub_count);
+    CHECK(summary.max == 10000e3);
+
+    // a long tail: 1% of the values are 1000 times the rest
+    latencyHistogram tail;
+    for (int i = 0; i < 990; i++)
+        tail.record(2000);
+    for (int i = 0; i < 10; i++)
+        tail.record(2000000);
+    summary = tail.summarize();
+    CHECK_NEAR(summary.p50, 2000, 2000.0/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p90, 2000, 2000.0/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p99, 2000, 2000.0/latencyHistogram::sub_count);
+    CHECK_NEAR(summary.p999, 2000000, 2000000.0/latencyHistogram::sub_count);
+
+    // a reset requested by a reader reports nothing until the writer's next record, which clears the rest
+    tail.requestReset();
+    summary = tail.summarize();
+    CHECK(summary.count == 0);
+    CHECK(summary.max == 0.0);
+    tail.record(100);
+    summary = tail.summarize();
+    CHECK(summary.count == 1);
+    CHECK(summary.max == 100.0);
+    CHECK_NEAR(summary.p999, 100, 100.0/latencyHistogram::sub_count);
+    tail.requestReset();
+    tail.requestReset();
+    tail.record(7);
+    CHECK(tail.summarize().count == 1);
+
+    uniform.clear();
+    summary = uniform.summarize();
+    CHECK(summary.count == 0);
+    CHECK(summary.max == 0.0);
+    return unitTestResult("test_latency_histogram");
+}
@@ -0,0 +1,249 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of asyncPushQueue against a slow fake port: each overflow policy keeps order, never drops SRI or
+ * EOS and accounts for every block, calls are made directly while not async, and the per stream push metrics
+ * are kept until the stream's EOS.
+ */
+
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <boost/thread.hpp>
+
+#include "PushQueue.h"
+#include "unit_test.h"
+
+namespace {
+
+const int NUM_BLOCKS = 50;
+const size_t BLOCK_SIZE = 100;
+
+// stands in for a BulkIO output port, taking delay_us per pushPacket
+struct fakePort {
+    struct call {
+        bool sri;
+        short value; // first value of the block
+        bool EOS;
+        boost::thread::id thread;
+    };
+
+    fakePort() : delay_us(0) {}
+
+    void pushSRI(const BULKIO::StreamSRI &sri){
+        call c = {true, 0, false, boost::this_thread::get_id()};
+        calls.push_back(c);
+    }
+
+    void pushPacket(std::vector<short> &data, const BULKIO::PrecisionUTCTime &T, bool EOS, const std::string &stream_id){
+        if (delay_us)
+            usleep(delay_us);
+        call c = {false, data[0], EOS, boost::this_thread::get_id()};
+        calls.push_back(c);
+    }
+
+    size_t packets() const {
+        size_t n = 0;
+        for (size_t i = 0; i < calls.size(); i++)
+            n += calls[i].sri ? 0 : 1;
+        return n;
+    }
+
+    long delay_us;
+    std::vector<call> calls; // written by one thread at a time, read once it is done
+};
+
+typedef asyncPushQueue<fakePort, short> shortPushQueue;
+
+// the push thread, which the device runs per output port
+class pushThread {
+public:
+    pushThread(shortPushQueue &queue) : queue(queue), running(true), thread(boost::ref(*this)) {}
+
+    void operator()(){
+        while (running)
+            queue.service(10);
+    }
+
+    void stop(){
+        running = false;
+        thread.join();
+    }
+
+private:
+    shortPushQueue &queue;
+    volatile bool running;
+    boost::thread thread;
+};
+
+// NUM_BLOCKS blocks numbered from 0, as fast as the queue takes them, the last one with EOS
+void pushBlocks(shortPushQueue &queue, const std::string &stream_id){
+    std::vector<short> block(BLOCK_SIZE);
+    const BULKIO::PrecisionUTCTime T = bulkio::time::utils::now();
+    for (int i = 0; i < NUM_BLOCKS; i++) {
+        block[0] = i;
+        queue.pushPacket(block, T, i == NUM_BLOCKS-1, stream_id, hotPathNow());
+    }
+}
+
+void checkPolicy(pushOverflowPolicy policy){
+    fakePort port;
+    port.delay_us = 2000;
+    shortPushQueue queue(&port);
+    queue.configure(2, policy);
+    queue.setAsync(true);
+    CHECK(queue.isAsync());
+    pushThread thread(queue);
+    queue.pushSRI(bulkio::sri::create("policy"));
+    pushBlocks(queue, "policy");
+    CHECK(queue.drain(5000));
+    thread.stop();
+
+    // SRI first, blocks in order, and the EOS last
+    CHECK(!port.calls.empty() && port.calls[0].sri);
+    for (size_t i = 2; i < port.calls.size(); i++)
+        CHECK(!port.calls[i].sri && port.calls[i].value > port.calls[i-1].value);
+    CHECK(port.calls.back().value == NUM_BLOCKS-1 && port.calls.back().EOS);
+
+    const pushQueueMetrics &metrics = queue.getMetrics();
+    CHECK(port.packets()+metrics.dropped_blocks.get() == size_t(NUM_BLOCKS));
+    CHECK(metrics.dropped_samps.get() == metrics.dropped_blocks.get()*BLOCK_SIZE);
+    CHECK(metrics.push.calls.get() == port.packets());
+    CHECK(metrics.high_water.get() <= 3); // max_blocks, and an EOS, which does not wait for room
+    if (policy == PUSH_BLOCK) {
+        CHECK(metrics.dropped_blocks.get() == 0);
+        CHECK(metrics.blocked.get() > 0);
+        CHECK(metrics.blocked_ns.get() > 0);
+    } else {
+        CHECK(metrics.dropped_blocks.get() > 0);
+        CHECK(metrics.blocked.get() == 0);
+    }
+
+    // the stream's metrics go with its EOS
+    hotPathStage push;
+    latencySummary origin_to_push;
+    CHECK(!queue.getStreamMetrics("policy", push, origin_to_push));
+}
+
+}
+
+int main(){
+    checkPolicy(PUSH_DROP_OLDEST);
+    checkPolicy(PUSH_DROP_NEWEST);
+    checkPolicy(PUSH_BLOCK);
+
+    // while not async, calls are made by the calling thread and nothing is queued
+    {
+        fakePort port;
+        shortPushQueue queue(&port);
+        queue.pushSRI(bulkio::sri::create("direct"));
+        pushBlocks(queue, "direct");
+        CHECK(port.calls.size() == size_t(NUM_BLOCKS+1));
+        for (size_t i = 0; i < port.calls.size(); i++)
+            CHECK(port.calls[i].thread == boost::this_thread::get_id());
+        CHECK(queue.getMetrics().queued.get() == 0);
+    }
+
+    // clearing async drops the blocks still queued
+    {
+        fakePort port;
+        shortPushQueue queue(&port);
+        queue.configure(8, PUSH_DROP_OLDEST);
+        queue.setAsync(true);
+        std::vector<short> block(BLOCK_SIZE);
+        const BULKIO::PrecisionUTCTime T = bulkio::time::utils::now();
+        queue.pushSRI(bulkio::sri::create("cleared"));
+        for (int i = 0; i < 3; i++)
+            CHECK(queue.pushPacket(block, T, false, "cleared"));
+        CHECK(queue.size() == 3);
+        queue.setAsync(false);
+        CHECK(queue.size() == 0);
+        CHECK(queue.getMetrics().dropped_blocks.get() == 3);
+        CHECK(!queue.service(0));
+        CHECK(port.calls.empty());
+
+        // drop_newest reports the block it dropped
+        queue.configure(1, PUSH_DROP_NEWEST);
+        queue.setAsync(true);
+        CHECK(queue.pushPacket(block, T, false, "cleared"));
+        CHECK(!queue.pushPacket(block, T, false, "cleared"));
+        CHECK(queue.pushPacket(block, T, true, "cleared"));
+        CHECK(queue.size() == 2);
+        queue.setAsync(false);
+    }
+
+    // direct calls are made by the calling thread, once nothing of the same stream is queued ahead of them
+    {
+        fakePort port;
+        shortPushQueue queue(&port);
+        queue.configure(8, PUSH_BLOCK);
+        queue.setAsync(true);
+        std::vector<short> block(BLOCK_SIZE);
+        const BULKIO::PrecisionUTCTime T = bulkio::time::utils::now();
+        block[0] = 0;
+        queue.pushPacket(block, T, false, "queued");
+        block[0] = 1;
+        queue.pushPacket(block, T, false, "queued", 0, true); // behind block 0
+        CHECK(port.calls.empty());
+        queue.pushSRI(bulkio::sri::create("direct"), true);
+        block[0] = 2;
+        queue.pushPacket(block, T, false, "direct", 0, true);
+        CHECK(port.calls.size() == 2 && port.calls[0].sri && port.calls[1].value == 2);
+        CHECK(queue.size() == 2);
+        CHECK(queue.service(0) && queue.service(0));
+        CHECK(port.calls.size() == 4 && port.calls[2].value == 0 && port.calls[3].value == 1);
+        block[0] = 3;
+        queue.pushPacket(block, T, false, "queued", 0, true);
+        CHECK(port.calls.size() == 5 && port.calls[4].value == 3);
+        for (size_t i = 0; i < port.calls.size(); i++)
+            CHECK(port.calls[i].thread == boost::this_thread::get_id());
+    }
+
+    // per stream push metrics, with origin_to_push for blocks given an origin time
+    {
+        fakePort port;
+        shortPushQueue queue(&port);
+        queue.configure(NUM_BLOCKS, PUSH_BLOCK);
+        queue.setAsync(true);
+        pushThread thread(queue);
+        std::vector<short> block(BLOCK_SIZE);
+        const BULKIO::PrecisionUTCTime T = bulkio::time::utils::now();
+        for (int i = 0; i < 10; i++)
+            queue.pushPacket(block, T, false, "timed", i < 5 ? hotPathNow() : 0);
+        CHECK(queue.drain(5000));
+        hotPathStage push;
+        latencySummary origin_to_push;
+        CHECK(queue.getStreamMetrics("timed", push, origin_to_push));
+        CHECK(push.calls.get() == 10);
+        CHECK(origin_to_push.count == 5);
+        CHECK(origin_to_push.max > 0.0);
+
+        // a reset takes effect with the next block recorded
+        queue.resetLatency();
+        queue.pushPacket(block, T, false, "timed", hotPathNow());
+        CHECK(queue.drain(5000));
+        hotPathStage push_after;
+        CHECK(queue.getStreamMetrics("timed", push_after, origin_to_push));
+        CHECK(push_after.calls.get() == 11);
+        CHECK(origin_to_push.count == 1);
+        thread.stop();
+    }
+    return unitTestResult("test_push_queue");
+}
@@ -0,0 +1,130 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of polyphaseResampler: ratio selection, unity gain at DC, stopband rejection, and that the output
+ * does not depend on how the input is split into blocks.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "Resampler.h"
+#include "unit_test.h"
+
+namespace {
+
+// complex tone at freq (fraction of the sample rate) and amplitude, num_samps long
+std::vector<short> tone(double freq, double amplitude, size_t num_samps){
+    std::vector<short> samps(2*num_samps);
+    for (size_t i = 0; i < num_samps; i++) {
+        samps[2*i] = short(floor(amplitude*cos(2*M_PI*freq*i) + 0.5));
+        samps[2*i+1] = short(floor(amplitude*sin(2*M_PI*freq*i) + 0.5));
+    }
+    return samps;
+}
+
+// rms magnitude of the output samps from skip on
+double rms(const std::vector<short> &samps, size_t skip){
+    double sum = 0.0;
+    size_t n = 0;
+    for (size_t i = skip; 2*i+1 < samps.size(); i++, n++)
+        sum += double(samps[2*i])*samps[2*i] + double(samps[2*i+1])*samps[2*i+1];
+    return n ? sqrt(sum/n) : 0.0;
+}
+
+std::vector<short> resample(polyphaseResampler &resampler, const std::vector<short> &in){
+    std::vector<short> out(2*resampler.outputSize(in.size()/2));
+    const size_t num_out = resampler.process(&in[0], in.size()/2, out.empty() ? NULL : &out[0]);
+    CHECK(num_out == out.size()/2);
+    return out;
+}
+
+}
+
+int main(){
+    size_t up, down;
+    polyphaseResampler::ratio(3.2e6, 3e6, 64, up, down);
+    CHECK(up == 15 && down == 16);
+    polyphaseResampler::ratio(1e6, 2e6, 64, up, down); // no upsampling
+    CHECK(up == 1 && down == 1);
+    polyphaseResampler::ratio(32e6, 10e6, 4, up, down); // 5/16 needs 5 phases, so the closest rate above it
+    CHECK(up == 1 && down == 3);
+    polyphaseResampler::ratio(25e6, 7e6, 100, up, down);
+    CHECK(up <= 100 && double(up)/down >= 7.0/25.0);
+    CHECK(up == 7 && down == 25);
+
+    // unity gain at DC on every phase
+    polyphaseResampler resampler;
+    CHECK(!resampler.configured());
+    resampler.configure(15, 16, 0.45, 16);
+    CHECK(resampler.configured());
+    std::vector<short> dc(2*2000);
+    for (size_t i = 0; i < dc.size(); i += 2) {
+        dc[i] = 8000;
+        dc[i+1] = -4000;
+    }
+    std::vector<short> out = resample(resampler, dc);
+    CHECK(out.size()/2 == 2000*15/16);
+    for (size_t i = 20; i < out.size()/2; i++) {
+        CHECK(abs(out[2*i]-8000) <= 4);
+        CHECK(abs(out[2*i+1]+4000) <= 4);
+    }
+
+    // decimating by 4 passes a tone inside the new band and rejects one outside of it
+    resampler.configure(1, 4, 0.1, 32);
+    const double pass = rms(resample(resampler, tone(0.02, 10000, 8000)), 16);
+    resampler.reset();
+    const double stop = rms(resample(resampler, tone(0.3, 10000, 8000)), 16);
+    CHECK_NEAR(pass, 10000, 200);
+    CHECK(20*log10(stop/pass) < -50);
+
+    // blocks of any size give the same output as one block, and outputSize() predicts each one
+    srand(1);
+    std::vector<short> noise(2*5000);
+    for (size_t i = 0; i < noise.size(); i++)
+        noise[i] = short(rand() % 20001 - 10000);
+    resampler.configure(15, 16, 0.45, 24);
+    const std::vector<short> whole = resample(resampler, noise);
+    resampler.reset();
+    std::vector<short> pieces;
+    const size_t block_sizes[] = {1, 7, 15, 16, 17, 100, 333};
+    for (size_t used = 0, b = 0; used < noise.size()/2; b++) {
+        const size_t n = std::min(block_sizes[b % 7], noise.size()/2-used);
+        const std::vector<short> block(noise.begin()+2*used, noise.begin()+2*(used+n));
+        const std::vector<short> block_out = resample(resampler, block);
+        pieces.insert(pieces.end(), block_out.begin(), block_out.end());
+        used += n;
+    }
+    CHECK(pieces == whole);
+
+    // in place
+    resampler.reset();
+    std::vector<short> in_place(noise);
+    const size_t num_out = resampler.process(&in_place[0], in_place.size()/2, &in_place[0]);
+    CHECK(num_out == whole.size()/2);
+    CHECK(std::equal(whole.begin(), whole.end(), in_place.begin()));
+
+    // the first output is centered on the filter delay, before the first input samp
+    resampler.configure(1, 1, 0.5, 16);
+    CHECK_NEAR(resampler.nextOutputOffset(), -7.5, 1e-12);
+    return unitTestResult("test_resampler");
+}
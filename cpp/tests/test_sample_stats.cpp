@@ -0,0 +1,105 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of sampleStats: the SSE2 path against a plain reference, including the -32768 edge and lengths
+ * that leave a scalar tail, and merge().
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+
+#include "SampleStats.h"
+#include "unit_test.h"
+
+namespace {
+
+void reference(const std::vector<short> &data, unsigned short clip_level, sampleStats &stats){
+    for (size_t i = 0; i < data.size(); i++) {
+        const int v = data[i];
+        const unsigned short v_abs = (unsigned short) std::min(v < 0 ? -v : v, 0x7fff);
+        stats.peak = std::max(stats.peak, v_abs);
+        stats.sum_sq += double(v)*v;
+        if (clip_level > 0 && v_abs >= clip_level)
+            stats.clipped++;
+    }
+    stats.num_values += data.size();
+}
+
+void checkSame(const std::vector<short> &data, unsigned short clip_level){
+    sampleStats expected, actual;
+    reference(data, clip_level, expected);
+    actual.accumulate(data.empty() ? NULL : &data[0], data.size(), clip_level);
+    CHECK(actual.peak == expected.peak);
+    CHECK(actual.sum_sq == expected.sum_sq);
+    CHECK(actual.num_values == expected.num_values);
+    CHECK(actual.clipped == expected.clipped);
+}
+
+}
+
+int main(){
+    srand(1);
+    const unsigned short clip_levels[] = {0, 1, 1000, 32767};
+    const size_t lengths[] = {0, 1, 7, 8, 9, 64, 1001};
+    for (size_t l = 0; l < sizeof(lengths)/sizeof(lengths[0]); l++) {
+        for (size_t c = 0; c < sizeof(clip_levels)/sizeof(clip_levels[0]); c++) {
+            std::vector<short> data(lengths[l]);
+            for (size_t i = 0; i < data.size(); i++)
+                data[i] = short(rand() % 65536 - 32768);
+            checkSame(data, clip_levels[c]);
+        }
+    }
+
+    // full scale values in the vector loop and in the tail: -32768 reads as 32767, and clips at full scale
+    std::vector<short> full(11, 0);
+    full[2] = -32768;
+    full[9] = -32768;
+    full[10] = 32767;
+    checkSame(full, 32767);
+    sampleStats stats;
+    stats.accumulate(&full[0], full.size(), 32767);
+    CHECK(stats.peak == 32767);
+    CHECK(stats.clipped == 3);
+    CHECK(stats.sum_sq == 2*32768.0*32768.0 + 32767.0*32767.0);
+
+    // accumulating in pieces, or merging the pieces, gives what one call does
+    std::vector<short> data(500);
+    for (size_t i = 0; i < data.size(); i++)
+        data[i] = short(rand() % 4001 - 2000);
+    sampleStats whole, pieces, first, second;
+    whole.accumulate(&data[0], data.size(), 1500);
+    pieces.accumulate(&data[0], 203, 1500);
+    pieces.accumulate(&data[203], data.size()-203, 1500);
+    first.accumulate(&data[0], 203, 1500);
+    second.accumulate(&data[203], data.size()-203, 1500);
+    first.merge(second);
+    for (int i = 0; i < 2; i++) {
+        const sampleStats &s = i ? first : pieces;
+        CHECK(s.peak == whole.peak);
+        CHECK(s.sum_sq == whole.sum_sq);
+        CHECK(s.num_values == whole.num_values);
+        CHECK(s.clipped == whole.clipped);
+    }
+
+    whole.reset();
+    CHECK(whole.peak == 0 && whole.sum_sq == 0.0 && whole.num_values == 0 && whole.clipped == 0);
+    return unitTestResult("test_sample_stats");
+}
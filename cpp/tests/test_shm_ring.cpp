@@ -0,0 +1,215 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of shmRingWriter and shmRingReader in one process: blocks arrive in order and intact, a reader that
+ * falls behind loses the oldest blocks and is told so, a waiting reader wakes on commit and on destroy, and a
+ * block overwritten while it is held is reported. Also checks which names and existing objects create() accepts.
+ */
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <sstream>
+
+#include "ShmRing.h"
+#include "unit_test.h"
+
+namespace {
+
+const size_t NUM_SLOTS = 4;
+const size_t MAX_SAMPLES = 64;
+
+void publish(shmRingWriter &writer, short value){
+    shmRingBlock *block = writer.begin();
+    block->num_samples = MAX_SAMPLES;
+    block->flags = 0;
+    block->xdelta = 1e-6;
+    strncpy(block->stream_id, "test_stream", sizeof(block->stream_id));
+    for (size_t i = 0; i < MAX_SAMPLES; i++)
+        block->samples()[i] = value;
+    writer.commit();
+}
+
+bool holds(const shmRingBlock *block, short value){
+    if (!block || block->num_samples != MAX_SAMPLES || strcmp(block->stream_id, "test_stream") != 0)
+        return false;
+    for (size_t i = 0; i < block->num_samples; i++) {
+        if (block->samples()[i] != value)
+            return false;
+    }
+    return true;
+}
+
+// publishes one block, or destroys the ring, after 50 ms
+struct delayedWriter {
+    shmRingWriter *writer;
+    bool destroy;
+};
+
+void* runDelayed(void *arg){
+    delayedWriter *delayed = static_cast<delayedWriter*>(arg);
+    usleep(50000);
+    if (delayed->destroy)
+        delayed->writer->destroy();
+    else
+        publish(*delayed->writer, 99);
+    return NULL;
+}
+
+// pid of a process that has exited
+pid_t exitedPid(){
+    const pid_t pid = fork();
+    if (pid == 0)
+        _exit(0);
+    waitpid(pid, NULL, 0);
+    return pid;
+}
+
+// a shared memory object of size bytes, with a ring header written by writer_pid if magic is set
+void makeObject(const std::string &name, size_t bytes, bool magic, pid_t writer_pid){
+    const int fd = shm_open(name.c_str(), O_RDWR|O_CREAT|O_TRUNC, S_IRUSR|S_IWUSR);
+    CHECK(fd >= 0 && ftruncate(fd, bytes) == 0);
+    if (magic) {
+        shmRingHeader header;
+        memset(&header, 0, sizeof(header));
+        header.magic = SHM_RING_MAGIC;
+        header.version = SHM_RING_VERSION;
+        header.writer_pid = writer_pid;
+        CHECK(pwrite(fd, &header, sizeof(header), 0) == ssize_t(sizeof(header)));
+    }
+    close(fd);
+}
+
+bool exists(const std::string &name){
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0)
+        return false;
+    close(fd);
+    return true;
+}
+
+void checkCreate(const std::string &name){
+    shmRingWriter writer;
+    CHECK(!writer.create("", NUM_SLOTS, MAX_SAMPLES));
+    CHECK(!writer.create("no_slash", NUM_SLOTS, MAX_SAMPLES));
+    CHECK(!writer.create("/two/components", NUM_SLOTS, MAX_SAMPLES));
+    CHECK(!writer.create("/", NUM_SLOTS, MAX_SAMPLES));
+
+    // readable by user and group only
+    CHECK(writer.create(name, NUM_SLOTS, MAX_SAMPLES));
+    const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    struct stat st;
+    CHECK(fd >= 0 && fstat(fd, &st) == 0 && (st.st_mode & (S_IWGRP|S_IRWXO)) == 0);
+    close(fd);
+
+    // a ring of a running writer, or something that is not a ring, is left alone
+    shmRingWriter other;
+    makeObject(name+"_live", 4096, true, getppid());
+    CHECK(!other.create(name+"_live", NUM_SLOTS, MAX_SAMPLES));
+    CHECK(exists(name+"_live"));
+    makeObject(name+"_other", 4096, false, 0);
+    CHECK(!other.create(name+"_other", NUM_SLOTS, MAX_SAMPLES));
+    CHECK(exists(name+"_other"));
+    shm_unlink((name+"_live").c_str());
+    shm_unlink((name+"_other").c_str());
+
+    // a ring left by a writer that exited is replaced
+    makeObject(name+"_stale", 4096, true, exitedPid());
+    CHECK(other.create(name+"_stale", NUM_SLOTS, MAX_SAMPLES));
+    other.destroy();
+    CHECK(!exists(name+"_stale"));
+}
+
+}
+
+int main(){
+    std::ostringstream name;
+    name << "/usrp_uhd_test_shm_ring_" << getpid();
+    checkCreate(name.str());
+
+    shmRingWriter writer;
+    CHECK(!writer.create(name.str(), 1, MAX_SAMPLES));
+    CHECK(!writer.error().empty());
+    CHECK(writer.create(name.str(), NUM_SLOTS, MAX_SAMPLES));
+    CHECK(writer.isOpen() && writer.numSlots() == NUM_SLOTS && writer.maxSamples() == MAX_SAMPLES);
+
+    shmRingReader missing;
+    CHECK(!missing.open(name.str()+"_missing"));
+    CHECK(!missing.error().empty());
+
+    // a reader starts with the next block published
+    publish(writer, 1);
+    shmRingReader reader;
+    CHECK(reader.open(name.str()));
+    CHECK(reader.numSlots() == NUM_SLOTS && reader.maxSamples() == MAX_SAMPLES);
+    CHECK(reader.next(0) == NULL);
+    for (short i = 2; i <= 4; i++)
+        publish(writer, i);
+    for (short i = 2; i <= 4; i++) {
+        CHECK(holds(reader.next(0), i));
+        CHECK(reader.intact());
+    }
+    CHECK(reader.next(0) == NULL);
+    CHECK(reader.lost() == 0);
+
+    // a block held while the writer laps the ring is no longer intact
+    publish(writer, 5);
+    CHECK(holds(reader.next(0), 5));
+    for (short i = 6; i < short(6+NUM_SLOTS); i++)
+        publish(writer, i);
+    CHECK(!reader.intact());
+
+    // a reader more than a ring behind skips to the oldest block the writer is not about to reuse
+    shmRingReader behind;
+    CHECK(behind.open(name.str()));
+    for (short i = 10; i < 20; i++)
+        publish(writer, i);
+    CHECK(holds(behind.next(0), short(20-NUM_SLOTS+1)));
+    CHECK(behind.lost() == 10-NUM_SLOTS+1);
+    for (short i = short(20-NUM_SLOTS+2); i < 20; i++)
+        CHECK(holds(behind.next(0), i));
+    CHECK(behind.next(0) == NULL);
+
+    // next() waits for a commit, and times out without one
+    behind.close();
+    CHECK(behind.open(name.str()));
+    CHECK(behind.next(20) == NULL);
+    delayedWriter delayed = {&writer, false};
+    pthread_t thread;
+    pthread_create(&thread, NULL, runDelayed, &delayed);
+    CHECK(holds(behind.next(2000), 99));
+    pthread_join(thread, NULL);
+
+    // and wakes when the writer removes the ring
+    CHECK(!behind.closed());
+    delayed.destroy = true;
+    pthread_create(&thread, NULL, runDelayed, &delayed);
+    CHECK(behind.next(-1) == NULL);
+    pthread_join(thread, NULL);
+    CHECK(behind.closed());
+    CHECK(!writer.isOpen());
+    CHECK(!missing.open(name.str()));
+    return unitTestResult("test_shm_ring");
+}
@@ -0,0 +1,313 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of simBackend: channel ranges and the coercion of settings, streaming with contiguous time
+ * stamps, bursts, timed and late stream commands, injected and real overflows and timeouts, timed retunes,
+ * the signal level, pacing against the simulated clock, and LO lock.
+ */
+
+#include <math.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <uhd/exception.hpp>
+
+#include "SimBackend.h"
+#include "HotPathMetrics.h"
+#include "unit_test.h"
+
+namespace {
+
+// not paced, so the tests do not wait on the simulated clock, and a tone with no noise
+sim_device_struct unpacedSettings(){
+    sim_device_struct settings;
+    settings.time_scale = 0.0;
+    settings.tone_dbfs = -6.0;
+    settings.noise_dbfs = -200.0;
+    return settings;
+}
+
+uhd::rx_streamer::sptr rxStream(simBackend::sptr sim, size_t chan, const std::string& otw_format = "sc16"){
+    uhd::stream_args_t stream_args("sc16", otw_format);
+    stream_args.channels.push_back(chan);
+    return sim->get_rx_stream(stream_args);
+}
+
+void startStream(simBackend::sptr sim, size_t chan){
+    uhd::stream_cmd_t cmd(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    cmd.stream_now = true;
+    sim->issue_stream_cmd(cmd, chan);
+}
+
+size_t receive(uhd::rx_streamer::sptr stream, std::vector<short>& buff, size_t nsamps, uhd::rx_metadata_t& md,
+        double timeout = 0.1, bool one_packet = false){
+    buff.assign(2*nsamps, 0);
+    return stream->recv(&buff[0], nsamps, md, timeout, one_packet);
+}
+
+double rms(const std::vector<short>& buff, size_t nsamps){
+    double sum_sq = 0.0;
+    for (size_t i = 0; i < 2*nsamps; i++)
+        sum_sq += double(buff[i])*buff[i];
+    return sqrt(sum_sq/nsamps);
+}
+
+void checkRanges(){
+    const sim_device_struct settings;
+    simBackend::sptr sim(new simBackend(settings));
+    CHECK(sim->get_rx_num_channels() == settings.num_rx_channels);
+    CHECK(sim->get_tx_num_channels() == settings.num_tx_channels);
+    CHECK(sim->get_rx_rates(0).start() == settings.master_clock_rate/settings.max_decimation);
+    CHECK(sim->get_rx_rates(0).stop() == settings.master_clock_rate);
+
+    // rates are coerced to the nearest decimation of the master clock, within the decimation range
+    sim->set_rx_rate(3e6, 0);
+    CHECK(sim->get_rx_rate(0) == settings.master_clock_rate/11);
+    CHECK(sim->get_rx_rate(1) == settings.master_clock_rate/settings.max_decimation);
+    sim->set_rx_rate(1e9, 0);
+    CHECK(sim->get_rx_rate(0) == settings.master_clock_rate);
+    sim->set_rx_rate(1.0, 0);
+    CHECK(sim->get_rx_rate(0) == settings.master_clock_rate/settings.max_decimation);
+    sim->set_rx_rate(1e6, simBackend::ALL_CHANS);
+    CHECK(sim->get_rx_rate(0) == 1e6 && sim->get_rx_rate(1) == 1e6);
+
+    // and freq, bandwidth and gain are clipped to their ranges
+    uhd::tune_result_t result = sim->set_rx_freq(uhd::tune_request_t(1e12), 0);
+    CHECK(result.actual_rf_freq == settings.freq_max);
+    CHECK(sim->get_rx_freq(0) == settings.freq_max);
+    sim->set_rx_freq(uhd::tune_request_t(100e6), 0);
+    CHECK(sim->get_rx_freq(0) == 100e6);
+    sim->set_rx_bandwidth(1.0, 0);
+    CHECK(sim->get_rx_bandwidth(0) == settings.bandwidth_min);
+    sim->set_rx_gain(100.0, 1);
+    CHECK(sim->get_rx_gain(1) == settings.gain_max);
+    sim->set_rx_gain(10.2, 1);
+    CHECK(sim->get_rx_gain(1) == 10.0);
+
+    bool thrown = false;
+    try { sim->set_rx_antenna("J1", 0); } catch (const uhd::value_error&) { thrown = true; }
+    CHECK(thrown);
+    sim->set_rx_antenna("TX/RX", 0);
+    CHECK(sim->get_rx_antenna(0) == "TX/RX");
+    thrown = false;
+    try { sim->get_rx_sensor("temp", 0); } catch (const uhd::key_error&) { thrown = true; }
+    CHECK(thrown);
+    thrown = false;
+    try { rxStream(sim, settings.num_rx_channels); } catch (const uhd::index_error&) { thrown = true; }
+    CHECK(thrown);
+    thrown = false;
+    try { sim->get_rx_stream(uhd::stream_args_t("fc32", "sc16")); } catch (const uhd::value_error&) { thrown = true; }
+    CHECK(thrown);
+}
+
+void checkStreaming(){
+    simBackend::sptr sim(new simBackend(unpacedSettings()));
+    sim->set_rx_rate(1e6, 0);
+    uhd::rx_streamer::sptr stream = rxStream(sim, 0);
+    std::vector<short> buff;
+    uhd::rx_metadata_t md;
+
+    // not streaming yet
+    CHECK(receive(stream, buff, 100, md, 0.0) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    startStream(sim, 0);
+    CHECK(receive(stream, buff, 5000, md) == 5000);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_NONE);
+    CHECK(md.has_time_spec && md.start_of_burst);
+    const uhd::time_spec_t start = md.time_spec;
+
+    // one packet at a time, contiguous with the last recv
+    CHECK(receive(stream, buff, 5000, md, 0.1, true) == 2000);
+    CHECK(!md.start_of_burst);
+    CHECK_NEAR((md.time_spec-start).get_real_secs(), 5000/1e6, 1e-9);
+
+    // an injected overflow loses a packet of samps
+    sim->injectOverflow(0);
+    CHECK(receive(stream, buff, 100, md) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+    CHECK(receive(stream, buff, 100, md) == 100);
+    CHECK_NEAR((md.time_spec-start).get_real_secs(), (7000+2000)/1e6, 1e-9);
+
+    // an injected timeout loses none
+    sim->injectTimeout(0);
+    CHECK(receive(stream, buff, 100, md, 0.0) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+    CHECK(receive(stream, buff, 100, md) == 100);
+    CHECK_NEAR((md.time_spec-start).get_real_secs(), (9000+100)/1e6, 1e-9);
+
+    sim->issue_stream_cmd(uhd::stream_cmd_t(uhd::stream_cmd_t::STREAM_MODE_STOP_CONTINUOUS), 0);
+    CHECK(receive(stream, buff, 100, md, 0.0) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+}
+
+void checkStreamCommands(){
+    simBackend::sptr sim(new simBackend(unpacedSettings()));
+    sim->set_rx_rate(1e6, 0);
+    uhd::rx_streamer::sptr stream = rxStream(sim, 0);
+    std::vector<short> buff;
+    uhd::rx_metadata_t md;
+
+    // a burst ends after num_samps
+    uhd::stream_cmd_t burst(uhd::stream_cmd_t::STREAM_MODE_NUM_SAMPS_AND_DONE);
+    burst.num_samps = 3000;
+    burst.stream_now = true;
+    sim->issue_stream_cmd(burst, 0);
+    CHECK(receive(stream, buff, 5000, md) == 3000);
+    CHECK(md.start_of_burst && md.end_of_burst);
+    CHECK(receive(stream, buff, 5000, md, 0.0) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    // a timed start is late if its time has passed
+    uhd::stream_cmd_t timed(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    timed.stream_now = false;
+    timed.time_spec = sim->get_time_now(0) - uhd::time_spec_t(1.0);
+    sim->issue_stream_cmd(timed, 0);
+    CHECK(receive(stream, buff, 100, md) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_LATE_COMMAND);
+    CHECK(receive(stream, buff, 100, md, 0.0) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_TIMEOUT);
+
+    // and otherwise starts at its time
+    timed.time_spec = sim->get_time_now(0) + uhd::time_spec_t(10.0);
+    sim->issue_stream_cmd(timed, 0);
+    CHECK(receive(stream, buff, 100, md) == 100);
+    CHECK(md.start_of_burst);
+    CHECK_NEAR((md.time_spec-timed.time_spec).get_real_secs(), 0.0, 1e-9);
+}
+
+void checkTimedRetune(){
+    sim_device_struct settings = unpacedSettings();
+    settings.tone_offset = 100e3;
+    simBackend::sptr sim(new simBackend(settings));
+    sim->set_rx_rate(1e6, 0);
+    uhd::rx_streamer::sptr stream = rxStream(sim, 0);
+    std::vector<short> buff;
+    uhd::rx_metadata_t md;
+
+    uhd::stream_cmd_t timed(uhd::stream_cmd_t::STREAM_MODE_START_CONTINUOUS);
+    timed.stream_now = false;
+    timed.time_spec = sim->get_time_now(0) + uhd::time_spec_t(1.0);
+    sim->issue_stream_cmd(timed, 0);
+
+    // the freq reads back at once, and the tone restarts at the first samp at the command time
+    const size_t retune_samp = 1001;
+    sim->set_rx_freq_timed(uhd::tune_request_t(200e6), timed.time_spec + uhd::time_spec_t::from_ticks(retune_samp, 1e6), 0);
+    CHECK(sim->get_rx_freq(0) == 200e6);
+    CHECK(receive(stream, buff, 3000, md) == 3000);
+    bool restarted = true;
+    bool continued = true;
+    for (size_t i = 0; i < 20; i++) {
+        restarted = restarted && buff[2*(retune_samp+i)] == buff[2*i] && buff[2*(retune_samp+i)+1] == buff[2*i+1];
+        continued = continued && buff[2*(retune_samp-10+i)] == buff[2*(2*retune_samp-10+i)];
+    }
+    CHECK(restarted);
+    CHECK(!continued);
+}
+
+void checkSignal(){
+    sim_device_struct settings = unpacedSettings();
+    settings.signal = "noise";
+    settings.noise_dbfs = -20.0;
+    simBackend::sptr sim(new simBackend(settings));
+    sim->set_rx_rate(1e6, 0);
+    uhd::rx_streamer::sptr stream = rxStream(sim, 0);
+    std::vector<short> buff;
+    uhd::rx_metadata_t md;
+    startStream(sim, 0);
+
+    // noise power relative to full scale, raised by the gain
+    const size_t nsamps = 100000;
+    CHECK(receive(stream, buff, nsamps, md) == nsamps);
+    CHECK_NEAR(rms(buff, nsamps), 32767*0.1, 32767*0.1*0.05);
+    sim->set_rx_gain(10.0, 0);
+    CHECK(receive(stream, buff, nsamps, md) == nsamps);
+    CHECK_NEAR(rms(buff, nsamps), 32767*0.1*sqrt(10.0), 32767*0.1*sqrt(10.0)*0.05);
+
+    // an sc8 stream is scaled to 8 bits
+    settings.signal = "tone";
+    settings.tone_dbfs = 0.0;
+    settings.noise_dbfs = -200.0;
+    simBackend::sptr sim8(new simBackend(settings));
+    sim8->set_rx_rate(1e6, 0);
+    stream = rxStream(sim8, 0, "sc8");
+    startStream(sim8, 0);
+    CHECK(receive(stream, buff, 10000, md) == 10000);
+    int peak = 0;
+    for (size_t i = 0; i < buff.size(); i++)
+        peak = std::max(peak, abs(buff[i]));
+    CHECK(peak <= 127 && peak >= 120);
+}
+
+void checkPacing(){
+    sim_device_struct settings = unpacedSettings();
+    settings.time_scale = 1.0;
+    simBackend::sptr sim(new simBackend(settings));
+    sim->set_rx_rate(1e6, 0);
+    uhd::rx_streamer::sptr stream = rxStream(sim, 0);
+    std::vector<short> buff;
+    uhd::rx_metadata_t md;
+    startStream(sim, 0);
+
+    // samps are not returned before the simulated clock reaches them
+    const uint64_t start_ns = hotPathNow();
+    CHECK(receive(stream, buff, 20000, md, 1.0) == 20000);
+    CHECK(hotPathNow()-start_ns >= 19000000);
+
+    // a short timeout returns the samps produced by then
+    const size_t partial = receive(stream, buff, 1000000, md, 0.005);
+    CHECK(partial > 0 && partial < 100000);
+
+    // and a receiver that falls behind by more than the device buffers overflows
+    usleep(600000);
+    CHECK(receive(stream, buff, 100, md) == 0);
+    CHECK(md.error_code == uhd::rx_metadata_t::ERROR_CODE_OVERFLOW);
+    CHECK(receive(stream, buff, 100, md) == 100);
+}
+
+void checkTime(){
+    sim_device_struct settings = unpacedSettings();
+    settings.lo_lock_time_ms = 50.0;
+    simBackend::sptr sim(new simBackend(settings));
+
+    sim->set_time_now(uhd::time_spec_t(100.0), 0);
+    CHECK_NEAR(sim->get_time_now(0).get_real_secs(), 100.0, 0.1);
+    sim->set_time_next_pps(uhd::time_spec_t(5.0), 0);
+    CHECK(sim->get_time_now(0) >= uhd::time_spec_t(4.0) && sim->get_time_now(0) < uhd::time_spec_t(5.0));
+    CHECK(sim->get_time_last_pps(0).get_real_secs() == 4.0);
+
+    sim->set_rx_freq(uhd::tune_request_t(100e6), 0);
+    CHECK(!sim->get_rx_sensor("lo_locked", 0).to_bool());
+    usleep(60000);
+    CHECK(sim->get_rx_sensor("lo_locked", 0).to_bool());
+}
+
+}
+
+int main(){
+    checkRanges();
+    checkStreaming();
+    checkStreamCommands();
+    checkTimedRetune();
+    checkSignal();
+    checkPacing();
+    checkTime();
+    return unitTestResult("test_sim_backend");
+}
@@ -0,0 +1,96 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+/* Unit tests of psdAccumulator, the spectrum scan's power spectrum: bin order and scale for tones centered in a
+ * bin, framing across add() calls, and max_frames.
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+#include "SpectrumScan.h"
+#include "unit_test.h"
+
+namespace {
+
+// complex tone at freq (fraction of the sample rate) and amplitude, num_samps long
+std::vector<short> tone(double freq, double amplitude, size_t num_samps){
+    std::vector<short> samps(2*num_samps);
+    for (size_t i = 0; i < num_samps; i++) {
+        samps[2*i] = short(floor(amplitude*cos(2*M_PI*freq*i) + 0.5));
+        samps[2*i+1] = short(floor(amplitude*sin(2*M_PI*freq*i) + 0.5));
+    }
+    return samps;
+}
+
+}
+
+int main(){
+    psdAccumulator psd;
+    CHECK(!psd.configure(0));
+    CHECK(!psd.configure(1000));
+    CHECK(psd.configure(256));
+    CHECK(psd.size() == 256);
+
+    // a full scale tone centered in bin k reads 0 dBFS at bin 128+k, with the window's sidelobes well down
+    const int bins[] = {0, 20, -20, 127, -128};
+    for (size_t b = 0; b < sizeof(bins)/sizeof(bins[0]); b++) {
+        psd.reset();
+        const std::vector<short> samps = tone(bins[b]/256.0, 32767, 4*256);
+        CHECK(psd.add(&samps[0], 4*256, 4) == 4*256);
+        CHECK(psd.frames() == 4);
+        std::vector<float> dbfs;
+        psd.result(32767, 0, 256, dbfs);
+        CHECK(dbfs.size() == 256);
+        const size_t peak = 128+bins[b];
+        CHECK_NEAR(dbfs[peak], 0.0, 0.05);
+        for (size_t i = 0; i < dbfs.size(); i++) {
+            const size_t distance = std::min((i+256-peak) % 256, (peak+256-i) % 256);
+            if (distance == 1)
+                CHECK_NEAR(dbfs[i], -6.02, 0.1); // Hann window, tone on the next bin
+            else if (distance > 1)
+                CHECK(dbfs[i] < -60);
+        }
+    }
+
+    // result() of part of the bins
+    std::vector<float> part;
+    psd.result(32767, 250, 10, part);
+    CHECK(part.size() == 6);
+
+    // a frame split across add() calls is kept until it fills, and add() stops at max_frames
+    psd.reset();
+    const std::vector<short> samps = tone(10/256.0, 1000, 10*256);
+    CHECK(psd.add(&samps[0], 100, 3) == 100);
+    CHECK(psd.frames() == 0);
+    CHECK(psd.add(&samps[200], 156, 3) == 156);
+    CHECK(psd.frames() == 1);
+    CHECK(psd.add(&samps[2*256], 9*256, 3) == 2*256);
+    CHECK(psd.frames() == 3);
+    CHECK(psd.add(&samps[0], 256, 3) == 0);
+    std::vector<float> dbfs;
+    psd.result(32767, 128+10, 1, dbfs);
+    CHECK_NEAR(dbfs[0], 20*log10(1000/32767.0), 0.05);
+
+    psd.reset();
+    CHECK(psd.frames() == 0);
+    return unitTestResult("test_spectrum_scan");
+}
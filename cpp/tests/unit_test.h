@@ -0,0 +1,54 @@
+/*
+ * This file is protected by Copyright. Please refer to the COPYRIGHT file
+ * distributed with this source distribution.
+ *
+ * This file is part of REDHAWK USRP_UHD.
+ *
+ * REDHAWK USRP_UHD is free software: you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by the
+ * Free Software Foundation, either version 3 of the License, or (at your
+ * option) any later version.
+ *
+ * REDHAWK USRP_UHD is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see http://www.gnu.org/licenses/.
+ */
+
+#ifndef USRP_UHD_UNIT_TEST_H
+#define USRP_UHD_UNIT_TEST_H
+
+#include <stdio.h>
+
+/** Minimal checks for the unit tests under tests/, which run with make check. Each test is a main() that
+ *  returns unitTestResult(), so a failed CHECK fails the test but the remaining checks still run.
+ */
+static int unit_test_failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            unit_test_failures++; \
+        } \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tol) \
+    do { \
+        const double check_a = (a), check_b = (b); \
+        if (!(check_a-check_b <= (tol) && check_b-check_a <= (tol))) { \
+            fprintf(stderr, "%s:%d: CHECK_NEAR(%s, %s, %s) failed: %g vs %g\n", __FILE__, __LINE__, #a, #b, #tol, check_a, check_b); \
+            unit_test_failures++; \
+        } \
+    } while (0)
+
+inline int unitTestResult(const char *name){
+    if (unit_test_failures)
+        fprintf(stderr, "%s: %d checks failed\n", name, unit_test_failures);
+    return unit_test_failures ? 1 : 0;
+}
+
+#endif
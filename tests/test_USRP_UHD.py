@@ -21,7 +21,12 @@
 import unittest
 import ossie.utils.testing
 import os
-from omniORB import any
+import threading
+import time
+from omniORB import any, CORBA
+from ossie.cf import CF
+from redhawk.frontendInterfaces import FRONTEND
+from bulkio.bulkioInterfaces import BULKIO, BULKIO__POA
 
 class ResourceTests(ossie.utils.testing.ScaComponentTestCase):
     """Test for all resource implementations in USRP_UHD"""
@@ -81,5 +86,353 @@ class ResourceTests(ossie.utils.testing.ScaComponentTestCase):
     #   ossie.utils.bluefile.bluefile_helpers
     # for modules that will assist with testing resource with BULKIO ports
 
+class ShortReceiver(BULKIO__POA.dataShort):
+    """dataShort consumer that keeps each packet with the SRI in effect when it arrived"""
+
+    def __init__(self, delay=0.0):
+        self.delay = delay
+        self.lock = threading.Lock()
+        self.sris = {}
+        self.packets = []
+
+    def pushSRI(self, H):
+        self.lock.acquire()
+        try:
+            self.sris[H.streamID] = H
+        finally:
+            self.lock.release()
+
+    def pushPacket(self, data, T, EOS, streamID):
+        if self.delay > 0:
+            time.sleep(self.delay)
+        self.lock.acquire()
+        try:
+            self.packets.append(dict(size=len(data)/2, T=T, EOS=EOS, stream_id=streamID, sri=self.sris.get(streamID)))
+        finally:
+            self.lock.release()
+
+    def _get_state(self):
+        return BULKIO.IDLE
+
+    def _get_activeSRIs(self):
+        self.lock.acquire()
+        try:
+            return self.sris.values()
+        finally:
+            self.lock.release()
+
+    def streamPackets(self, stream_id):
+        self.lock.acquire()
+        try:
+            return [pkt for pkt in self.packets if pkt['stream_id'] == stream_id]
+        finally:
+            self.lock.release()
+
+def keyword(sri, kw_id):
+    for kw in sri.keywords:
+        if kw.id == kw_id:
+            return any.from_any(kw.value)
+    return None
+
+def timeDiff(a, b):
+    """a - b in seconds, for PrecisionUTCTime a and b"""
+    return (a.twsec - b.twsec) + (a.tfsec - b.tfsec)
+
+def secondsSince(T, seconds):
+    """T - seconds, for PrecisionUTCTime T and seconds since the epoch"""
+    return (T.twsec - int(seconds)) + (T.tfsec - (seconds - int(seconds)))
+
+class SimDeviceTests(ossie.utils.testing.ScaComponentTestCase):
+    """Tuning, streaming and output behavior against the simulated USRP (target_device type sim)"""
+
+    def setUp(self):
+        ossie.utils.testing.ScaComponentTestCase.setUp(self)
+        execparams = self.getPropertySet(kinds=("execparam",), modes=("readwrite", "writeonly"), includeNil=False)
+        execparams = dict([(x.id, any.from_any(x.value)) for x in execparams])
+        self.launch(execparams)
+        self.allocations = []
+        self.receiver = ShortReceiver()
+        self.receiver_ref = self.receiver._this()
+
+        self.configureStruct('hot_path_metrics_settings', update_period_ms=100.0)
+        self.configureStruct('target_device', type='sim', ip_address='', name='', serial='')
+        self.comp.start()
+
+    def tearDown(self):
+        for alloc in self.allocations:
+            try:
+                self.comp.deallocateCapacity(alloc)
+            except Exception:
+                pass
+        try:
+            self.comp.stop()
+            self.comp.releaseObject()
+        except Exception:
+            pass
+        ossie.utils.testing.ScaComponentTestCase.tearDown(self)
+
+    #######################################################################
+    # Helpers
+
+    def configureStruct(self, prop_id, **fields):
+        """Configure the named fields of struct prop_id, keeping the rest and each field's type"""
+        current = self.comp.query([CF.DataType(id=prop_id, value=any.to_any(None))])[0].value.value()
+        for field in current:
+            name = field.id.split('::')[-1]
+            if fields.has_key(name):
+                if field.value.typecode().kind() == CORBA.tk_null:
+                    field.value = any.to_any(fields[name])
+                else:
+                    field.value = CORBA.Any(field.value.typecode(), fields[name])
+        self.comp.configure([CF.DataType(id=prop_id, value=CORBA.Any(CF._tc_Properties, current))])
+
+    def configureHops(self, hops):
+        """Configure hop_schedule from a list of (allocation_id, center_frequency, dwell_ms, time)"""
+        value = []
+        for allocation_id, center_frequency, dwell_ms, hop_time in hops:
+            value.append(CORBA.Any(CF._tc_Properties, [
+                CF.DataType(id='hop_schedule::allocation_id', value=any.to_any(allocation_id)),
+                CF.DataType(id='hop_schedule::center_frequency', value=any.to_any(float(center_frequency))),
+                CF.DataType(id='hop_schedule::dwell_ms', value=any.to_any(float(dwell_ms))),
+                CF.DataType(id='hop_schedule::time', value=any.to_any(float(hop_time)))]))
+        self.comp.configure([CF.DataType(id='hop_schedule', value=CORBA.Any(CORBA.TypeCode("IDL:omg.org/CORBA/AnySeq:1.0"), value))])
+
+    def querySequence(self, prop_id):
+        """Struct sequence prop_id as a list of dicts keyed by field id"""
+        value = self.comp.query([CF.DataType(id=prop_id, value=any.to_any(None))])[0].value.value()
+        return [dict((field.id, any.from_any(field.value)) for field in entry.value()) for entry in value]
+
+    def tunerAlloc(self, allocation_id, center_frequency, sample_rate, sample_rate_tolerance=20.0, device_control=True):
+        fields = [
+            ('tuner_type', 'RX_DIGITIZER'),
+            ('allocation_id', allocation_id),
+            ('center_frequency', float(center_frequency)),
+            ('bandwidth', 0.0),
+            ('bandwidth_tolerance', 100.0),
+            ('sample_rate', float(sample_rate)),
+            ('sample_rate_tolerance', float(sample_rate_tolerance)),
+            ('device_control', device_control),
+            ('group_id', ''),
+            ('rf_flow_id', '')]
+        props = [CF.DataType(id='FRONTEND::tuner_allocation::'+name, value=any.to_any(value)) for name, value in fields]
+        return [CF.DataType(id='FRONTEND::tuner_allocation', value=CORBA.Any(CF._tc_Properties, props))]
+
+    def allocate(self, allocs, connect=True):
+        """Allocate the tuner_allocation props in allocs with one call, connecting the receiver to each"""
+        props = []
+        for alloc in allocs:
+            props.extend(alloc)
+        if connect:
+            port = self.comp.getPort('dataShort_out')
+            for alloc in allocs:
+                port.connectPort(self.receiver_ref, self.allocationId(alloc))
+        ok = self.comp.allocateCapacity(props)
+        if ok:
+            self.allocations.extend(allocs)
+        return ok
+
+    def deallocate(self, alloc):
+        self.comp.deallocateCapacity(alloc)
+        self.allocations.remove(alloc)
+        self.comp.getPort('dataShort_out').disconnectPort(self.allocationId(alloc))
+
+    def allocationId(self, alloc):
+        for field in alloc[0].value.value():
+            if field.id == 'FRONTEND::tuner_allocation::allocation_id':
+                return any.from_any(field.value)
+        return None
+
+    def tunerStatus(self, allocation_id):
+        for status in self.querySequence('FRONTEND::tuner_status'):
+            if allocation_id in status['FRONTEND::tuner_status::allocation_id_csv'].split(','):
+                return status
+        return None
+
+    def waitPackets(self, stream_id, count, timeout=5.0):
+        end = time.time() + timeout
+        while len(self.receiver.streamPackets(stream_id)) < count and time.time() < end:
+            time.sleep(0.05)
+        packets = self.receiver.streamPackets(stream_id)
+        self.assertTrue(len(packets) >= count, "stream %s: %d of %d packets" % (stream_id, len(packets), count))
+        return packets
+
+    def pushQueueTotals(self):
+        totals = {}
+        for entry in self.querySequence('push_queue_metrics'):
+            if entry['push_queue_metrics::port'] != 'dataShort_out':
+                continue
+            for name in ('pushes', 'dropped_blocks', 'blocked'):
+                totals[name] = totals.get(name, 0) + entry['push_queue_metrics::'+name]
+        return totals
+
+    def rxOverflows(self):
+        return sum([entry['hot_path_metrics::overflows'] for entry in self.querySequence('hot_path_metrics')
+                    if entry['hot_path_metrics::tuner_type'] == 'RX_DIGITIZER'])
+
+    def assertContiguous(self, before, after):
+        """after starts at the sample following the end of before"""
+        xdelta = before['sri'].xdelta
+        self.assertAlmostEqual(timeDiff(after['T'], before['T']), before['size']*xdelta, delta=xdelta/2)
+
+    def firstRetuned(self, packets, center_frequency):
+        """Index of the first packet whose SRI has center_frequency"""
+        for i, pkt in enumerate(packets):
+            if abs(keyword(pkt['sri'], 'CHAN_RF') - center_frequency) < 1.0:
+                return i
+        self.fail("no packet at %f Hz" % center_frequency)
+
+    #######################################################################
+    # Tests
+
+    def testStreaming(self):
+        alloc = self.tunerAlloc('stream_a', 100e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        status = self.tunerStatus('stream_a')
+        self.assertAlmostEqual(status['FRONTEND::tuner_status::sample_rate'], 1e6, delta=1.0)
+
+        # the packets of a stream follow each other with no gaps, at the tuned freq and rate
+        packets = self.waitPackets(status['FRONTEND::tuner_status::stream_id'], 4)
+        for pkt in packets:
+            self.assertAlmostEqual(pkt['sri'].xdelta, 1e-6, delta=1e-15)
+            self.assertAlmostEqual(keyword(pkt['sri'], 'CHAN_RF'), 100e6, delta=1.0)
+        for before, after in zip(packets[:-1], packets[1:]):
+            self.assertContiguous(before, after)
+
+        # an overflow injected into the simulated device is counted, and the stream goes on
+        overflows = self.rxOverflows()
+        self.configureStruct('sim_device', inject_overflow=True)
+        time.sleep(0.5)
+        self.assertTrue(self.rxOverflows() > overflows)
+        count = len(self.receiver.streamPackets(status['FRONTEND::tuner_status::stream_id']))
+        self.waitPackets(status['FRONTEND::tuner_status::stream_id'], count+2)
+
+    def testHopSchedule(self):
+        hop_time = time.time() + 1.5
+        self.configureHops([('hop_a', 105e6, 0.0, hop_time)])
+        alloc = self.tunerAlloc('hop_a', 100e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        stream_id = self.tunerStatus('hop_a')['FRONTEND::tuner_status::stream_id']
+        time.sleep(max(hop_time + 0.5 - time.time(), 0))
+
+        # the SRI changes at the first samp at or after the hop time, with no samps lost around it
+        packets = self.waitPackets(stream_id, 2)
+        i = self.firstRetuned(packets, 105e6)
+        self.assertTrue(i > 0)
+        xdelta = packets[i]['sri'].xdelta
+        self.assertTrue(-xdelta/2 <= secondsSince(packets[i]['T'], hop_time) < xdelta*1.5)
+        self.assertAlmostEqual(keyword(packets[i-1]['sri'], 'CHAN_RF'), 100e6, delta=1.0)
+        self.assertContiguous(packets[i-1], packets[i])
+
+    def testStreamingRetune(self):
+        alloc = self.tunerAlloc('retune_a', 100e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        stream_id = self.tunerStatus('retune_a')['FRONTEND::tuner_status::stream_id']
+        self.waitPackets(stream_id, 2)
+
+        # a retune through the tuner port while streaming works the same way
+        tuner = self.comp.getPort('DigitalTuner_in')._narrow(FRONTEND.DigitalTuner)
+        before = time.time()
+        tuner.setTunerCenterFrequency('retune_a', 102e6)
+        self.assertAlmostEqual(tuner.getTunerCenterFrequency('retune_a'), 102e6, delta=1.0)
+        time.sleep(0.5)
+        packets = self.receiver.streamPackets(stream_id)
+        i = self.firstRetuned(packets, 102e6)
+        self.assertTrue(i > 0)
+        self.assertTrue(secondsSince(packets[i]['T'], before) > -0.05)
+        self.assertAlmostEqual(keyword(packets[i-1]['sri'], 'CHAN_RF'), 100e6, delta=1.0)
+        self.assertContiguous(packets[i-1], packets[i])
+
+    def testBatchAllocation(self):
+        # both RX channels and a listener on the first, in one allocateCapacity call
+        allocs = [self.tunerAlloc('batch_a', 100e6, 1e6),
+                  self.tunerAlloc('batch_b', 100e6, 1e6),
+                  self.tunerAlloc('batch_listener', 100e6, 1e6, device_control=False)]
+        self.assertTrue(self.allocate(allocs))
+        status_a = self.tunerStatus('batch_a')
+        status_b = self.tunerStatus('batch_b')
+        self.assertNotEqual(status_a['FRONTEND::tuner_status::tuner_number'], status_b['FRONTEND::tuner_status::tuner_number'])
+        self.assertNotEqual(self.tunerStatus('batch_listener'), None)
+
+        # the group starts at one time, so the first samps of each stream line up
+        first_a = self.waitPackets(status_a['FRONTEND::tuner_status::stream_id'], 1)[0]
+        first_b = self.waitPackets(status_b['FRONTEND::tuner_status::stream_id'], 1)[0]
+        self.assertTrue(abs(timeDiff(first_a['T'], first_b['T'])) < first_a['sri'].xdelta)
+
+        # a batch with more control requests than tuners is rejected whole
+        for alloc in list(self.allocations):
+            self.deallocate(alloc)
+        allocs = [self.tunerAlloc('batch_c', 100e6, 1e6),
+                  self.tunerAlloc('batch_d', 100e6, 1e6),
+                  self.tunerAlloc('batch_e', 100e6, 1e6)]
+        self.assertFalse(self.allocate(allocs, connect=False))
+        for allocation_id in ('batch_c', 'batch_d', 'batch_e'):
+            self.assertEqual(self.tunerStatus(allocation_id), None)
+
+    def testReallocate(self):
+        alloc = self.tunerAlloc('realloc_a', 100e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        status = self.tunerStatus('realloc_a')
+        self.assertNotEqual(status, None)
+        self.assertAlmostEqual(status['FRONTEND::tuner_status::center_frequency'], 100e6, delta=1.0)
+        self.assertAlmostEqual(status['FRONTEND::tuner_status::sample_rate'], 1e6, delta=1.0)
+        self.waitPackets(status['FRONTEND::tuner_status::stream_id'], 2)
+
+        self.deallocate(alloc)
+        self.assertEqual(self.tunerStatus('realloc_a'), None)
+
+        # the same tuning again is served from the tune cache, and must report what the device is tuned to
+        alloc = self.tunerAlloc('realloc_b', 100e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        again = self.tunerStatus('realloc_b')
+        for field in ('center_frequency', 'sample_rate', 'bandwidth'):
+            self.assertAlmostEqual(again['FRONTEND::tuner_status::'+field], status['FRONTEND::tuner_status::'+field], delta=1.0)
+        packets = self.waitPackets(again['FRONTEND::tuner_status::stream_id'], 2)
+        self.assertAlmostEqual(keyword(packets[-1]['sri'], 'CHAN_RF'), 100e6, delta=1.0)
+        self.deallocate(alloc)
+
+        # a different freq is not
+        alloc = self.tunerAlloc('realloc_c', 101e6, 1e6)
+        self.assertTrue(self.allocate([alloc]))
+        status = self.tunerStatus('realloc_c')
+        self.assertAlmostEqual(status['FRONTEND::tuner_status::center_frequency'], 101e6, delta=1.0)
+        packets = self.waitPackets(status['FRONTEND::tuner_status::stream_id'], 2)
+        self.assertAlmostEqual(keyword(packets[-1]['sri'], 'CHAN_RF'), 101e6, delta=1.0)
+
+    def testResampledRate(self):
+        # 3 Msps is not a decimation of the 32 MHz master clock, and 3.2 Msps is out of tolerance, so it takes the resampler
+        self.configureStruct('rx_resampler', enable=True)
+        alloc = self.tunerAlloc('resample_a', 100e6, 3e6, sample_rate_tolerance=1.0)
+        self.assertTrue(self.allocate([alloc]))
+        status = self.tunerStatus('resample_a')
+        self.assertAlmostEqual(status['FRONTEND::tuner_status::sample_rate'], 3e6, delta=1e-3)
+
+        packets = self.waitPackets(status['FRONTEND::tuner_status::stream_id'], 4)
+        for pkt in packets:
+            self.assertAlmostEqual(pkt['sri'].xdelta, 1.0/3e6, delta=1e-15)
+        for before, after in zip(packets[1:-1], packets[2:]):
+            self.assertContiguous(before, after)
+
+    def testPushQueuePolicies(self):
+        # a consumer slower than the stream fills the queue, which each policy handles its own way
+        self.receiver.delay = 0.05
+        for policy in ('drop_oldest', 'drop_newest', 'block'):
+            self.configureStruct('rx_push_queue', enable=True, max_blocks=2, overflow_policy=policy)
+            before = self.pushQueueTotals()
+            alloc = self.tunerAlloc('queue_'+policy, 100e6, 1e6)
+            self.assertTrue(self.allocate([alloc]))
+            time.sleep(1.5)
+            after = self.pushQueueTotals()
+            self.deallocate(alloc)
+
+            self.assertTrue(after['pushes'] > before.get('pushes', 0), policy)
+            dropped = after['dropped_blocks'] - before.get('dropped_blocks', 0)
+            blocked = after['blocked'] - before.get('blocked', 0)
+            if policy == 'block':
+                self.assertEqual(dropped, 0)
+                self.assertTrue(blocked > 0)
+            else:
+                self.assertTrue(dropped > 0, policy)
+                self.assertEqual(blocked, 0)
+
 if __name__ == "__main__":
     ossie.utils.testing.main("../USRP_UHD.spd.xml") # By default tests all implementations